@@ -0,0 +1,127 @@
+#ifndef __BATCHED_MST_H
+#define __BATCHED_MST_H
+
+#include <algorithm>
+#include <omp.h>
+#include <vector>
+
+#include "boruvka.h"
+#include "defs.h"
+#include "graph.h"
+#include "parallel_array.h"
+#include "sequential_mst.h"
+
+/**
+ * Minimum spanning forests of a batch of graphs stored one after another
+ * Forest of graph i is edges[offset[i]..offset[i] + size[i])
+ */
+struct MSTBatch {
+    ParallelArray<Edge> edges;
+    ParallelArray<u32> offset;
+    ParallelArray<u32> size;
+
+    MSTBatch(u32 num_edges, u32 num_graphs) : edges(num_edges), offset(num_graphs + 1), size(num_graphs) {}
+
+    u32 num_graphs() const {
+        return size.size();
+    }
+
+    u64 weight(u32 graph_id) const {
+        u64 result = 0;
+        for (u32 i = offset[graph_id]; i < offset[graph_id] + size[graph_id]; ++i) {
+            result += edges[i].weight;
+        }
+        return result;
+    }
+};
+
+/**
+ * INTERFACE:
+ *
+ * BatchedMST(uint32_t SEQUENTIAL_THRESHOLD, uint32_t NUM_THREADS) - graphs with less than
+ *                                                                  SEQUENTIAL_THRESHOLD edges run on a single thread
+ * MSTBatch calculate_msts(const std::vector<Graph>& graphs) - calculates forests of all graphs
+ *
+ * DETAILS:
+ *
+ * On small graphs fork/join of every Boruvka round costs more than the round itself,
+ * so small graphs are spread across threads and each one is processed with KruskalMST,
+ * while large graphs get all the threads one after another with BoruvkaMST
+ *
+ * Small graphs are taken from the largest one with a dynamic schedule,
+ * so a big graph at the end of the batch doesn't leave other threads idle
+ */
+struct BatchedMST {
+    static constexpr u32 DEFAULT_SEQUENTIAL_THRESHOLD = 100'000;
+
+    const u32 NUM_THREADS;
+    const u32 SEQUENTIAL_THRESHOLD;
+
+    BatchedMST(u32 SEQUENTIAL_THRESHOLD = DEFAULT_SEQUENTIAL_THRESHOLD,
+               u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+                                                          SEQUENTIAL_THRESHOLD(SEQUENTIAL_THRESHOLD) {}
+
+    MSTBatch calculate_msts(const std::vector<Graph>& graphs) {
+        u32 num_graphs = graphs.size();
+
+        /* Forest of a graph has at most N - 1 edges */
+        u32 total_size = 0;
+        for (const Graph& graph : graphs) {
+            total_size += (graph.num_nodes() == 0 ? 0 : graph.num_nodes() - 1);
+        }
+
+        MSTBatch result(total_size, num_graphs);
+
+        result.offset[0] = 0;
+        for (u32 i = 0; i < num_graphs; ++i) {
+            result.offset[i + 1] = result.offset[i] + (graphs[i].num_nodes() == 0 ? 0 : graphs[i].num_nodes() - 1);
+        }
+
+        std::vector<u32> small_graphs;
+        std::vector<u32> large_graphs;
+        for (u32 i = 0; i < num_graphs; ++i) {
+            if (graphs[i].num_nodes() == 0) {
+                result.size[i] = 0;
+            } else if (graphs[i].num_edges() < SEQUENTIAL_THRESHOLD) {
+                small_graphs.push_back(i);
+            } else {
+                large_graphs.push_back(i);
+            }
+        }
+
+        std::sort(small_graphs.begin(), small_graphs.end(), [&graphs](u32 a, u32 b) {
+            return graphs[a].num_edges() > graphs[b].num_edges();
+        });
+
+        BoruvkaMST boruvka;
+        for (u32 id : large_graphs) {
+            ParallelArray<u32> mst_ids = boruvka.calculate_mst_ids(graphs[id], NUM_THREADS);
+            result.size[id] = mst_ids.size();
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < mst_ids.size(); ++i) {
+                result.edges[result.offset[id] + i] = graphs[id].edges[mst_ids[i]];
+            }
+        }
+
+        #pragma omp parallel num_threads(NUM_THREADS)
+        {
+            KruskalMST kruskal;
+
+            #pragma omp for schedule(dynamic, 1)
+            for (u32 i = 0; i < small_graphs.size(); ++i) {
+                u32 id = small_graphs[i];
+                ParallelArray<u32> mst_ids = kruskal.calculate_mst_ids(graphs[id]);
+                result.size[id] = mst_ids.size();
+
+                for (u32 j = 0; j < mst_ids.size(); ++j) {
+                    result.edges[result.offset[id] + j] = graphs[id].edges[mst_ids[j]];
+                }
+            }
+        }
+
+        return result;
+    }
+};
+
+#endif
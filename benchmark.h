@@ -1,8 +1,500 @@
 #ifndef __BENCHMARK_H
 #define __BENCHMARK_H
 
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <omp.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "defs.h"
+#include "perf_counters.h"
+#include "timer.h"
+
 void escape(void* p) {
     asm volatile("" : : "g"(p) : "memory");
 }
 
+/**
+ * Results of one benchmark at one thread count, times are in nanoseconds
+ * items is the number of elements processed per repetition, it gives throughput if not zero
+ * counters has hardware counters of each repetition, it is empty if they were disabled
+ * metrics are extra values a benchmark reports about itself, see Benchmark::set_metric()
+ */
+struct BenchmarkResult {
+    std::string name;
+    u32 threads;
+    u64 items;
+    std::vector<u64> wall_ns;
+    std::vector<u64> cpu_ns;
+    std::vector<PerfCounts> counters;
+    std::vector<std::pair<std::string, double>> metrics;
+
+    /* Nearest rank percentile, p is in [0, 100] */
+    static double percentile(std::vector<u64> values, double p) {
+        if (values.empty()) return 0;
+        std::sort(values.begin(), values.end());
+        u32 rank = static_cast<u32>(p / 100 * (values.size() - 1) + 0.5);
+        return values[rank];
+    }
+
+    static double mean(const std::vector<u64>& values) {
+        if (values.empty()) return 0;
+        double sum = 0;
+        for (u64 x : values) sum += x;
+        return sum / values.size();
+    }
+
+    double median() const {
+        return percentile(wall_ns, 50);
+    }
+
+    /* How many threads were busy on average */
+    double utilization() const {
+        double wall = mean(wall_ns);
+        return wall == 0 ? 0 : mean(cpu_ns) / wall;
+    }
+
+    /* Items per second by the median time */
+    double throughput() const {
+        return median() == 0 ? 0 : items / (median() * 1e-9);
+    }
+
+    bool counted(PerfEvent event) const {
+        return !counters.empty() && counters[0].supported[event];
+    }
+
+    /* Median of the event over repetitions */
+    double counter(PerfEvent event) const {
+        std::vector<u64> values;
+        for (const PerfCounts& counts : counters) values.push_back(counts.value[event]);
+        return percentile(values, 50);
+    }
+
+    /* Instructions per cycle, summed over threads */
+    double ipc() const {
+        double cycles = counter(CYCLES_EVENT);
+        return cycles == 0 ? 0 : counter(INSTRUCTIONS_EVENT) / cycles;
+    }
+
+    bool has_ipc() const {
+        return counted(CYCLES_EVENT) && counted(INSTRUCTIONS_EVENT);
+    }
+};
+
+struct BenchmarkConfig {
+    u32 warmup = 1;
+    u32 repetitions = 10;
+    std::vector<u32> threads = { static_cast<u32>(omp_get_max_threads()) };
+    std::string format = "text";
+    std::string output;
+    bool counters = true;
+    /* Sizes for registered benchmarks instead of their own ones, and a substring of names to run */
+    std::vector<u64> sizes;
+    std::string filter;
+};
+
+std::vector<u64> parse_list(const std::string& value) {
+    std::vector<u64> result;
+    std::stringstream list(value);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        result.push_back(std::stoull(item));
+    }
+    return result;
+}
+
+/**
+ * Reads arguments like repetitions=20 warmup=2 threads=1,2,4,8 format=json output=result.json counters=0
+ * sizes=1000,1000000 filter=dsu on top of given defaults, unknown arguments are left for the benchmark itself
+ */
+BenchmarkConfig parse_benchmark_args(int argc, char* argv[], BenchmarkConfig config = BenchmarkConfig()) {
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        size_t eq = argument.find('=');
+        if (eq == std::string::npos) continue;
+
+        std::string key = argument.substr(0, eq);
+        std::string value = argument.substr(eq + 1);
+
+        if (key == "warmup") {
+            config.warmup = std::stoul(value);
+        } else if (key == "repetitions") {
+            config.repetitions = std::stoul(value);
+        } else if (key == "threads") {
+            std::vector<u64> threads = parse_list(value);
+            config.threads.assign(threads.begin(), threads.end());
+        } else if (key == "sizes") {
+            config.sizes = parse_list(value);
+        } else if (key == "filter") {
+            config.filter = value;
+        } else if (key == "format") {
+            config.format = value;
+        } else if (key == "output") {
+            config.output = value;
+        } else if (key == "counters") {
+            config.counters = (value != "0");
+        }
+    }
+
+    if (config.repetitions == 0 || config.threads.empty()) {
+        throw std::invalid_argument("Benchmark needs at least one repetition and one thread count");
+    }
+
+    return config;
+}
+
+/**
+ * INTERFACE:
+ *
+ * Benchmark(BenchmarkConfig config) - creates a harness with given settings
+ * run(name, items, timed) - runs timed() warmup + repetitions times for each thread count
+ * run(name, items, setup, timed) - same, but calls setup() before each run, setup isn't measured
+ * run_sequential(...) - same as run() but only with one thread, for sequential baselines
+ * const BenchmarkResult& find(name, threads) - result of a finished benchmark
+ * void set_metric(key, value) - attaches an extra value to the last result, e.g. CAS retries per operation
+ * void report() - writes all results as text, csv or json to config.output or stdout
+ *
+ * DETAILS:
+ *
+ * Before each series omp_set_num_threads() is called, so everything that defaults
+ * to omp_get_max_threads() runs with the current thread count
+ *
+ * Wall time is CLOCK_MONOTONIC, CPU time is the CPU time of the whole process,
+ * so their ratio shows how many threads were actually busy
+ *
+ * Unless config.counters is false, hardware counters (see PerfCounters) are opened
+ * for the thread team of each series and read around every repetition,
+ * events the machine can't count are reported as n/a, null or empty
+ */
+struct Benchmark {
+    BenchmarkConfig config;
+    std::vector<BenchmarkResult> results;
+
+    Benchmark(BenchmarkConfig config = BenchmarkConfig()) : config(config) {}
+
+    const BenchmarkResult& run(const std::string& name, u64 items, std::function<void()> timed) {
+        return run(name, items, []() {}, timed);
+    }
+
+    const BenchmarkResult& run(const std::string& name,
+                               u64 items,
+                               std::function<void()> setup,
+                               std::function<void()> timed) {
+        for (u32 threads : config.threads) {
+            measure(name, threads, items, setup, timed);
+        }
+        return results.back();
+    }
+
+    const BenchmarkResult& run_sequential(const std::string& name, u64 items, std::function<void()> timed) {
+        return run_sequential(name, items, []() {}, timed);
+    }
+
+    const BenchmarkResult& run_sequential(const std::string& name,
+                                          u64 items,
+                                          std::function<void()> setup,
+                                          std::function<void()> timed) {
+        return measure(name, 1, items, setup, timed);
+    }
+
+    const BenchmarkResult& measure(const std::string& name,
+                                   u32 threads,
+                                   u64 items,
+                                   std::function<void()> setup,
+                                   std::function<void()> timed) {
+        u32 old_threads = omp_get_max_threads();
+        omp_set_num_threads(threads);
+
+        BenchmarkResult result = { name, threads, items, {}, {}, {}, {} };
+
+        std::unique_ptr<PerfCounters> perf;
+        if (config.counters) {
+            perf.reset(new PerfCounters(threads));
+        }
+
+        for (u32 iter = 0; iter < config.warmup + config.repetitions; ++iter) {
+            setup();
+
+            if (perf) perf->start();
+            u64 wall_start = wall_time_ns();
+            u64 cpu_start = process_cpu_time_ns();
+
+            timed();
+
+            u64 cpu_finish = process_cpu_time_ns();
+            u64 wall_finish = wall_time_ns();
+            PerfCounts counts;
+            if (perf) counts = perf->stop();
+
+            if (iter >= config.warmup) {
+                result.wall_ns.push_back(wall_finish - wall_start);
+                result.cpu_ns.push_back(cpu_finish - cpu_start);
+                if (perf) result.counters.push_back(counts);
+            }
+        }
+
+        omp_set_num_threads(old_threads);
+
+        if (config.format == "text" && config.output.empty()) {
+            std::cerr << name << " [" << threads << " threads] done\n";
+        }
+
+        results.push_back(result);
+        return results.back();
+    }
+
+    void set_metric(const std::string& key, double value) {
+        if (results.empty()) {
+            throw std::invalid_argument("Metric " + key + " set before any benchmark was run");
+        }
+        results.back().metrics.push_back({ key, value });
+    }
+
+    const BenchmarkResult& find(const std::string& name, u32 threads) const {
+        for (const BenchmarkResult& result : results) {
+            if (result.name == name && result.threads == threads) {
+                return result;
+            }
+        }
+        throw std::invalid_argument("No benchmark " + name + " with " + std::to_string(threads) + " threads");
+    }
+
+    void write_text(std::ostream& out) const {
+        out << std::fixed << std::setprecision(6)
+            << std::left << std::setw(48) << "name" << std::right
+            << std::setw(8) << "threads"
+            << std::setw(14) << "median, s"
+            << std::setw(14) << "mean, s"
+            << std::setw(14) << "p90, s"
+            << std::setw(14) << "p99, s"
+            << std::setw(14) << "min, s"
+            << std::setw(8) << "cpu"
+            << std::setw(16) << "items/s" << "\n";
+
+        for (const BenchmarkResult& r : results) {
+            out << std::left << std::setw(48) << r.name << std::right
+                << std::setw(8) << r.threads
+                << std::setw(14) << r.median() * 1e-9
+                << std::setw(14) << BenchmarkResult::mean(r.wall_ns) * 1e-9
+                << std::setw(14) << BenchmarkResult::percentile(r.wall_ns, 90) * 1e-9
+                << std::setw(14) << BenchmarkResult::percentile(r.wall_ns, 99) * 1e-9
+                << std::setw(14) << BenchmarkResult::percentile(r.wall_ns, 0) * 1e-9
+                << std::setw(8) << std::setprecision(2) << r.utilization() << std::setprecision(6)
+                << std::setw(16) << std::setprecision(0) << r.throughput() << std::setprecision(6) << "\n";
+        }
+
+        if (!config.counters) {
+            write_text_metrics(out);
+            return;
+        }
+
+        out << "\n" << std::left << std::setw(48) << "name" << std::right << std::setw(8) << "threads";
+        for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+            out << std::setw(16) << PERF_EVENT_NAMES[event];
+        }
+        out << std::setw(8) << "ipc" << "\n";
+
+        for (const BenchmarkResult& r : results) {
+            out << std::left << std::setw(48) << r.name << std::right << std::setw(8) << r.threads
+                << std::setprecision(0);
+            for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+                PerfEvent e = static_cast<PerfEvent>(event);
+                if (r.counted(e)) {
+                    out << std::setw(16) << r.counter(e);
+                } else {
+                    out << std::setw(16) << "n/a";
+                }
+            }
+            if (r.has_ipc()) {
+                out << std::setw(8) << std::setprecision(2) << r.ipc();
+            } else {
+                out << std::setw(8) << "n/a";
+            }
+            out << std::setprecision(6) << "\n";
+        }
+
+        write_text_metrics(out);
+    }
+
+    void write_text_metrics(std::ostream& out) const {
+        bool has_metrics = false;
+        for (const BenchmarkResult& r : results) has_metrics = has_metrics || !r.metrics.empty();
+        if (!has_metrics) return;
+
+        out << "\n" << std::left << std::setw(48) << "name" << std::right << std::setw(8) << "threads"
+            << "  metrics\n";
+        for (const BenchmarkResult& r : results) {
+            if (r.metrics.empty()) continue;
+
+            out << std::left << std::setw(48) << r.name << std::right << std::setw(8) << r.threads << " ";
+            for (const auto& [key, value] : r.metrics) {
+                out << " " << key << "=" << std::setprecision(3) << value;
+            }
+            out << std::setprecision(6) << "\n";
+        }
+    }
+
+    void write_csv(std::ostream& out) const {
+        out << "name,threads,repetitions,median_ns,mean_ns,p90_ns,p99_ns,min_ns,max_ns,cpu_utilization,items,items_per_second";
+        for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+            out << "," << PERF_EVENT_NAMES[event];
+        }
+        out << ",ipc,metrics\n";
+
+        for (const BenchmarkResult& r : results) {
+            out << std::fixed << std::setprecision(0)
+                << r.name << "," << r.threads << "," << r.wall_ns.size() << ","
+                << r.median() << "," << BenchmarkResult::mean(r.wall_ns) << ","
+                << BenchmarkResult::percentile(r.wall_ns, 90) << ","
+                << BenchmarkResult::percentile(r.wall_ns, 99) << ","
+                << BenchmarkResult::percentile(r.wall_ns, 0) << ","
+                << BenchmarkResult::percentile(r.wall_ns, 100) << ","
+                << std::setprecision(3) << r.utilization() << ","
+                << r.items << "," << std::setprecision(0) << r.throughput();
+            for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+                out << ",";
+                if (r.counted(static_cast<PerfEvent>(event))) out << r.counter(static_cast<PerfEvent>(event));
+            }
+            out << ",";
+            if (r.has_ipc()) out << std::setprecision(3) << r.ipc();
+            out << ",";
+            for (u32 i = 0; i < r.metrics.size(); ++i) {
+                out << (i == 0 ? "" : ";") << r.metrics[i].first << "=" << std::setprecision(3) << r.metrics[i].second;
+            }
+            out << "\n";
+        }
+    }
+
+    void write_json(std::ostream& out) const {
+        out << std::fixed << "[";
+        for (u32 i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& r = results[i];
+            out << (i == 0 ? "\n" : ",\n") << std::setprecision(0)
+                << "  {\"name\": \"" << r.name << "\""
+                << ", \"threads\": " << r.threads
+                << ", \"repetitions\": " << r.wall_ns.size()
+                << ", \"median_ns\": " << r.median()
+                << ", \"mean_ns\": " << BenchmarkResult::mean(r.wall_ns)
+                << ", \"p90_ns\": " << BenchmarkResult::percentile(r.wall_ns, 90)
+                << ", \"p99_ns\": " << BenchmarkResult::percentile(r.wall_ns, 99)
+                << ", \"min_ns\": " << BenchmarkResult::percentile(r.wall_ns, 0)
+                << ", \"max_ns\": " << BenchmarkResult::percentile(r.wall_ns, 100)
+                << ", \"cpu_utilization\": " << std::setprecision(3) << r.utilization()
+                << ", \"items\": " << r.items
+                << ", \"items_per_second\": " << std::setprecision(0) << r.throughput();
+            for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+                out << ", \"" << PERF_EVENT_NAMES[event] << "\": ";
+                if (r.counted(static_cast<PerfEvent>(event))) {
+                    out << r.counter(static_cast<PerfEvent>(event));
+                } else {
+                    out << "null";
+                }
+            }
+            out << ", \"ipc\": ";
+            if (r.has_ipc()) {
+                out << std::setprecision(3) << r.ipc();
+            } else {
+                out << "null";
+            }
+            if (!r.metrics.empty()) {
+                out << ", \"metrics\": {";
+                for (u32 i = 0; i < r.metrics.size(); ++i) {
+                    out << (i == 0 ? "\"" : ", \"") << r.metrics[i].first << "\": "
+                        << std::setprecision(3) << r.metrics[i].second;
+                }
+                out << "}";
+            }
+            out << "}";
+        }
+        out << "\n]\n";
+    }
+
+    void report() const {
+        std::ofstream file;
+        if (!config.output.empty()) {
+            file.open(config.output);
+        }
+        std::ostream& out = config.output.empty() ? std::cout : file;
+
+        if (config.format == "json") {
+            write_json(out);
+        } else if (config.format == "csv") {
+            write_csv(out);
+        } else {
+            write_text(out);
+        }
+    }
+};
+
+/**
+ * A benchmark body gets the harness, its full name (registered name + "/" + size) and a size,
+ * prepares the input and calls benchmark.run() or run_sequential() with that name
+ */
+using BenchmarkBody = std::function<void(Benchmark& benchmark, const std::string& name, u64 size)>;
+
+struct RegisteredBenchmark {
+    std::string name;
+    std::vector<u64> sizes;
+    BenchmarkBody body;
+};
+
+std::vector<RegisteredBenchmark>& benchmark_registry() {
+    static std::vector<RegisteredBenchmark> registry;
+    return registry;
+}
+
+struct BenchmarkRegistration {
+    BenchmarkRegistration(const std::string& name, std::vector<u64> sizes, BenchmarkBody body) {
+        benchmark_registry().push_back({ name, sizes, body });
+    }
+};
+
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+
+/**
+ * REGISTER_BENCHMARK("dsu/unite", SIZES(1'000, 1'000'000), [](Benchmark& benchmark, const std::string& name, u64 size) {
+ *     ...
+ *     benchmark.run(name, size, setup, timed);
+ * });
+ */
+#define SIZES(...) std::vector<u64>({ __VA_ARGS__ })
+#define REGISTER_BENCHMARK(name, sizes, body) \
+    static BenchmarkRegistration BENCHMARK_CONCAT(benchmark_registration_, __LINE__)(name, sizes, body)
+
+/**
+ * Runs all registered benchmarks that contain config.filter in their names,
+ * for every size and thread count, and reports them together
+ *
+ * JSON results of two commits can be compared with tests/compare_benchmarks.cc
+ */
+int run_registered_benchmarks(int argc, char* argv[]) {
+    Benchmark benchmark(parse_benchmark_args(argc, argv));
+
+    for (const RegisteredBenchmark& registered : benchmark_registry()) {
+        if (registered.name.find(benchmark.config.filter) == std::string::npos) continue;
+
+        const std::vector<u64>& sizes = benchmark.config.sizes.empty() ? registered.sizes : benchmark.config.sizes;
+        for (u64 size : sizes) {
+            registered.body(benchmark, registered.name + "/" + std::to_string(size), size);
+        }
+    }
+
+    benchmark.report();
+    return 0;
+}
+
+#define BENCHMARK_MAIN() \
+    int main(int argc, char* argv[]) { \
+        return run_registered_benchmarks(argc, argv); \
+    }
+
 #endif
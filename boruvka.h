@@ -4,22 +4,172 @@
 #include <algorithm>
 #include <limits>
 #include <omp.h>
-#include <pair>
-#include <unordered_map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
+#include "compressed_graph.h"
 #include "dsu.h"
-#include "sequential_dsu.h"
+#include "edge_kernels.h"
 #include "graph.h"
+#include "graph_reordering.h"
+#include "instrumentation.h"
+#include "iteration_array.h"
 #include "parallel_array.h"
+#include "parallel_memory.h"
 #include "prefix_sum.h"
+#include "sequential_dsu.h"
+#include "simd.h"
+#include "weight_traits.h"
+
+/**
+ * Edge of a contracted graph
+ * from and to are the current super-vertices, id is the index of the edge it came from,
+ * E is the type of edge ids, see BoruvkaMST
+ */
+template<typename E = u32>
+struct BasicContractedEdge {
+    u32 from;
+    u32 to;
+    u32 weight;
+    E id;
+
+    BasicContractedEdge() {}
+
+    BasicContractedEdge(u32 from, u32 to, u32 weight, E id) : from(from), to(to), weight(weight), id(id) {}
+};
+
+template<typename E>
+bool operator<(const BasicContractedEdge<E>& a, const BasicContractedEdge<E>& b) {
+    return std::tie(a.from, a.to, a.weight, a.id) < std::tie(b.from, b.to, b.weight, b.id);
+}
+
+using ContractedEdge = BasicContractedEdge<>;
+
+/**
+ * Structure of arrays of contracted edges: from[i], to[i], weight[i] and id[i] make the edge i
+ * Scans that need only some of the fields, like the min-edge search that reads from and weight,
+ * don't drag the others through cache and can be vectorized, see edge_kernels.h
+ * Input graphs stay arrays of edges, only the contracted graph is stored this way
+ */
+template<typename E = u32>
+struct BasicContractedEdgeArrays {
+    ParallelArray<u32> from;
+    ParallelArray<u32> to;
+    ParallelArray<u32> weight;
+    ParallelArray<E> id;
 
+    BasicContractedEdgeArrays(u64 size) : from(size), to(size), weight(size), id(size) {}
+
+    u64 size() const {
+        return from.size();
+    }
+
+    BasicContractedEdge<E> get(u64 i) const {
+        return BasicContractedEdge<E>(from[i], to[i], weight[i], id[i]);
+    }
+
+    void set(u64 i, const BasicContractedEdge<E>& e) {
+        from[i] = e.from;
+        to[i] = e.to;
+        weight[i] = e.weight;
+        id[i] = e.id;
+    }
+
+    void swap(BasicContractedEdgeArrays<E>& other) {
+        from.swap(other.from);
+        to.swap(other.to);
+        weight.swap(other.weight);
+        id.swap(other.id);
+    }
+};
+
+using ContractedEdgeArrays = BasicContractedEdgeArrays<>;
+
+/**
+ * Parallel Boruvka's algorithm over graphs with weights of type W, node ids of type I and edge ids of type E
+ *
+ * Contracted edges keep 32 bit weight keys (see weight_traits.h), so (key, index) packs into one u64
+ * and one CAS updates a shortest edge for every W: keys of u16, u32 and float weights are used as is,
+ * 64 bit weights are replaced with their ranks in the order of weights before the first round,
+ * the choice is made at compile time, rounds and kernels are the same for every W
+ *
+ * Edge ids and positions of contracted edges are u32 by default, graphs with more than 2^32
+ * directed edges need E = u64: the index in the packed word is then the offset of an edge
+ * from the first edge of its node, which is found once a round, see edge_kernels.h,
+ * so the CAS stays 64 bit, input edges should be sorted by from and nodes should have less than 2^32 edges
+ */
+template<typename W = u32, typename I = u32, typename E = u32>
 struct BoruvkaMST {
+    static_assert(std::is_same_v<E, u32> || std::is_same_v<E, u64>, "Edge ids should be u32 or u64");
+
+    using EdgeType = BasicEdge<W, I>;
+    using GraphViewType = BasicGraphView<W, I>;
+    using ContractedEdgeType = BasicContractedEdge<E>;
+    using ContractedEdgeArraysType = BasicContractedEdgeArrays<E>;
+
+    /* Whether weight keys don't fit in 32 bits and are replaced with ranks */
+    static constexpr bool RANKED_WEIGHTS = sizeof(typename WeightTraits<W>::Key) > sizeof(u32);
+
+    /* Whether positions don't fit in 32 bits and shortest edges are encoded with offsets in runs */
+    static constexpr bool WIDE_IDS = std::is_same_v<E, u64>;
+
+    /**
+     * Once a round has less than SEQUENTIAL_CUTOFF edges, the rest of the forest is found
+     * with Kruskal's algorithm on one thread, barriers of parallel rounds cost more than the work there
+     *
+     * AUTO_CUTOFF scales the cutoff with the number of threads: each of them
+     * should get at least SEQUENTIAL_EDGES_PER_THREAD edges for a parallel round to pay off
+     */
+    static constexpr u32 AUTO_CUTOFF = std::numeric_limits<u32>::max();
+    static constexpr u32 SEQUENTIAL_EDGES_PER_THREAD = 4'096;
+
+    /* Edges per call of a kernel from edge_kernels.h, a unit of work for OpenMP */
+    static constexpr u32 KERNEL_BLOCK_SIZE = 4'096;
+
+    const u32 SEQUENTIAL_CUTOFF;
+
+    /* Kernels of the min-edge and edge filter phases, the best this CPU supports by default */
+    const SimdLevel simd_level;
+
+    /**
+     * Graphs are relabeled in this order before the first round, see graph_reordering.h,
+     * ids that are close in the graph make the per-node lookups of the rounds local,
+     * the returned ids and edges are those of the input graph either way
+     * Compressed graphs can't be relabeled without decoding them and are always taken in their own order,
+     * compress ReorderedGraph::graph and map the ids back with to_original_ids() instead
+     */
+    const NodeOrder node_order;
+
+    /* Rounds of the last calculate_mst_ids() call, recorded with ENABLE_INSTRUMENTATION only */
+    BoruvkaProfile profile;
+
+    BoruvkaMST(u32 SEQUENTIAL_CUTOFF = AUTO_CUTOFF,
+               SimdLevel simd_level = detect_simd_level(),
+               NodeOrder node_order = ORIGINAL_ORDER) : SEQUENTIAL_CUTOFF(SEQUENTIAL_CUTOFF),
+                                                        simd_level(simd_level),
+                                                        node_order(node_order) {
+        if (!simd_level_supported(simd_level)) {
+            throw std::invalid_argument(std::string("This CPU doesn't support ") + SIMD_LEVEL_NAMES[simd_level]);
+        }
+    }
+
+    u32 sequential_cutoff(u32 NUM_THREADS) const {
+        if (SEQUENTIAL_CUTOFF == AUTO_CUTOFF) {
+            return NUM_THREADS == 1 ? AUTO_CUTOFF : SEQUENTIAL_EDGES_PER_THREAD * NUM_THREADS;
+        }
+        return SEQUENTIAL_CUTOFF;
+    }
+
     /**
      * I use the same atomic pair that I use in dsu.h
      * TODO: create a special class for this
      */
     const u32 EDGE_BINARY_BUCKET_SIZE = 32;
     const u64 EDGE_WEIGHT_MASK = 0xFFFFFFFF00000000ULL;
+    const u64 EMPTY_EDGE = std::numeric_limits<u64>::max();
 
     u64 encode_edge(u32 id, u32 weight) {
         return (static_cast<u64>(weight) << EDGE_BINARY_BUCKET_SIZE) + id;
@@ -34,332 +184,471 @@ struct BoruvkaMST {
     }
 
     /**
-     * Calculates MST of given graph and returns a ParallelArray<Edge> object
+     * Stores encoded_edge in shortest_edge if it is lighter than the current one
+     * Edges are compared by weight first and by id second, so the result doesn't
+     * depend on the order in which threads get here
      */
-    ParallelArray<Edge> calculate_mst(Graph graph, u32 NUM_THREADS = omp_get_max_threads()) {
-        DSU node_sets(graph.num_nodes());
-        ParallelArray<Edge> mst(graph.num_nodes() - 1);
-        u32 current_mst_size = 0;
-        u32 initial_num_nodes = graph.num_nodes();
-
-        while (graph.num_nodes() != 1) {
-            ParallelArray<atomic_u64> shortest_edges(initial_num_nodes);
-
-            /* Calculating shortest edges from each node */
-            #pragma omp parallel num_threads(NUM_THREADS)
-            {
-                std::unordered_map<u32, std::pair<u32, u32>> local_shortest_edges(graph.num_nodes());
+    void update_shortest_edge(atomic_u64& shortest_edge, u64 encoded_edge) {
+        update_min_edge(shortest_edge, encoded_edge);
+    }
 
-                #pragma omp for
-                for (u32 i = 0; i < initial_num_nodes; ++i) {
-                    shortest_edges[i] = encode_edge(0, std::numeric_limits<u32>::max());
-                }
+    /**
+     * Finishes the forest with Kruskal's algorithm on the remaining edges of a contracted graph
+     * and writes their ids to mst_buffer starting from position, returns the number of added edges
+     */
+    u32 kruskal_tail(ParallelArray<ContractedEdgeType>& edges,
+                     DSU& node_sets,
+                     ParallelArray<E>& mst_buffer,
+                     u32 position) {
+        std::sort(edges.begin(), edges.end(), [](const ContractedEdgeType& a, const ContractedEdgeType& b) {
+            return std::tie(a.weight, a.id) < std::tie(b.weight, b.id);
+        });
+
+        u32 added = 0;
+        for (const ContractedEdgeType& e : edges) {
+            if (node_sets.unite(e.from, e.to)) {
+                mst_buffer[position + added++] = e.id;
+            }
+        }
 
-                #pragma omp for
-                for (u32 i = 0; i < graph.num_edges(); ++i) {
-                    const Edge& e = graph.edges[i];
+        return added;
+    }
 
-                    if (local_shortest_edges.count(e.from) == 0 ||
-                        local_shortest_edges[e.from].first > e.weight) {
+    /**
+     * Runs min_edge_kernel on edges in blocks of KERNEL_BLOCK_SIZE
+     * run_start is needed for 64 bit edge ids only, see find_run_starts()
+     */
+    void find_shortest_edges(const ContractedEdgeArraysType& edges,
+                             ParallelArray<atomic_u64>& shortest_edges,
+                             const E* run_start,
+                             u32 NUM_THREADS) {
+        E num_blocks = (edges.size() + KERNEL_BLOCK_SIZE - 1) / KERNEL_BLOCK_SIZE;
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (E block = 0; block < num_blocks; ++block) {
+            E begin = block * KERNEL_BLOCK_SIZE;
+            E end = std::min<E>(edges.size(), begin + KERNEL_BLOCK_SIZE);
+            min_edge_kernel(simd_level, edges.from.begin(), edges.weight.begin(), begin, end,
+                            shortest_edges.begin(), run_start);
+        }
+    }
 
-                        local_shortest_edges[e.from] = { e.weight, i };
-                    }
-                }
+    /* Position of the first edge of every node that has edges, edges are sorted by from */
+    void find_run_starts(const ContractedEdgeArraysType& edges, ParallelArray<E>& run_start, u32 NUM_THREADS) {
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (E i = 0; i < edges.size(); ++i) {
+            if (i == 0 || edges.from[i - 1] != edges.from[i]) {
+                run_start[edges.from[i]] = i;
+            }
+        }
+    }
 
-                for (const auto& p : local_shortest_edges) { /* O(M / p) operations in each thread */
-                    u64 old = shortest_edges[p.first];
+    /* Position of the shortest edge of node u in the contracted edge arrays */
+    E shortest_position(u32 u, const ParallelArray<atomic_u64>& shortest_edges, const ParallelArray<E>& run_start) {
+        if constexpr (WIDE_IDS) {
+            return run_start[u] + get_id(shortest_edges[u]);
+        } else {
+            return get_id(shortest_edges[u]);
+        }
+    }
 
-                    /* p.second = { weight, id } */
-                    u64 encoded_edge = encode_edge(p.second.second, p.second.first);
+    /**
+     * Runs relabel_edges_kernel on edges in blocks of KERNEL_BLOCK_SIZE
+     * component has an entry for every node, with 2^31 nodes or more the gathers would overflow,
+     * so such graphs are relabeled by the scalar kernel
+     */
+    void relabel_edges(ContractedEdgeArraysType& edges,
+                       const ParallelArray<u32>& component,
+                       ParallelArray<u32>& remains,
+                       u32 NUM_THREADS) {
+        E num_blocks = (edges.size() + KERNEL_BLOCK_SIZE - 1) / KERNEL_BLOCK_SIZE;
+        SimdLevel level = relabel_level(simd_level, component.size());
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (E block = 0; block < num_blocks; ++block) {
+            E begin = block * KERNEL_BLOCK_SIZE;
+            E end = std::min<E>(edges.size(), begin + KERNEL_BLOCK_SIZE);
+            relabel_edges_kernel(level, edges.from.begin(), edges.to.begin(), component.begin(),
+                                 remains.begin(), begin, end);
+        }
+    }
 
-                    while (true) { /* This loop is wait-free */
-                        if (get_weight(old) < p.second.first ||
-                            shortest_edges[p.first].compare_exchange_strong(old, encoded_edge)) {
-                            break;
-                        }
-                    }
-                }            
-            }
+    /**
+     * Calculates minimum spanning forest of given graph and returns
+     * ids of its edges in graph.edges, only one direction of each edge is returned
+     *
+     * Graph may be disconnected, self loops are ignored
+     * Graphs with more than 2^32 edges throw std::invalid_argument unless E is u64
+     */
+    ParallelArray<E> calculate_mst_ids(GraphViewType graph, u32 NUM_THREADS = omp_get_max_threads()) {
+        check_edge_ids(graph, NUM_THREADS);
 
-            /* Calculating selected edges */
-            ParallelArray<u32> edge_selected(graph.num_edges());
+        if (node_order != ORIGINAL_ORDER) {
+            BasicReorderedGraph<W, I> reordered(graph, node_order, NUM_THREADS);
+            return reordered.to_original_ids(calculate_ordered_mst_ids(reordered.graph, NUM_THREADS));
+        }
+        return calculate_ordered_mst_ids(graph, NUM_THREADS);
+    }
 
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_edges(); ++i) {
-                edge_selected[i] = 0;
-            }
+    /* calculate_mst_ids() on the node ids graph already has */
+    ParallelArray<E> calculate_ordered_mst_ids(GraphViewType graph, u32 NUM_THREADS) {
 
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_nodes(); ++i) {
-                u32 u = graph.nodes[i];
-                const Edge& min_edge_u = graph.edges[get_id(shortest_edges[u])];
-
-                u32 v = min_edge_u.to;
-                const Edge& min_edge_v = graph.edges[get_id(shortest_edges[v])];
-                
-                if (min_edge_v.to != u || (min_edge_v.to == u && u < v)) {
-                    node_sets.unite(u, v);
-                    edge_selected[get_id(shortest_edges[u])] = 1;
-                }
-            }
+        ParallelArray<u32> ranks(0, NUM_THREADS);
+        if constexpr (RANKED_WEIGHTS) {
+            rank_weights(graph, NUM_THREADS).swap(ranks);
+        }
 
-            /* Adding edges to MST */
-            PrefixSum edge_selected_prefix(graph.num_edges(), edge_selected);
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_edges(); ++i) {
-                if (edge_selected[i]) {
-                    mst[current_mst_size + edge_selected_prefix[i] - 1] = graph.edges[i];
-                }
-            }
-            current_mst_size += edge_selected_prefix[graph.num_edges() - 1];
+        /* Dropping self loops */
+        ParallelArray<u32> edge_kept(graph.num_edges(), NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (E i = 0; i < graph.num_edges(); ++i) {
+            edge_kept[i] = (graph.edges[i].from != graph.edges[i].to);
+        }
 
-            /* Calculating remaining edges */
-            ParallelArray<u32> edge_remains(graph.num_edges());
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_edges(); ++i) {
-                edge_remains[i] = !node_sets.same_set(graph.edges[i].from, graph.edges[i].to);
-            }
+        ContractedEdgeArraysType edges(0);
+        if (graph.num_edges() != 0) {
+            PrefixSum<u32, E> edge_kept_prefix(graph.num_edges(), edge_kept, NUM_THREADS);
+            ContractedEdgeArraysType kept_edges(edge_kept_prefix[graph.num_edges() - 1]);
 
-            PrefixSum edge_remains_prefix(graph.num_edges(), edge_remains);
-            ParallelArray<Edge> new_edges(edge_remains_prefix[graph.num_edges() - 1]);
-                
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_edges(); ++i) {
-                if (edge_remains[i]) {
-                    const Edge& old_edge = graph.edges[i];
-                    new_edges[edge_remains_prefix[i] - 1] = Edge(node_sets.find_root(old_edge.from),
-                                                                    node_sets.find_root(old_edge.to),
-                                                                    old_edge.weight);
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (E i = 0; i < graph.num_edges(); ++i) {
+                if (edge_kept[i]) {
+                    const EdgeType& e = graph.edges[i];
+                    kept_edges.set(edge_kept_prefix[i] - 1, ContractedEdgeType(e.from, e.to, weight_key(e, i, ranks), i));
                 }
             }
-                
-            /* Calculating remaining nodes */
-            ParallelArray<u32> node_remains(graph.num_nodes());
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_nodes(); ++i) {
-                node_remains[i] = (
-                    node_sets.find_root(graph.nodes[i]) == graph.nodes[i]
-                );
-            }
 
-            PrefixSum node_remains_prefix(graph.num_nodes(), node_remains);
-            ParallelArray<u32> new_nodes(node_remains_prefix[graph.num_nodes() - 1]);
+            edges.swap(kept_edges);
+        }
 
-            #pragma omp parallel for
+        if constexpr (std::is_same_v<I, u32>) {
+            return contract_to_mst(graph.nodes, graph.num_nodes(), edges, NUM_THREADS);
+        } else {
+            ParallelArray<u32> graph_nodes(graph.num_nodes(), NUM_THREADS);
+            #pragma omp parallel for num_threads(NUM_THREADS)
             for (u32 i = 0; i < graph.num_nodes(); ++i) {
-                if (node_remains[i]) {
-                    new_nodes[node_remains_prefix[i] - 1] = graph.nodes[i];
-                }
+                graph_nodes[i] = graph.nodes[i];
             }
-
-            /* Swapping old graph for new graph */
-            graph.nodes.swap(new_nodes);
-            graph.edges.swap(new_edges);
-            graph.sort_edges();
+            return contract_to_mst(graph_nodes, graph.num_nodes(), edges, NUM_THREADS);
         }
-
-        return mst;
     }
-};
 
-/**
- * I used this struct for debugging purposes only, it is out of date
- * so you should never use it unless you're sure about it
- */
-struct BoruvkaMST_verbose {
     /**
-     * I use the same atomic pair that I use in dsu.h
-     * TODO: create a special class for this
+     * Edge ids have to fit in E, with 64 bit ids edges have to be sorted by from,
+     * so that the edges of a node make one run, see edge_kernels.h
      */
-    const u32 EDGE_BINARY_BUCKET_SIZE = 32;
-    const u64 EDGE_WEIGHT_MASK = 0xFFFFFFFF00000000ULL;
-
-    u64 encode_edge(u32 id, u32 weight) {
-        return (static_cast<u64>(weight) << EDGE_BINARY_BUCKET_SIZE) + id;
-    }
-
-    u32 get_id(u64 encoded_edge) {
-        return static_cast<u32>(encoded_edge);
+    void check_edge_ids(GraphViewType graph, u32 NUM_THREADS) const {
+        if constexpr (WIDE_IDS) {
+            bool sorted = true;
+            #pragma omp parallel for num_threads(NUM_THREADS) reduction(&&:sorted)
+            for (E i = 1; i < graph.num_edges(); ++i) {
+                sorted = sorted && graph.edges[i - 1].from <= graph.edges[i].from;
+            }
+            if (!sorted) {
+                throw std::invalid_argument("Edges should be sorted by from for 64 bit edge ids");
+            }
+        } else if (graph.num_edges() > std::numeric_limits<u32>::max()) {
+            throw std::invalid_argument("Graph has more than 2^32 edges, 64 bit edge ids are needed for it");
+        }
     }
 
-    u32 get_weight(u64 encoded_edge) {
-        return static_cast<u32>(encoded_edge >> EDGE_BINARY_BUCKET_SIZE);
+    /* Weight key of edge id of the contracted graph, ranks are used for 64 bit weights only */
+    u32 weight_key(const EdgeType& e, E id, const ParallelArray<u32>& ranks) const {
+        if constexpr (RANKED_WEIGHTS) {
+            return ranks[id];
+        } else {
+            return WeightTraits<W>::key(e.weight);
+        }
     }
 
     /**
-     * Calculates MST of given graph and returns an EdgeSet object
-     * TODO: Current implementation uses a sequential sort, I should write my own parallel sort.
-     *       Also I don't want to use the default unordered_map because it sucks
-     *       since my keys are <= Graph.num_nodes() I can use a simple array with an std::list
+     * Rank of every edge in the order of (weight, id), these are distinct and fit in 32 bits for 32 bit ids
+     * With 64 bit ids ranks are taken among distinct weights, equal weights get equal ranks
+     * and their ties are broken by positions later, like for any other W,
+     * these fit in 32 bits unless the graph has more than 2^32 distinct weights
      */
-    ParallelArray<Edge> calculate_mst(Graph graph, u32 NUM_THREADS = omp_get_max_threads()) {
-        std::cout << graph.num_nodes() << " " << graph.num_edges() << "\n";
-        for (auto e : graph.edges) {
-            std::cout << e.from << " " << e.to << " " << e.weight << "\n";
-        }
+    ParallelArray<u32> rank_weights(GraphViewType graph, u32 NUM_THREADS) const {
+        using Key = typename WeightTraits<W>::Key;
 
-        DSU node_sets(graph.num_nodes());
-        ParallelArray<Edge> mst(graph.num_nodes() - 1);
-        u32 current_mst_size = 0;
-        u32 initial_num_nodes = graph.num_nodes();
-
-        u32 step_cnt = 0;
+        ParallelArray<std::pair<Key, E>> order(graph.num_edges(), NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (E i = 0; i < graph.num_edges(); ++i) {
+            order[i] = { WeightTraits<W>::key(graph.edges[i].weight), i };
+        }
 
-        while (graph.num_nodes() != 1) {
-            std::cout << "Step " << ++step_cnt << "\n";
+        parallel_sort(order.begin(), order.end(), NUM_THREADS);
 
-            ParallelArray<atomic_u64> shortest_edges(initial_num_nodes);
+        ParallelArray<u32> ranks(graph.num_edges(), NUM_THREADS);
+        if constexpr (!WIDE_IDS) {
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < graph.num_edges(); ++i) {
+                ranks[order[i].second] = i;
+            }
+            return ranks;
+        }
+        if (graph.num_edges() == 0) return ranks;
 
-            /* Calculating shortest edges from each node */
-            #pragma omp parallel num_threads(NUM_THREADS)
-            {
-                std::unordered_map<u32, std::pair<u32, u32>> local_shortest_edges(graph.num_nodes());
-                #pragma omp for
-                for (u32 i = 0; i < initial_num_nodes; ++i) {
-                    shortest_edges[i] = encode_edge(0, std::numeric_limits<u32>::max());
-                }
+        ParallelArray<u32> new_weight(graph.num_edges(), NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (E i = 0; i < graph.num_edges(); ++i) {
+            new_weight[i] = (i != 0 && order[i - 1].first != order[i].first);
+        }
 
-                #pragma omp single
-                std::cout << "Initialized shortest edges\n";
+        PrefixSum<u32, E> new_weight_prefix(graph.num_edges(), new_weight, NUM_THREADS);
+        if (new_weight_prefix[graph.num_edges() - 1] > std::numeric_limits<u32>::max()) {
+            throw std::invalid_argument("Graph has more than 2^32 distinct weights");
+        }
 
-                #pragma omp for
-                for (u32 i = 0; i < graph.num_edges(); ++i) {
-                    const Edge& e = graph.edges[i];
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (E i = 0; i < graph.num_edges(); ++i) {
+            ranks[order[i].second] = new_weight_prefix[i];
+        }
+        return ranks;
+    }
 
-                    if (local_shortest_edges.count(e.from) == 0 ||
-                        local_shortest_edges[e.from].first > e.weight) {
+    /**
+     * Same for a compressed graph, its weights are u32, ids are edge ids of graph
+     * node_order is ignored here, graph is taken in ORIGINAL_ORDER, see node_order
+     * Edges are decoded straight into the contracted graph block by block, in two passes:
+     * the first one counts edges that aren't self loops, the second one writes them
+     */
+    ParallelArray<E> calculate_mst_ids(const CompressedGraph& graph, u32 NUM_THREADS = omp_get_max_threads()) {
+        u32 num_blocks = graph.num_blocks();
+
+        ParallelArray<u32> block_kept(num_blocks, NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 b = 0; b < num_blocks; ++b) {
+            u32 kept = 0;
+            graph.for_each_edge_in_block(b, [&](u32, u32 from, u32 to, u32) {
+                kept += (from != to);
+            });
+            block_kept[b] = kept;
+        }
 
-                        local_shortest_edges[e.from] = { e.weight, i };
+        ContractedEdgeArraysType edges(0);
+        if (num_blocks != 0) {
+            PrefixSum block_kept_prefix(num_blocks, block_kept, NUM_THREADS);
+            ContractedEdgeArraysType kept_edges(block_kept_prefix[num_blocks - 1]);
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 b = 0; b < num_blocks; ++b) {
+                u32 position = block_kept_prefix[b] - block_kept[b];
+                graph.for_each_edge_in_block(b, [&](u32 id, u32 from, u32 to, u32 weight) {
+                    if (from != to) {
+                        kept_edges.set(position++, ContractedEdgeType(from, to, weight, id));
                     }
-                }
+                });
+            }
 
-                #pragma omp single
-                std::cout << "Calculated shortest edges in buckets\n";
+            edges.swap(kept_edges);
+        }
 
-                for (const auto& p : local_shortest_edges) { /* O(M / p) operations in each thread */
-                    #pragma omp critical
-                    std::cout << "from: " << p.first << " weight: " << p.second.first << " id: " << p.second.second  << "\n";
+        ParallelArray<u32> graph_nodes(graph.num_nodes(), NUM_THREADS);
+        parallel_iota(graph_nodes.begin(), graph.num_nodes(), 0u, NUM_THREADS);
 
-                    u64 old = shortest_edges[p.first];
+        return contract_to_mst(graph_nodes, graph.num_nodes(), edges, NUM_THREADS);
+    }
 
-                    /* p.second = { weight, id } */
-                    u64 encoded_edge = encode_edge(p.second.second, p.second.first);
+    /**
+     * Runs rounds of Boruvka's algorithm on edges of a graph with num_nodes nodes, graph_nodes of them
+     * are super-vertices at the start, returns ids of the forest edges
+     *
+     * Edges of the contracted graph are kept as structure of arrays, sorted by from,
+     * the min-edge and edge filter phases run the kernels from edge_kernels.h on them,
+     * the sort still works on ContractedEdge, edges are packed for it during the filter
+     */
+    ParallelArray<E> contract_to_mst(ArrayView<u32> graph_nodes,
+                                     u32 num_nodes,
+                                     ContractedEdgeArraysType& edges,
+                                     u32 NUM_THREADS) {
+        DSU node_sets(num_nodes, NUM_THREADS);
+        ParallelArray<E> mst_buffer(num_nodes - 1, NUM_THREADS);
+        u32 current_mst_size = 0;
+        u32 initial_num_nodes = num_nodes;
+
+        /**
+         * Active ids are nodes that are still super-vertices, the value of a node is its component,
+         * refreshed each round, late rounds iterate over the few nodes left instead of all of them
+         */
+        IterationArray<u32> nodes(initial_num_nodes, NUM_THREADS);
+        nodes.activate(graph_nodes);
+
+        /**
+         * Smallest node of the component of every root, see the edge filter below
+         * Labels only go down and nodes are deactivated once their label is smaller, so a value
+         * left from an earlier round is never below the smallest active node of its component
+         */
+        ParallelArray<atomic_u32> smallest_node(initial_num_nodes, NUM_THREADS);
+        parallel_iota(reinterpret_cast<u32*>(smallest_node.begin()), initial_num_nodes, 0u, NUM_THREADS);
+
+        /* First edges of nodes, only 64 bit edge ids need them */
+        ParallelArray<E> run_start(WIDE_IDS ? initial_num_nodes : 0, NUM_THREADS);
+
+        u32 cutoff = sequential_cutoff(NUM_THREADS);
+        profile.clear();
+
+        while (edges.size() != 0) {
+            profile.start_round(nodes.count(), edges.size(), node_sets.cas_retries());
+
+            if (edges.size() < cutoff) {
+                ParallelArray<ContractedEdgeType> tail_edges(edges.size(), NUM_THREADS);
+                #pragma omp parallel for num_threads(NUM_THREADS)
+                for (E i = 0; i < edges.size(); ++i) {
+                    tail_edges[i] = edges.get(i);
+                }
 
-                    while (true) { /* This loop is wait-free */
-                        if (get_weight(old) < p.second.first ||
-                            shortest_edges[p.first].compare_exchange_strong(old, encoded_edge)) {
-                            break;
-                        }
-                    }
-                }            
+                u32 added = kruskal_tail(tail_edges, node_sets, mst_buffer, current_mst_size);
+                current_mst_size += added;
+                profile.end_round(nodes.count() - added, 0, node_sets.cas_retries(), true);
+                break;
             }
-            std::cout << "Merged buckets\n";
 
-            for (u32 i = 0; i < graph.num_nodes(); ++i) {
-                std::cout << "node: " << graph.nodes[i] << "\n";
-                std::cout << "mineid: " << get_id(shortest_edges[graph.nodes[i]]) << "\n";
-                std::cout << "minew: " << get_weight(shortest_edges[graph.nodes[i]]) << "\n";
-            }
+            ParallelArray<atomic_u64> shortest_edges(initial_num_nodes, NUM_THREADS);
 
-            /* Calculating selected edges */
-            ParallelArray<u32> edge_selected(graph.num_edges());
+            /* Calculating shortest edges from each node */
+            nodes.for_each([&](u32 u) {
+                shortest_edges[u] = EMPTY_EDGE;
+            });
 
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_edges(); ++i) {
-                edge_selected[i] = 0;
+            if constexpr (WIDE_IDS) {
+                find_run_starts(edges, run_start, NUM_THREADS);
             }
+            find_shortest_edges(edges, shortest_edges, run_start.begin(), NUM_THREADS);
 
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_nodes(); ++i) {
-                u32 u = graph.nodes[i];
-                const Edge& min_edge_u = graph.edges[get_id(shortest_edges[u])];
+            profile.end_phase(MIN_EDGE_PHASE);
 
-                u32 v = min_edge_u.to;
+            /* Calculating selected edges */
+            ParallelArray<u32> edge_selected(edges.size(), NUM_THREADS);
+            parallel_zero(edge_selected.begin(), edges.size(), NUM_THREADS);
+
+            nodes.for_each([&](u32 u) {
+                /* Node has no edges left, its component is finished */
+                if (shortest_edges[u] == EMPTY_EDGE) return;
 
-                #pragma omp critical
-                std::cout << "u: " << u << " v: " << min_edge_u.to << " mu_id: " << get_id(shortest_edges[u]) << " mv_id: " << get_id(shortest_edges[v]) << "\n";
+                E shortest = shortest_position(u, shortest_edges, run_start);
+                u32 v = edges.to[shortest];
+                u32 v_partner = edges.to[shortest_position(v, shortest_edges, run_start)];
 
-                const Edge& min_edge_v = graph.edges[get_id(shortest_edges[v])];
-                
-                if (min_edge_v.to != u || (min_edge_v.to == u && u < v)) {
-                    node_sets.unite(u, v);
-                    edge_selected[get_id(shortest_edges[u])] = 1;
-                    #pragma omp critical
-                    std:: cout << "selected " << get_id(shortest_edges[u]) << " from " << u << " to " << v << "\n";
+                /* unite() fails if some other thread has already joined u and v, e.g. on equal weights */
+                if (v_partner != u || u < v) {
+                    if (node_sets.unite(u, v)) {
+                        edge_selected[shortest] = 1;
+                    }
                 }
-            }
-            std::cout << "Calculated selected edges\n";
+            });
+
+            profile.end_phase(SELECT_PHASE);
 
             /* Adding edges to MST */
-            PrefixSum edge_selected_prefix(graph.num_edges(), edge_selected);
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_edges(); ++i) {
+            PrefixSum<u32, E> edge_selected_prefix(edges.size(), edge_selected, NUM_THREADS);
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (E i = 0; i < edges.size(); ++i) {
                 if (edge_selected[i]) {
-                    #pragma omp critical
-                    std::cout << "Put edge no. " << i << " to position " << current_mst_size + edge_selected_prefix[i] - 1 << "\n";
-                    mst[current_mst_size + edge_selected_prefix[i] - 1] = graph.edges[i];
+                    mst_buffer[current_mst_size + edge_selected_prefix[i] - 1] = edges.id[i];
                 }
             }
-            current_mst_size += edge_selected_prefix[graph.num_edges() - 1];
-            std::cout << "Added mst edges\n";
-
-            /* Calculating remaining edges */
-            ParallelArray<u32> edge_remains(graph.num_edges());
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_edges(); ++i) {
-                edge_remains[i] = !node_sets.same_set(graph.edges[i].from, graph.edges[i].to);
-            }
-
-            PrefixSum edge_remains_prefix(graph.num_edges(), edge_remains);
-            ParallelArray<Edge> new_edges(edge_remains_prefix[graph.num_edges() - 1]);
-                
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_edges(); ++i) {
+            current_mst_size += edge_selected_prefix[edges.size() - 1];
+            profile.end_phase(MST_APPEND_PHASE);
+
+            /**
+             * Calculating remaining edges
+             * Components are named after their smallest node, DSU roots depend on the order of unites,
+             * so with them the order of contracted edges and the ties of later rounds would depend on threads
+             */
+            nodes.for_each([&](u32 u) {
+                nodes[u] = node_sets.find_root(u);
+            });
+            nodes.for_each([&](u32 u) {
+                u32 old = smallest_node[nodes[u]].load(std::memory_order_relaxed);
+                while (old > u && !smallest_node[nodes[u]].compare_exchange_weak(old, u)) {}
+            });
+            nodes.for_each([&](u32 u) {
+                nodes[u] = smallest_node[nodes[u]];
+            });
+
+            ParallelArray<u32> edge_remains(edges.size(), NUM_THREADS);
+            relabel_edges(edges, nodes.arr, edge_remains, NUM_THREADS);
+
+            PrefixSum<u32, E> edge_remains_prefix(edges.size(), edge_remains, NUM_THREADS);
+            ParallelArray<ContractedEdgeType> new_edges(edge_remains_prefix[edges.size() - 1], NUM_THREADS);
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (E i = 0; i < edges.size(); ++i) {
                 if (edge_remains[i]) {
-                    const Edge& old_edge = graph.edges[i];
-                    new_edges[edge_remains_prefix[i] - 1] = Edge(node_sets.find_root(old_edge.from),
-                                                                    node_sets.find_root(old_edge.to),
-                                                                    old_edge.weight);
+                    new_edges[edge_remains_prefix[i] - 1] = edges.get(i);
                 }
             }
-            std::cout << "Created new edges\n";
-                
+
+            profile.end_phase(EDGE_FILTER_PHASE);
+
             /* Calculating remaining nodes */
-            ParallelArray<u32> node_remains(graph.num_nodes());
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_nodes(); ++i) {
-                node_remains[i] = (
-                    node_sets.find_root(graph.nodes[i]) == graph.nodes[i]
-                );
-            }
+            nodes.deactivate_if([&](u32 u) {
+                return nodes[u] != u;
+            });
 
-            PrefixSum node_remains_prefix(graph.num_nodes(), node_remains);
-            ParallelArray<u32> new_nodes(node_remains_prefix[graph.num_nodes() - 1]);
+            profile.end_phase(NODE_FILTER_PHASE);
 
-            #pragma omp parallel for
-            for (u32 i = 0; i < graph.num_nodes(); ++i) {
-                if (node_remains[i]) {
-                    new_nodes[node_remains_prefix[i] - 1] = graph.nodes[i];
+            /* Swapping old graph for new graph */
+            parallel_sort(new_edges.begin(), new_edges.end(), NUM_THREADS);
+
+            /* Only the lightest of parallel edges between two super-vertices can get into MST */
+            ContractedEdgeArraysType unique_edges(0);
+            if (new_edges.size() != 0) {
+                ParallelArray<u32> edge_unique(new_edges.size(), NUM_THREADS);
+                #pragma omp parallel for num_threads(NUM_THREADS)
+                for (E i = 0; i < new_edges.size(); ++i) {
+                    edge_unique[i] = (i == 0 ||
+                                      new_edges[i - 1].from != new_edges[i].from ||
+                                      new_edges[i - 1].to != new_edges[i].to);
                 }
-            }
-            std::cout << "Created new nodes\n";
 
-            /* Swapping old graph for new graph */
-            graph.nodes.swap(new_nodes);
-            graph.edges.swap(new_edges);
-            graph.sort_edges();
+                PrefixSum<u32, E> edge_unique_prefix(new_edges.size(), edge_unique, NUM_THREADS);
+                ContractedEdgeArraysType deduplicated(edge_unique_prefix[new_edges.size() - 1]);
 
-            std::cout << "Num nodes: " << graph.num_nodes() << "\n";
-            for (u32 i = 0; i < graph.num_nodes(); ++i) {
-                std::cout << graph.nodes[i] << "\n";
-            }
+                #pragma omp parallel for num_threads(NUM_THREADS)
+                for (E i = 0; i < new_edges.size(); ++i) {
+                    if (edge_unique[i]) {
+                        deduplicated.set(edge_unique_prefix[i] - 1, new_edges[i]);
+                    }
+                }
 
-            std::cout << "Num edges: " << graph.num_edges() << "\n";
-            for (u32 i = 0; i < graph.num_edges(); ++i) {
-                std::cout << graph.edges[i].from << " " << graph.edges[i].to << "\n";
+                unique_edges.swap(deduplicated);
             }
+            edges.swap(unique_edges);
+
+            profile.end_phase(SORT_PHASE);
+            profile.end_round(nodes.count(), edges.size(), node_sets.cas_retries());
+        }
+
+        ParallelArray<E> mst_ids(current_mst_size, NUM_THREADS);
+        parallel_copy(mst_buffer.begin(), mst_ids.begin(), current_mst_size, NUM_THREADS);
+
+        return mst_ids;
+    }
+
+    /**
+     * Calculates MST of given graph and returns a ParallelArray<Edge> object
+     * Edges keep their original endpoints, for a disconnected graph a spanning forest is returned
+     */
+    ParallelArray<EdgeType> calculate_mst(GraphViewType graph, u32 NUM_THREADS = omp_get_max_threads()) {
+        ParallelArray<E> mst_ids = calculate_mst_ids(graph, NUM_THREADS);
+        ParallelArray<EdgeType> mst(mst_ids.size(), NUM_THREADS);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < mst_ids.size(); ++i) {
+            mst[i] = graph.edges[mst_ids[i]];
+        }
+
+        return mst;
+    }
+
+    ParallelArray<Edge> calculate_mst(const CompressedGraph& graph, u32 NUM_THREADS = omp_get_max_threads()) {
+        ParallelArray<E> mst_ids = calculate_mst_ids(graph, NUM_THREADS);
+        ParallelArray<Edge> mst(mst_ids.size(), NUM_THREADS);
 
-            std::cout << "Swapped, sorted\n";
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < mst_ids.size(); ++i) {
+            mst[i] = graph.get(mst_ids[i]);
         }
 
         return mst;
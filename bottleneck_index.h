@@ -0,0 +1,201 @@
+#ifndef __BOTTLENECK_INDEX_H
+#define __BOTTLENECK_INDEX_H
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <stdexcept>
+
+#include "defs.h"
+#include "euler_tour.h"
+#include "graph.h"
+#include "parallel_array.h"
+
+/**
+ * INTERFACE:
+ *
+ * BottleneckIndex<W>(uint32_t num_nodes,
+ *                    const ParallelArray<BasicEdge<W, I>>& forest_edges,
+ *                    uint32_t NUM_THREADS) - index over a minimum spanning forest, e.g. of BoruvkaMST
+ * W query(uint32_t u, uint32_t v) - the largest weight on the forest path between u and v,
+ *     that is the minimum bottleneck between u and v in the whole graph
+ * ParallelArray<W> query(const ParallelArray<uint32_t>& from,
+ *                        const ParallelArray<uint32_t>& to) - answers of a batch of queries, in parallel
+ * uint32_t num_levels() - number of jumps stored per node
+ *
+ * Nodes in different trees have no path, their answer is NO_PATH, the largest W,
+ * a node and itself have an empty path, its answer is EMPTY_PATH, the smallest W
+ *
+ * DETAILS:
+ *
+ * Binary lifting over RootedForest: jump k of v is its ancestor 2^k levels up and the largest weight
+ * on the way there, jumps of a root stay at it. Level k is built from level k - 1 in parallel,
+ * only levels up to the depth of the deepest node are stored, minimum spanning trees
+ * of random graphs are shallow, so that is far less than log2(num_nodes) levels
+ *
+ * A query lifts the deeper node to the depth of the other one, then lifts both below their LCA,
+ * O(num_levels) steps, no writes, so queries of a batch run in parallel without synchronization
+ *
+ * Jumps are stored node by node, a query tries several levels at the same node before it moves,
+ * so they come from one or two cache lines. Every query is a chain of dependent random loads,
+ * so the batched query prefetches the nodes of the query PREFETCH_DISTANCE ahead
+ * and misses of different queries overlap
+ */
+template<typename W = u32>
+struct BottleneckIndex {
+    static constexpr W NO_PATH = std::numeric_limits<W>::max();
+    static constexpr W EMPTY_PATH = std::numeric_limits<W>::lowest();
+    static constexpr u32 PREFETCH_DISTANCE = 8;
+
+    struct Jump {
+        u32 ancestor;
+        W max_weight;
+    };
+
+    const u32 NUM_THREADS;
+
+    RootedForest forest;
+    u32 levels;
+    ParallelArray<Jump> jumps;
+
+    template<typename I>
+    BottleneckIndex(u32 num_nodes,
+                    const ParallelArray<BasicEdge<W, I>>& forest_edges,
+                    u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+                                                               forest(num_nodes, forest_edges, NUM_THREADS),
+                                                               levels(0),
+                                                               jumps(0, NUM_THREADS) {
+        u32 max_depth = 0;
+        #pragma omp parallel for num_threads(NUM_THREADS) reduction(max:max_depth)
+        for (u32 v = 0; v < num_nodes; ++v) {
+            max_depth = std::max(max_depth, forest.depth[v]);
+        }
+
+        levels = 1;
+        while (levels < 32 && (1ULL << levels) <= max_depth) {
+            ++levels;
+        }
+
+        ParallelArray<Jump> new_jumps(static_cast<u64>(num_nodes) * levels, NUM_THREADS);
+        jumps.swap(new_jumps);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 v = 0; v < num_nodes; ++v) {
+            if (forest.is_root(v)) {
+                jump(v, 0) = { v, EMPTY_PATH };
+            }
+        }
+
+        /* In a forest the child of an edge is the end whose parent is the other end */
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < forest_edges.size(); ++i) {
+            u32 from = forest_edges[i].from;
+            u32 to = forest_edges[i].to;
+            u32 child = (forest.parent[from] == to ? from : to);
+            jump(child, 0) = { forest.parent[child], forest_edges[i].weight };
+        }
+
+        for (u32 k = 1; k < levels; ++k) {
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 v = 0; v < num_nodes; ++v) {
+                const Jump& half = jump(v, k - 1);
+                const Jump& rest = jump(half.ancestor, k - 1);
+                jump(v, k) = { rest.ancestor, std::max(half.max_weight, rest.max_weight) };
+            }
+        }
+    }
+
+    BottleneckIndex(const BottleneckIndex&) = delete;
+
+    u32 num_nodes() const {
+        return forest.num_nodes();
+    }
+
+    u32 num_levels() const {
+        return levels;
+    }
+
+    Jump& jump(u32 v, u32 k) {
+        return jumps[static_cast<u64>(v) * levels + k];
+    }
+
+    const Jump& jump(u32 v, u32 k) const {
+        return jumps[static_cast<u64>(v) * levels + k];
+    }
+
+    void check_out_of_range(u32 u) const {
+        if (u >= num_nodes()) {
+            throw std::out_of_range("Node id out of range");
+        }
+    }
+
+    W query(u32 u, u32 v) const {
+        check_out_of_range(u);
+        check_out_of_range(v);
+        return path_max(u, v);
+    }
+
+    ParallelArray<W> query(const ParallelArray<u32>& from, const ParallelArray<u32>& to) const {
+        if (from.size() != to.size()) {
+            throw std::invalid_argument("Batch should have as many from nodes as to nodes");
+        }
+
+        u64 num_queries = from.size();
+        u64 out_of_range = 0;
+        #pragma omp parallel for num_threads(NUM_THREADS) reduction(+:out_of_range)
+        for (u64 i = 0; i < num_queries; ++i) {
+            out_of_range += (from[i] >= num_nodes() || to[i] >= num_nodes());
+        }
+        if (out_of_range != 0) {
+            throw std::out_of_range("Node id out of range");
+        }
+
+        ParallelArray<W> result(num_queries, NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS) schedule(static)
+        for (u64 i = 0; i < num_queries; ++i) {
+            if (i + PREFETCH_DISTANCE < num_queries) {
+                __builtin_prefetch(&jump(from[i + PREFETCH_DISTANCE], 0));
+                __builtin_prefetch(&jump(to[i + PREFETCH_DISTANCE], 0));
+                __builtin_prefetch(&forest.depth[from[i + PREFETCH_DISTANCE]]);
+                __builtin_prefetch(&forest.depth[to[i + PREFETCH_DISTANCE]]);
+            }
+            result[i] = path_max(from[i], to[i]);
+        }
+
+        return result;
+    }
+
+    W path_max(u32 u, u32 v) const {
+        if (u == v) return EMPTY_PATH;
+
+        W result = EMPTY_PATH;
+        if (forest.depth[u] < forest.depth[v]) std::swap(u, v);
+
+        u32 lift = forest.depth[u] - forest.depth[v];
+        for (u32 k = 0; lift != 0; ++k, lift >>= 1) {
+            if (lift & 1) {
+                result = std::max(result, jump(u, k).max_weight);
+                u = jump(u, k).ancestor;
+            }
+        }
+        if (u == v) return result;
+
+        for (u32 k = levels; k-- > 0;) {
+            const Jump& up_u = jump(u, k);
+            const Jump& up_v = jump(v, k);
+            if (up_u.ancestor != up_v.ancestor) {
+                result = std::max({ result, up_u.max_weight, up_v.max_weight });
+                u = up_u.ancestor;
+                v = up_v.ancestor;
+            }
+        }
+
+        /* Below the LCA both nodes have the same parent, unless they are roots of different trees */
+        const Jump& up_u = jump(u, 0);
+        const Jump& up_v = jump(v, 0);
+        if (up_u.ancestor != up_v.ancestor) return NO_PATH;
+        return std::max({ result, up_u.max_weight, up_v.max_weight });
+    }
+};
+
+#endif
@@ -0,0 +1,307 @@
+#ifndef __COMPRESSED_GRAPH_H
+#define __COMPRESSED_GRAPH_H
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <stdexcept>
+
+#include "defs.h"
+#include "dsu.h"
+#include "graph.h"
+#include "parallel_array.h"
+#include "parallel_memory.h"
+#include "prefix_sum.h"
+
+/**
+ * INTERFACE:
+ *
+ * CompressedGraph(GraphView graph, uint32_t NUM_THREADS) - compresses graph, its edges should be sorted by from and to,
+ *     edge ids are 32 bit, graphs with more than 2^32 edges throw std::invalid_argument
+ * uint32_t num_nodes(), uint32_t num_edges()
+ * uint32_t num_blocks() - number of blocks, each of them is decoded on its own
+ * uint64_t size_in_bytes() - memory taken by the compressed graph
+ * void for_each_edge_in_block(uint32_t block, F f) - calls f(id, from, to, weight) for edges of block in order
+ * void for_each_edge(F f) - the same for every edge, blocks are decoded in parallel
+ * Edge get(uint32_t id) - edge id, decodes a part of one block
+ * Graph decompress() - the graph it was built from
+ *
+ * ParallelArray<uint32_t> connected_components(const CompressedGraph& graph, uint32_t NUM_THREADS) - component root of every node
+ * bool is_connected(const CompressedGraph& graph, uint32_t NUM_THREADS)
+ *
+ * DETAILS:
+ *
+ * Adjacency lists are delta coded like in Ligra+: edges are sorted by from and to,
+ * so from is implied by the block and every target is stored as its difference with the previous one
+ * Lists are cut into blocks of at most BLOCK_EDGES edges, the first target of a block is coded relative
+ * to from with zigzag, it can be smaller, so no block depends on another one and they are decoded in parallel
+ *
+ * Differences are byte varints: 7 bits per byte, low bits first, the high bit is set if another byte follows
+ * Weights of our graphs are random 32 bit values that don't compress, they are kept in a plain array
+ * indexed by edge id
+ *
+ * Every block keeps its node, its first edge and its byte offset, 12 bytes per block,
+ * Edge takes 12 bytes per edge, the compressed graph 4 bytes for the weight and 1 to 5 for the target,
+ * how many depends on the gaps between neighbors, so locality of node ids pays off
+ *
+ * Edge ids are positions in the sorted edge array of the source graph, MST ids computed on either of them match
+ */
+struct CompressedGraph {
+    static constexpr u32 BLOCK_EDGES = 64;
+
+    const u32 NUM_THREADS;
+
+    u32 nodes_count;
+
+    ParallelArray<u32> weights;
+
+    /* Block b has edges block_edge[b], ..., block_edge[b + 1] - 1 of node block_node[b] */
+    ParallelArray<u32> block_node;
+    ParallelArray<u32> block_edge;
+    ParallelArray<u32> block_offset;
+
+    ParallelArray<u8> bytes;
+
+    explicit CompressedGraph(GraphView graph, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+                                                                                         nodes_count(graph.num_nodes()),
+                                                                                         weights(checked_num_edges(graph), NUM_THREADS),
+                                                                                         block_node(0, NUM_THREADS),
+                                                                                         block_edge(1, NUM_THREADS),
+                                                                                         block_offset(1, NUM_THREADS),
+                                                                                         bytes(0, NUM_THREADS) {
+        u32 num_nodes = graph.num_nodes();
+        u32 num_edges = graph.num_edges();
+
+        u32 unsorted = 0, out_of_range = 0;
+        #pragma omp parallel for num_threads(NUM_THREADS) reduction(+:unsorted, out_of_range)
+        for (u32 i = 0; i < num_edges; ++i) {
+            const Edge& e = graph.edges[i];
+            out_of_range += (e.from >= num_nodes || e.to >= num_nodes);
+            if (i > 0) {
+                const Edge& prev = graph.edges[i - 1];
+                unsorted += (prev.from > e.from || (prev.from == e.from && prev.to > e.to));
+            }
+        }
+        if (out_of_range != 0) {
+            throw std::invalid_argument("Edge ends should be nodes of the graph");
+        }
+        if (unsorted != 0) {
+            throw std::invalid_argument("Edges should be sorted by from and to before compression");
+        }
+
+        /* Edges of node u are first_edge[u], ..., first_edge[u + 1] - 1 */
+        ParallelArray<u32> first_edge(num_nodes + 1, NUM_THREADS);
+        ParallelArray<u32> node_blocks(num_nodes, NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 u = 0; u <= num_nodes; ++u) {
+            first_edge[u] = std::lower_bound(graph.edges.begin(), graph.edges.end(), u, [](const Edge& e, u32 node) {
+                return e.from < node;
+            }) - graph.edges.begin();
+        }
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 u = 0; u < num_nodes; ++u) {
+            node_blocks[u] = (first_edge[u + 1] - first_edge[u] + BLOCK_EDGES - 1) / BLOCK_EDGES;
+        }
+
+        block_edge[0] = 0;
+        block_offset[0] = 0;
+        if (num_nodes == 0 || num_edges == 0) return;
+
+        PrefixSum node_blocks_prefix(num_nodes, node_blocks, NUM_THREADS);
+        u32 num_blocks = node_blocks_prefix[num_nodes - 1];
+
+        ParallelArray<u32>(num_blocks, NUM_THREADS).swap(block_node);
+        ParallelArray<u32>(num_blocks + 1, NUM_THREADS).swap(block_edge);
+        ParallelArray<u32>(num_blocks + 1, NUM_THREADS).swap(block_offset);
+        block_offset[0] = 0;
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 u = 0; u < num_nodes; ++u) {
+            u32 block = node_blocks_prefix[u] - node_blocks[u];
+            for (u32 k = 0; k < node_blocks[u]; ++k) {
+                block_node[block + k] = u;
+                block_edge[block + k] = first_edge[u] + k * BLOCK_EDGES;
+            }
+        }
+        block_edge[num_blocks] = num_edges;
+
+        /* Sizes of blocks first, then every block is encoded at its offset */
+        ParallelArray<u64> block_bytes(num_blocks, NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 b = 0; b < num_blocks; ++b) {
+            block_bytes[b] = encode_block(graph, b, nullptr);
+        }
+
+        PrefixSum block_bytes_prefix(num_blocks, block_bytes, NUM_THREADS);
+        if (block_bytes_prefix[num_blocks - 1] > std::numeric_limits<u32>::max()) {
+            throw std::invalid_argument("Compressed edges don't fit in 4GB");
+        }
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 b = 0; b < num_blocks; ++b) {
+            block_offset[b + 1] = block_bytes_prefix[b];
+        }
+
+        ParallelArray<u8>(block_offset[num_blocks], NUM_THREADS).swap(bytes);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 b = 0; b < num_blocks; ++b) {
+            encode_block(graph, b, bytes.begin() + block_offset[b]);
+        }
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < num_edges; ++i) {
+            weights[i] = graph.edges[i].weight;
+        }
+    }
+
+    /* Checked before anything is allocated, ids of blocks and weights are u32 */
+    static u32 checked_num_edges(GraphView graph) {
+        if (graph.num_edges() > std::numeric_limits<u32>::max()) {
+            throw std::invalid_argument("Graph has more than 2^32 edges, compressed graphs have 32 bit edge ids");
+        }
+        return graph.num_edges();
+    }
+
+    u32 num_nodes() const {
+        return nodes_count;
+    }
+
+    u32 num_edges() const {
+        return weights.size();
+    }
+
+    u32 num_blocks() const {
+        return block_node.size();
+    }
+
+    u64 size_in_bytes() const {
+        return static_cast<u64>(weights.size()) * sizeof(u32) +
+               static_cast<u64>(block_node.size()) * sizeof(u32) +
+               static_cast<u64>(block_edge.size()) * sizeof(u32) +
+               static_cast<u64>(block_offset.size()) * sizeof(u32) +
+               bytes.size();
+    }
+
+    /* Writes value to out if it isn't nullptr, returns the number of bytes it takes */
+    static u32 encode_varint(u64 value, u8* out) {
+        u32 length = 1;
+        for (; value >= 0x80; value >>= 7, ++length) {
+            if (out) *out++ = static_cast<u8>(value | 0x80);
+        }
+        if (out) *out = static_cast<u8>(value);
+        return length;
+    }
+
+    /* Reads a varint starting at in and moves in past it */
+    static u64 decode_varint(const u8*& in) {
+        u64 value = *in++;
+        if (value < 0x80) return value;
+
+        value &= 0x7F;
+        for (u32 shift = 7; ; shift += 7) {
+            u64 byte = *in++;
+            value |= (byte & 0x7F) << shift;
+            if (byte < 0x80) return value;
+        }
+    }
+
+    /* Maps to - from to a non-negative number, small differences of both signs stay small */
+    static u64 zigzag(u32 from, u32 to) {
+        return to >= from ? 2 * static_cast<u64>(to - from) : 2 * static_cast<u64>(from - to) - 1;
+    }
+
+    static u32 unzigzag(u32 from, u64 value) {
+        return value % 2 == 0 ? from + static_cast<u32>(value / 2) : from - static_cast<u32>((value + 1) / 2);
+    }
+
+    /* Encodes targets of block to out if it isn't nullptr, returns the number of bytes they take */
+    u64 encode_block(GraphView graph, u32 block, u8* out) const {
+        u32 from = block_node[block];
+        u32 begin = block_edge[block];
+        u32 end = block_edge[block + 1];
+
+        u64 length = encode_varint(zigzag(from, graph.edges[begin].to), out);
+        for (u32 i = begin + 1; i < end; ++i) {
+            length += encode_varint(graph.edges[i].to - graph.edges[i - 1].to, out ? out + length : nullptr);
+        }
+        return length;
+    }
+
+    template<typename F>
+    void for_each_edge_in_block(u32 block, F f) const {
+        u32 from = block_node[block];
+        u32 begin = block_edge[block];
+        u32 end = block_edge[block + 1];
+        const u8* in = bytes.begin() + block_offset[block];
+
+        u32 to = unzigzag(from, decode_varint(in));
+        f(begin, from, to, weights[begin]);
+        for (u32 id = begin + 1; id < end; ++id) {
+            to += static_cast<u32>(decode_varint(in));
+            f(id, from, to, weights[id]);
+        }
+    }
+
+    template<typename F>
+    void for_each_edge(F f) const {
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 block = 0; block < num_blocks(); ++block) {
+            for_each_edge_in_block(block, f);
+        }
+    }
+
+    Edge get(u32 id) const {
+        if (id >= num_edges()) {
+            throw std::out_of_range("Edge id out of range");
+        }
+
+        u32 block = std::upper_bound(block_edge.begin(), block_edge.begin() + num_blocks(), id) - block_edge.begin() - 1;
+        u32 from = block_node[block];
+        const u8* in = bytes.begin() + block_offset[block];
+
+        u32 to = unzigzag(from, decode_varint(in));
+        for (u32 i = block_edge[block]; i < id; ++i) {
+            to += static_cast<u32>(decode_varint(in));
+        }
+        return Edge(from, to, weights[id]);
+    }
+
+    Graph decompress() const {
+        Graph G(num_nodes(), num_edges());
+        parallel_iota(G.nodes.begin(), num_nodes(), 0u, NUM_THREADS);
+
+        for_each_edge([&](u32 id, u32 from, u32 to, u32 weight) {
+            G.edges[id] = Edge(from, to, weight);
+        });
+        return G;
+    }
+};
+
+ParallelArray<u32> connected_components(const CompressedGraph& graph, u32 NUM_THREADS = omp_get_max_threads()) {
+    DSU node_sets(graph.num_nodes(), NUM_THREADS);
+    graph.for_each_edge([&](u32, u32 from, u32 to, u32) {
+        node_sets.unite(from, to);
+    });
+
+    ParallelArray<u32> component(graph.num_nodes(), NUM_THREADS);
+    #pragma omp parallel for num_threads(NUM_THREADS)
+    for (u32 u = 0; u < graph.num_nodes(); ++u) {
+        component[u] = node_sets.find_root(u);
+    }
+    return component;
+}
+
+bool is_connected(const CompressedGraph& graph, u32 NUM_THREADS = omp_get_max_threads()) {
+    ParallelArray<u32> component = connected_components(graph, NUM_THREADS);
+
+    u32 num_comp = 0;
+    #pragma omp parallel for num_threads(NUM_THREADS) reduction(+:num_comp)
+    for (u32 u = 0; u < graph.num_nodes(); ++u) {
+        num_comp += (component[u] == u);
+    }
+    return num_comp == 1;
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef __CONCURRENT_HASH_TABLE_H
+#define __CONCURRENT_HASH_TABLE_H
+
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <omp.h>
+#include <stdexcept>
+
+#include "defs.h"
+#include "instrumentation.h"
+#include "parallel_array.h"
+#include "parallel_memory.h"
+#include "prefix_sum.h"
+
+/**
+ * INTERFACE:
+ *
+ * ConcurrentHashTable(uint64_t capacity, uint32_t NUM_THREADS) - empty table for at most capacity keys
+ * bool insert(uint64_t key, uint64_t value) - adds key with value, false if key is already there
+ * void update_min(uint64_t key, uint64_t value) - adds key with value or lowers its value to value
+ * uint64_t find(uint64_t key) - value of key, NOT_FOUND if there is no key
+ * bool contains(uint64_t key) - checks if key is there
+ * uint64_t count() - number of keys, counted in parallel
+ * void for_each(F f) - calls f(key, value) for every key in parallel, in no particular order
+ * ParallelArray<HashTableEntry> entries() - keys and values compacted into an array, in slot order
+ * void clear() - removes every key
+ *
+ * pack_pair(uint32_t first, uint32_t second), pair_first(key), pair_second(key) - keys of pairs, e.g. edges
+ *
+ * DETAILS:
+ *
+ * Open addressing with linear probing, there are no locks: a key is claimed with a CAS
+ * of an empty slot, then its value is set with a CAS from NOT_FOUND, so insert(), update_min()
+ * and find() can run at the same time from any number of threads
+ * Keys are never removed one by one, so a probe stops at the first empty slot
+ *
+ * Slots are pairs of u64 and 4 of them make a bucket of one cache line, buckets are aligned,
+ * a key hashes to the start of a bucket, so the first probe loads one line and usually ends there
+ *
+ * The table has at least capacity / MAX_LOAD slots, rounded up to a power of two,
+ * inserting into a full table throws std::out_of_range
+ * EMPTY_KEY and NOT_FOUND are reserved, a key or value equal to them throws std::invalid_argument
+ *
+ * update_min() is the same wait-free loop as update_min_edge() in edge_kernels.h, so values
+ * can be (weight << 32) | id encodings of edges and the table keeps the lightest edge of every key
+ */
+struct HashTableEntry {
+    u64 key;
+    u64 value;
+};
+
+struct ConcurrentHashTable {
+    static constexpr u64 EMPTY_KEY = std::numeric_limits<u64>::max();
+    static constexpr u64 NOT_FOUND = std::numeric_limits<u64>::max();
+
+    static constexpr u32 CACHE_LINE_SIZE = 64;
+    static constexpr u32 SLOTS_PER_BUCKET = CACHE_LINE_SIZE / (2 * sizeof(u64));
+    static constexpr double MAX_LOAD = 0.5;
+    static constexpr std::align_val_t ALIGNMENT = static_cast<std::align_val_t>(CACHE_LINE_SIZE);
+
+    struct Slot {
+        atomic_u64 key;
+        atomic_u64 value;
+    };
+
+    static_assert(sizeof(Slot) == 2 * sizeof(u64), "Slots should be two words, they are filled as u64 arrays");
+
+    const u32 NUM_THREADS;
+
+    u64 num_slots;
+    u64 slot_mask;
+    u64 bucket_mask;
+    Slot* slots;
+
+    ConcurrentHashTable(u64 capacity, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS) {
+        num_slots = SLOTS_PER_BUCKET;
+        while (num_slots * MAX_LOAD < capacity) {
+            num_slots *= 2;
+        }
+        slot_mask = num_slots - 1;
+        bucket_mask = num_slots / SLOTS_PER_BUCKET - 1;
+
+        slots = static_cast<Slot*>(operator new[] (num_slots * sizeof(Slot), ALIGNMENT));
+        INSTRUMENT_ALLOCATION(num_slots * sizeof(Slot));
+
+        clear();
+    }
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+
+    ~ConcurrentHashTable() {
+        operator delete[] (slots, ALIGNMENT);
+    }
+
+    static u64 pack_pair(u32 first, u32 second) {
+        return (static_cast<u64>(first) << 32) | second;
+    }
+
+    static u32 pair_first(u64 key) {
+        return static_cast<u32>(key >> 32);
+    }
+
+    static u32 pair_second(u64 key) {
+        return static_cast<u32>(key);
+    }
+
+    /* Finalizer of MurmurHash3, packed pairs differ in few bits, so they need a good mix */
+    static u64 hash(u64 key) {
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDULL;
+        key ^= key >> 33;
+        key *= 0xC4CEB9FE1A85EC53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    u64 num_buckets() const {
+        return num_slots / SLOTS_PER_BUCKET;
+    }
+
+    /* Slot of key, claimed for it if claim is true and key isn't there, num_slots if there is no such slot */
+    u64 locate(u64 key, bool claim) {
+        u64 i = (hash(key) & bucket_mask) * SLOTS_PER_BUCKET;
+        for (u64 probe = 0; probe < num_slots; ++probe, i = (i + 1) & slot_mask) {
+            u64 current = slots[i].key.load(std::memory_order_acquire);
+            if (current == EMPTY_KEY) {
+                if (!claim) return num_slots;
+                if (slots[i].key.compare_exchange_strong(current, key)) return i;
+            }
+            /* A failed CAS loaded the key that took the slot */
+            if (current == key) return i;
+        }
+
+        if (claim) throw std::out_of_range("Concurrent hash table is full");
+        return num_slots;
+    }
+
+    u64 locate(u64 key) const {
+        return const_cast<ConcurrentHashTable*>(this)->locate(key, false);
+    }
+
+    static void check_entry(u64 key, u64 value) {
+        if (key == EMPTY_KEY || value == NOT_FOUND) {
+            throw std::invalid_argument("Keys and values of a hash table can't be 2^64 - 1");
+        }
+    }
+
+    bool insert(u64 key, u64 value) {
+        check_entry(key, value);
+
+        u64 expected = NOT_FOUND;
+        return slots[locate(key, true)].value.compare_exchange_strong(expected, value);
+    }
+
+    void update_min(u64 key, u64 value) {
+        check_entry(key, value);
+
+        atomic_u64& current = slots[locate(key, true)].value;
+        u64 old = current.load(std::memory_order_relaxed);
+        while (old > value) {
+            if (current.compare_exchange_weak(old, value)) {
+                break;
+            }
+        }
+    }
+
+    /* A key whose value isn't set yet isn't found */
+    u64 find(u64 key) const {
+        u64 i = locate(key);
+        return i == num_slots ? NOT_FOUND : slots[i].value.load(std::memory_order_acquire);
+    }
+
+    bool contains(u64 key) const {
+        return find(key) != NOT_FOUND;
+    }
+
+    bool occupied(u64 i) const {
+        return slots[i].key.load(std::memory_order_relaxed) != EMPTY_KEY &&
+               slots[i].value.load(std::memory_order_relaxed) != NOT_FOUND;
+    }
+
+    u64 count() const {
+        u64 result = 0;
+        #pragma omp parallel for num_threads(NUM_THREADS) reduction(+:result)
+        for (u64 i = 0; i < num_slots; ++i) {
+            result += occupied(i);
+        }
+        return result;
+    }
+
+    template<typename F>
+    void for_each(F f) const {
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u64 i = 0; i < num_slots; ++i) {
+            if (occupied(i)) {
+                f(slots[i].key.load(std::memory_order_relaxed), slots[i].value.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    /* Compaction by buckets: occupied slots of each bucket are counted, then written at the prefix sums */
+    ParallelArray<HashTableEntry> entries() const {
+        ParallelArray<u32> bucket_count(num_buckets(), NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u64 b = 0; b < num_buckets(); ++b) {
+            u32 occupied_slots = 0;
+            for (u32 k = 0; k < SLOTS_PER_BUCKET; ++k) {
+                occupied_slots += occupied(b * SLOTS_PER_BUCKET + k);
+            }
+            bucket_count[b] = occupied_slots;
+        }
+
+        PrefixSum<u32, u64> bucket_prefix(num_buckets(), bucket_count, NUM_THREADS);
+        ParallelArray<HashTableEntry> result(bucket_prefix[num_buckets() - 1], NUM_THREADS);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u64 b = 0; b < num_buckets(); ++b) {
+            u64 position = bucket_prefix[b] - bucket_count[b];
+            for (u32 k = 0; k < SLOTS_PER_BUCKET; ++k) {
+                u64 i = b * SLOTS_PER_BUCKET + k;
+                if (occupied(i)) {
+                    result[position++] = { slots[i].key.load(std::memory_order_relaxed),
+                                           slots[i].value.load(std::memory_order_relaxed) };
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /* Keys and values are both 2^64 - 1 when empty, so this is one fill of 2 * num_slots words */
+    void clear() {
+        parallel_fill(reinterpret_cast<u64*>(slots), 2 * num_slots, EMPTY_KEY, NUM_THREADS);
+    }
+};
+
+#endif
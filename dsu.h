@@ -6,7 +6,9 @@
 #include <stdexcept>
 
 #include "defs.h"
+#include "instrumentation.h"
 #include "parallel_array.h"
+#include "parallel_memory.h"
 
 /**
  * INTERFACE:
@@ -14,7 +16,8 @@
  * DSU(uint32_t N, uint32_t NUM_THREADS) - constructs a DSU of size N using NUM_THREADS
  * uint32_t find_root(uint32_t id) - finds root node of id
  * bool same_set(uint32_t id1, uint32_t id2) - checks if id1 and id2 are in the same set
- * void unite(uint32_t id1, uint32_t id2) - unites sets of id1 and id2
+ * bool unite(uint32_t id1, uint32_t id2) - unites sets of id1 and id2, returns false if they were already united
+ * uint64_t cas_retries() - number of failed linking CAS in unite, counted with ENABLE_INSTRUMENTATION only
  * 
  * DETAILS:
  * 
@@ -48,15 +51,24 @@ struct DSU {
     const u32 BINARY_BUCKET_SIZE = 32;
     const u64 RANK_MASK = 0xFFFFFFFF00000000ULL;
 
+    InstrumentedCounter cas_retry_count;
+
     DSU(u32 size, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS), dsu_size(size) {
         if (size == 0) {
             throw std::invalid_argument("DSU size cannot be zero");
         }
 
-        data = static_cast<atomic_u64*>(operator new[] (size * sizeof(atomic_u64)));;
+        data = static_cast<atomic_u64*>(operator new[] (size * sizeof(atomic_u64)));
+
+        /* No other thread sees data yet, so plain stores are enough */
+        static_assert(sizeof(atomic_u64) == sizeof(u64), "atomic_u64 should be a plain u64");
+        parallel_iota(reinterpret_cast<u64*>(data), size, u64(0), NUM_THREADS);
+    }
+
+    DSU(const DSU&) = delete;
 
-        #pragma omp parallel for shared(data) num_threads(NUM_THREADS)
-        for (u32 i = 0; i < size; ++i) data[i] = i;
+    ~DSU() {
+        delete[] data;
     }
 
     u32 size() const {
@@ -69,6 +81,10 @@ struct DSU {
         }
     }
 
+    u64 cas_retries() const {
+        return cas_retry_count.get();
+    }
+
     u32 get_parent(u32 id) const {
         return static_cast<u32>(data[id]);
     }
@@ -136,8 +152,11 @@ struct DSU {
      * Since it is a parallel structure, node roots may change during runtime
      * In order to account for this we do a while loop and repeat if
      * the smaller node was updated e.g. when CAS failed
+     *
+     * Returns true only for the call that actually linked the two sets,
+     * so concurrent callers can tell which of them merged the components
      */
-    void unite(u32 id1, u32 id2) {
+    bool unite(u32 id1, u32 id2) {
         check_out_of_range(id1);
         check_out_of_range(id2);
 
@@ -146,7 +165,7 @@ struct DSU {
             id2 = find_root(id2);
 
             /* Nodes are already in the same set */
-            if (id1 == id2) return;
+            if (id1 == id2) return false;
 
             u32 rank1 = get_rank(id1);
             u32 rank2 = get_rank(id2);
@@ -162,6 +181,7 @@ struct DSU {
 
             /* If CAS fails we need to repeat the same step once again */
             if (!data[id2].compare_exchange_strong(old_value, new_value)) {
+                cas_retry_count.add();
                 continue;
             }
 
@@ -173,7 +193,7 @@ struct DSU {
                 data[id1].compare_exchange_strong(old_value, new_value);
             }
 
-            break;
+            return true;
         }
     }
 };
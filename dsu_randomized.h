@@ -0,0 +1,189 @@
+#ifndef __DSU_RANDOMIZED_H
+#define __DSU_RANDOMIZED_H
+
+#include <atomic>
+#include <omp.h>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include "defs.h"
+#include "instrumentation.h"
+#include "parallel_array.h"
+#include "parallel_memory.h"
+#include "path_compression.h"
+
+/**
+ * INTERFACE:
+ *
+ * RandomizedDSU(uint32_t N,
+ *               PathCompression compression,
+ *               uint32_t seed,
+ *               uint32_t NUM_THREADS) - constructs a DSU of size N using NUM_THREADS
+ * uint32_t find_root(uint32_t id) - finds root node of id
+ * bool same_set(uint32_t id1, uint32_t id2) - checks if id1 and id2 are in the same set
+ * bool unite(uint32_t id1, uint32_t id2) - unites sets of id1 and id2, returns false if they were already united
+ * uint64_t cas_retries() - number of failed linking CAS in unite, counted with ENABLE_INSTRUMENTATION only
+ *
+ * DETAILS:
+ *
+ * Randomized linking from Jayanti and Tarjan, "A Randomized Concurrent Algorithm for Disjoint Set Union"
+ * Every node has a fixed random priority and a root is always hung onto the root
+ * with the higher priority, which gives trees of O(log N) expected height on any order of unites
+ *
+ * Priorities aren't stored, priority(id) is a bijective hash of id and seed,
+ * so they are all different and a link is a single 32 bit CAS on the parent,
+ * the whole structure takes 4 bytes per node instead of 8 in DSU
+ *
+ * find_root() compresses paths with CAS as well, see PathCompression,
+ * splitting is the default since it has the best bounds in the paper
+ */
+struct RandomizedDSU {
+    const u32 NUM_THREADS;
+    const PathCompression compression;
+    const u32 seed;
+
+    ParallelArray<atomic_u32> parent;
+
+    InstrumentedCounter cas_retry_count;
+
+    RandomizedDSU(u32 size,
+                  PathCompression compression = PATH_SPLITTING,
+                  u32 seed = std::random_device{}(),
+                  u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+                                                             compression(compression),
+                                                             seed(seed),
+                                                             parent(size) {
+        if (size == 0) {
+            throw std::invalid_argument("DSU size cannot be zero");
+        }
+
+        /* No other thread sees parent yet, so plain stores are enough */
+        static_assert(sizeof(atomic_u32) == sizeof(u32), "atomic_u32 should be a plain u32");
+        parallel_iota(reinterpret_cast<u32*>(parent.begin()), size, 0u, NUM_THREADS);
+    }
+
+    u32 size() const {
+        return parent.size();
+    }
+
+    void check_out_of_range(u32 id) const {
+        if (id >= size()) {
+            throw std::out_of_range("Node id out of range");
+        }
+    }
+
+    u64 cas_retries() const {
+        return cas_retry_count.get();
+    }
+
+    u32 get_parent(u32 id) const {
+        return parent[id];
+    }
+
+    /* Bijective 32 bit mixer, different ids always get different priorities */
+    u32 priority(u32 id) const {
+        u32 x = id ^ seed;
+        x ^= x >> 16;
+        x *= 0x7FEB352DU;
+        x ^= x >> 15;
+        x *= 0x846CA68BU;
+        x ^= x >> 16;
+        return x;
+    }
+
+    /**
+     * Parents only move up the tree, so replacing a parent with any ancestor is safe,
+     * CAS only makes sure we don't overwrite a link made by someone else in between
+     *
+     * With full compression root may get linked during the second pass and the path
+     * may go above it, priorities grow towards the root, so nodes with a priority
+     * higher than the root's aren't below it and the pass stops there
+     */
+    u32 find_root(u32 id) {
+        check_out_of_range(id);
+
+        if (compression == FULL_COMPRESSION) {
+            u32 root = id;
+            while (root != parent[root]) root = parent[root];
+
+            u32 root_priority = priority(root);
+            while (id != root) {
+                u32 value = parent[id];
+                if (value == root || priority(value) > root_priority) break;
+
+                u32 expected = value;
+                parent[id].compare_exchange_strong(expected, root);
+                id = value;
+            }
+
+            return root;
+        }
+
+        while (true) {
+            u32 value = parent[id];
+            if (value == id) return id;
+
+            u32 grandparent = parent[value];
+            if (value != grandparent) {
+                parent[id].compare_exchange_weak(value, grandparent);
+            }
+
+            id = (compression == PATH_HALVING ? grandparent : value);
+        }
+    }
+
+    /**
+     * Since it is a parallel structure, node roots may change during runtime
+     * In order to account for this we do a while loop and repeat if
+     * our current node is no longer the root of its set
+     */
+    bool same_set(u32 id1, u32 id2) {
+        check_out_of_range(id1);
+        check_out_of_range(id2);
+
+        while (true) {
+            id1 = find_root(id1);
+            id2 = find_root(id2);
+
+            if (id1 == id2) {
+                return true;
+            } else if (parent[id1] == id1) {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * The root with the lower priority is hung onto the other one,
+     * if it stopped being a root in the meantime CAS fails and we repeat
+     *
+     * Returns true only for the call that actually linked the two sets
+     */
+    bool unite(u32 id1, u32 id2) {
+        check_out_of_range(id1);
+        check_out_of_range(id2);
+
+        while (true) {
+            id1 = find_root(id1);
+            id2 = find_root(id2);
+
+            /* Nodes are already in the same set */
+            if (id1 == id2) return false;
+
+            if (priority(id1) > priority(id2)) {
+                std::swap(id1, id2);
+            }
+
+            u32 expected = id1;
+            if (!parent[id1].compare_exchange_strong(expected, id2)) {
+                cas_retry_count.add();
+                continue;
+            }
+
+            return true;
+        }
+    }
+};
+
+#endif
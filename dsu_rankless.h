@@ -6,33 +6,39 @@
 #include <stdexcept>
 
 #include "defs.h"
+#include "instrumentation.h"
 #include "parallel_array.h"
+#include "parallel_memory.h"
 
 /**
  * INTERFACE:
  * 
- * DSU(uint32_t N, uint32_t NUM_THREADS) - constructs a DSU of size N using NUM_THREADS
+ * RanklessDSU(uint32_t N, uint32_t NUM_THREADS) - constructs a DSU of size N using NUM_THREADS
  * uint32_t find_root(uint32_t id) - finds root node of id
  * bool same_set(uint32_t id1, uint32_t id2) - checks if id1 and id2 are in the same set
- * void unite(uint32_t id1, uint32_t id2) - unites sets of id1 and id2
+ * bool unite(uint32_t id1, uint32_t id2) - unites sets of id1 and id2, returns false if they were already united
+ * uint64_t cas_retries() - number of failed linking CAS in unite, counted with ENABLE_INSTRUMENTATION only
  * 
  * DETAILS:
  * 
  * This implementation relies on path compression only
  * and thus should achieve O(log N) time per query
  */
-struct DSU {
+struct RanklessDSU {
     const u32 NUM_THREADS;
 
     ParallelArray<atomic_u32> parent;
 
-    DSU(u32 size, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS), parent(size) {
+    InstrumentedCounter cas_retry_count;
+
+    RanklessDSU(u32 size, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS), parent(size) {
         if (size == 0) {
             throw std::invalid_argument("DSU size cannot be zero");
         }
 
-        #pragma omp parallel for shared(parent) num_threads(NUM_THREADS)
-        for (u32 i = 0; i < size; ++i) parent[i] = i;
+        /* No other thread sees parent yet, so plain stores are enough */
+        static_assert(sizeof(atomic_u32) == sizeof(u32), "atomic_u32 should be a plain u32");
+        parallel_iota(reinterpret_cast<u32*>(parent.begin()), size, 0u, NUM_THREADS);
     }
 
     u32 size() const {
@@ -45,6 +51,10 @@ struct DSU {
         }
     }
 
+    u64 cas_retries() const {
+        return cas_retry_count.get();
+    }
+
     u32 get_parent(u32 id) const {
         return parent[id];
     }
@@ -105,8 +115,10 @@ struct DSU {
      * Since it is a parallel structure, node roots may change during runtime
      * In order to account for this we do a while loop and repeat if
      * the smaller node was updated e.g. when CAS failed
+     *
+     * Returns true only for the call that actually linked the two sets
      */
-    void unite(u32 id1, u32 id2) {
+    bool unite(u32 id1, u32 id2) {
         check_out_of_range(id1);
         check_out_of_range(id2);
 
@@ -115,7 +127,7 @@ struct DSU {
             id2 = find_root(id2);
 
             /* Nodes are already in the same set */
-            if (id1 == id2) return;
+            if (id1 == id2) return false;
 
             if (id1 > id2) {
                 std::swap(id1, id2);
@@ -123,10 +135,11 @@ struct DSU {
 
             /* If CAS fails we need to repeat the same step once again */
             if (!parent[id2].compare_exchange_strong(id2, id1)) {
+                cas_retry_count.add();
                 continue;
             }
 
-            break;
+            return true;
         }
     }
 };
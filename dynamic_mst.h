@@ -0,0 +1,492 @@
+#ifndef __DYNAMIC_MST_H
+#define __DYNAMIC_MST_H
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <stdexcept>
+#include <vector>
+
+#include "boruvka.h"
+#include "defs.h"
+#include "dsu.h"
+#include "graph.h"
+#include "parallel_array.h"
+#include "prefix_sum.h"
+
+/**
+ * INTERFACE:
+ *
+ * DynamicMST(GraphView graph, uint32_t NUM_THREADS) - builds a minimum spanning forest of graph with BoruvkaMST
+ * uint32_t num_edges() - number of undirected edges, edge ids are in [0, num_edges())
+ * const Edge& edge(uint32_t id) - undirected edge with given id, edge.from < edge.to
+ * uint32_t find_edge(uint32_t from, uint32_t to) - id of some edge between from and to or NO_EDGE
+ * bool is_alive(uint32_t id) - checks if edge was not deleted
+ * bool is_tree_edge(uint32_t id) - checks if edge is in the current forest
+ * uint32_t component(uint32_t node) - representative node of the tree containing node
+ * uint32_t forest_size() - number of edges in the current forest
+ * uint64_t forest_weight() - total weight of the current forest
+ * ParallelArray<Edge> forest() - edges of the current forest
+ * void delete_edges(std::vector<uint32_t> ids) - deletes a batch of edges and repairs the forest
+ *
+ * DETAILS:
+ *
+ * Graph is expected to be in the same format load_graph() and generate_graph() produce:
+ * nodes are 0..N-1, every edge is stored in both directions and edges are sorted
+ *
+ * Deleting a non-tree edge only marks it as dead
+ *
+ * Deleting tree edges splits their trees into fragments, only the nodes of these
+ * trees are touched:
+ * 1. Each endpoint of a deleted tree edge starts a DFS over the remaining tree edges,
+ *    DFS runs in parallel and claims nodes with CAS, when two searches meet
+ *    their seeds are joined in a DSU, so each DSU set is exactly one fragment
+ * 2. Alive non-tree edges between different fragments are collected as candidates
+ * 3. Fragments are joined with Boruvka rounds over the candidates, shortest edges
+ *    are found with the same packed atomic minimum that BoruvkaMST uses
+ *
+ * Since the forest stays minimal after each batch, every tree that wasn't touched
+ * by the batch is still a part of the new minimum spanning forest
+ */
+struct DynamicMST {
+    static constexpr u32 NO_EDGE = std::numeric_limits<u32>::max();
+    static constexpr u32 NO_FRAGMENT = std::numeric_limits<u32>::max();
+
+    static constexpr u8 DEAD_EDGE = 0;
+    static constexpr u8 NON_TREE_EDGE = 1;
+    static constexpr u8 TREE_EDGE = 2;
+
+    const u32 NUM_THREADS;
+
+    u32 num_nodes;
+
+    ParallelArray<Edge> edges;
+    ParallelArray<u8> state;
+
+    /* incidence[incidence_offset[u]..incidence_offset[u + 1]) are ids of edges adjacent to u */
+    ParallelArray<u32> incidence_offset;
+    ParallelArray<u32> incidence;
+
+    ParallelArray<u32> tree_id;
+    ParallelArray<atomic_u32> fragment;
+
+    u32 current_forest_size;
+    u64 current_forest_weight;
+
+    DynamicMST(GraphView graph, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+                                                                           num_nodes(graph.num_nodes()),
+                                                                           edges(0),
+                                                                           state(0),
+                                                                           incidence_offset(graph.num_nodes() + 1),
+                                                                           incidence(0),
+                                                                           tree_id(graph.num_nodes()),
+                                                                           fragment(graph.num_nodes()) {
+        if (num_nodes == 0) {
+            throw std::invalid_argument("Graph should have at least one node");
+        }
+
+        u32 num_directed = graph.num_edges();
+
+        /* Directed edge i gets undirected id undirected[i], self loops are dropped */
+        ParallelArray<u32> undirected(num_directed);
+        ParallelArray<u32> is_canonical(num_directed);
+        ParallelArray<u32> is_proper(num_directed);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < num_directed; ++i) {
+            is_canonical[i] = (graph.edges[i].from < graph.edges[i].to);
+            is_proper[i] = (graph.edges[i].from != graph.edges[i].to);
+        }
+
+        if (num_directed != 0) {
+            PrefixSum canonical_prefix(num_directed, is_canonical, NUM_THREADS);
+            PrefixSum proper_prefix(num_directed, is_proper, NUM_THREADS);
+
+            ParallelArray<Edge> new_edges(canonical_prefix[num_directed - 1]);
+            ParallelArray<u32> new_incidence(proper_prefix[num_directed - 1]);
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < num_directed; ++i) {
+                if (is_canonical[i]) {
+                    undirected[i] = canonical_prefix[i] - 1;
+                    new_edges[undirected[i]] = graph.edges[i];
+                }
+            }
+
+            /*
+             * Reverse edge of the k-th copy of (u, v, w) is the k-th copy of (v, u, w),
+             * this keeps multiple edges apart
+             */
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < num_directed; ++i) {
+                const Edge& e = graph.edges[i];
+                if (e.from > e.to) {
+                    u32 copy = i - (std::lower_bound(graph.edges.begin(), graph.edges.end(), e) - graph.edges.begin());
+                    u32 twin = std::lower_bound(graph.edges.begin(),
+                                                graph.edges.end(),
+                                                Edge(e.to, e.from, e.weight)) - graph.edges.begin() + copy;
+                    undirected[i] = canonical_prefix[twin] - 1;
+                }
+            }
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < num_directed; ++i) {
+                if (is_proper[i]) {
+                    new_incidence[proper_prefix[i] - 1] = undirected[i];
+                }
+            }
+
+            /* Directed edges are sorted by from, so offsets are found with a binary search */
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 u = 0; u <= num_nodes; ++u) {
+                u32 first = std::lower_bound(graph.edges.begin(),
+                                             graph.edges.end(),
+                                             Edge(u, 0, 0)) - graph.edges.begin();
+                incidence_offset[u] = (first == 0 ? 0 : proper_prefix[first - 1]);
+            }
+
+            edges.swap(new_edges);
+            incidence.swap(new_incidence);
+        } else {
+            for (u32 u = 0; u <= num_nodes; ++u) {
+                incidence_offset[u] = 0;
+            }
+        }
+
+        ParallelArray<u8> new_state(edges.size());
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < edges.size(); ++i) {
+            new_state[i] = NON_TREE_EDGE;
+        }
+        state.swap(new_state);
+
+        BoruvkaMST boruvka;
+        ParallelArray<u32> mst_ids = boruvka.calculate_mst_ids(graph, NUM_THREADS);
+        DSU node_sets(num_nodes, NUM_THREADS);
+
+        u64 mst_weight = 0;
+
+        #pragma omp parallel for num_threads(NUM_THREADS) reduction(+:mst_weight)
+        for (u32 i = 0; i < mst_ids.size(); ++i) {
+            u32 id = undirected[mst_ids[i]];
+            state[id] = TREE_EDGE;
+            node_sets.unite(edges[id].from, edges[id].to);
+            mst_weight += edges[id].weight;
+        }
+
+        current_forest_size = mst_ids.size();
+        current_forest_weight = mst_weight;
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 u = 0; u < num_nodes; ++u) {
+            tree_id[u] = node_sets.find_root(u);
+            fragment[u] = NO_FRAGMENT;
+        }
+    }
+
+    u32 num_edges() const {
+        return edges.size();
+    }
+
+    void check_out_of_range(u32 id) const {
+        if (id >= num_edges()) {
+            throw std::out_of_range("Edge id out of range");
+        }
+    }
+
+    const Edge& edge(u32 id) const {
+        check_out_of_range(id);
+        return edges[id];
+    }
+
+    u32 find_edge(u32 from, u32 to) const {
+        if (from > to) std::swap(from, to);
+
+        const Edge* it = std::lower_bound(edges.begin(), edges.end(), Edge(from, to, 0));
+        if (it == edges.end() || it->from != from || it->to != to) {
+            return NO_EDGE;
+        }
+        return it - edges.begin();
+    }
+
+    bool is_alive(u32 id) const {
+        check_out_of_range(id);
+        return state[id] != DEAD_EDGE;
+    }
+
+    bool is_tree_edge(u32 id) const {
+        check_out_of_range(id);
+        return state[id] == TREE_EDGE;
+    }
+
+    u32 component(u32 node) const {
+        return tree_id[node];
+    }
+
+    u32 forest_size() const {
+        return current_forest_size;
+    }
+
+    u64 forest_weight() const {
+        return current_forest_weight;
+    }
+
+    ParallelArray<Edge> forest() {
+        ParallelArray<u32> in_forest(edges.size());
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < edges.size(); ++i) {
+            in_forest[i] = (state[i] == TREE_EDGE);
+        }
+
+        ParallelArray<Edge> result(current_forest_size);
+        if (current_forest_size != 0) {
+            PrefixSum in_forest_prefix(edges.size(), in_forest, NUM_THREADS);
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < edges.size(); ++i) {
+                if (in_forest[i]) {
+                    result[in_forest_prefix[i] - 1] = edges[i];
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * Deletes given edges, ids that were already deleted or repeat are ignored
+     * Costs O(batch size) if no tree edge is deleted, otherwise the work
+     * is proportional to the total size and degree of the affected trees
+     */
+    void delete_edges(std::vector<u32> ids) {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        for (u32 id : ids) {
+            check_out_of_range(id);
+        }
+
+        std::vector<u32> deleted_tree_edges;
+        for (u32 id : ids) {
+            if (state[id] == TREE_EDGE) {
+                deleted_tree_edges.push_back(id);
+                --current_forest_size;
+                current_forest_weight -= edges[id].weight;
+            }
+            state[id] = DEAD_EDGE;
+        }
+
+        if (!deleted_tree_edges.empty()) {
+            reconnect(deleted_tree_edges);
+        }
+    }
+
+    u32 other_end(u32 id, u32 node) const {
+        return edges[id].from == node ? edges[id].to : edges[id].from;
+    }
+
+    /**
+     * Searches for replacement edges among the trees that lost edges
+     */
+    void reconnect(const std::vector<u32>& deleted_tree_edges) {
+        u32 num_seeds = 2 * deleted_tree_edges.size();
+        ParallelArray<u32> seeds(num_seeds);
+        for (u32 i = 0; i < deleted_tree_edges.size(); ++i) {
+            seeds[2 * i] = edges[deleted_tree_edges[i]].from;
+            seeds[2 * i + 1] = edges[deleted_tree_edges[i]].to;
+        }
+
+        /* Labeling fragments of affected trees */
+        DSU seed_sets(num_seeds, NUM_THREADS);
+        std::vector<std::vector<u32>> visited(NUM_THREADS);
+
+        #pragma omp parallel num_threads(NUM_THREADS)
+        {
+            std::vector<u32>& local_visited = visited[omp_get_thread_num()];
+            std::vector<u32> stack;
+
+            #pragma omp for schedule(dynamic, 1)
+            for (u32 s = 0; s < num_seeds; ++s) {
+                u32 owner = NO_FRAGMENT;
+                if (!fragment[seeds[s]].compare_exchange_strong(owner, s)) {
+                    seed_sets.unite(s, owner);
+                    continue;
+                }
+
+                local_visited.push_back(seeds[s]);
+                stack.push_back(seeds[s]);
+
+                while (!stack.empty()) {
+                    u32 u = stack.back();
+                    stack.pop_back();
+
+                    for (u32 j = incidence_offset[u]; j < incidence_offset[u + 1]; ++j) {
+                        u32 id = incidence[j];
+                        if (state[id] != TREE_EDGE) continue;
+
+                        u32 v = other_end(id, u);
+                        owner = NO_FRAGMENT;
+                        if (fragment[v].compare_exchange_strong(owner, s)) {
+                            local_visited.push_back(v);
+                            stack.push_back(v);
+                        } else if (owner != s) {
+                            seed_sets.unite(s, owner);
+                        }
+                    }
+                }
+            }
+        }
+
+        ParallelArray<u32> affected_offset(NUM_THREADS + 1);
+        affected_offset[0] = 0;
+        for (u32 t = 0; t < NUM_THREADS; ++t) {
+            affected_offset[t + 1] = affected_offset[t] + visited[t].size();
+        }
+
+        ParallelArray<u32> affected(affected_offset[NUM_THREADS]);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 t = 0; t < NUM_THREADS; ++t) {
+            std::copy(visited[t].begin(), visited[t].end(), affected.begin() + affected_offset[t]);
+        }
+
+        /* Numbering fragments 0..K-1 */
+        ParallelArray<u32> is_fragment_root(num_seeds);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 s = 0; s < num_seeds; ++s) {
+            is_fragment_root[s] = (seed_sets.find_root(s) == s);
+        }
+
+        PrefixSum fragment_root_prefix(num_seeds, is_fragment_root, NUM_THREADS);
+        u32 num_fragments = fragment_root_prefix[num_seeds - 1];
+
+        ParallelArray<u32> fragment_node(num_fragments);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 s = 0; s < num_seeds; ++s) {
+            if (is_fragment_root[s]) {
+                fragment_node[fragment_root_prefix[s] - 1] = seeds[s];
+            }
+        }
+
+        ParallelArray<u32> node_fragment(affected.size());
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < affected.size(); ++i) {
+            node_fragment[i] = fragment_root_prefix[seed_sets.find_root(fragment[affected[i]])] - 1;
+        }
+
+        /* Collecting alive non-tree edges between different fragments, each edge is taken from its smaller end */
+        std::vector<std::vector<ContractedEdge>> local_candidates(NUM_THREADS);
+
+        #pragma omp parallel num_threads(NUM_THREADS)
+        {
+            std::vector<ContractedEdge>& candidates = local_candidates[omp_get_thread_num()];
+
+            #pragma omp for schedule(dynamic, 64)
+            for (u32 i = 0; i < affected.size(); ++i) {
+                u32 u = affected[i];
+
+                for (u32 j = incidence_offset[u]; j < incidence_offset[u + 1]; ++j) {
+                    u32 id = incidence[j];
+                    const Edge& e = edges[id];
+                    if (state[id] != NON_TREE_EDGE || e.from != u) continue;
+
+                    u32 fragment_v = fragment[e.to];
+                    if (fragment_v == NO_FRAGMENT) continue;
+
+                    u32 to = fragment_root_prefix[seed_sets.find_root(fragment_v)] - 1;
+                    if (to != node_fragment[i]) {
+                        candidates.push_back(ContractedEdge(node_fragment[i], to, e.weight, id));
+                    }
+                }
+            }
+        }
+
+        u32 num_candidates = 0;
+        for (const auto& candidates : local_candidates) {
+            num_candidates += candidates.size();
+        }
+
+        ParallelArray<ContractedEdge> candidates(num_candidates);
+        for (u32 t = 0, offset = 0; t < NUM_THREADS; ++t) {
+            std::copy(local_candidates[t].begin(), local_candidates[t].end(), candidates.begin() + offset);
+            offset += local_candidates[t].size();
+        }
+
+        /* Boruvka rounds over fragments */
+        BoruvkaMST boruvka;
+        DSU fragment_sets(num_fragments, NUM_THREADS);
+        ParallelArray<atomic_u64> shortest_edges(num_fragments);
+        ParallelArray<u32> partner(num_fragments);
+        u32 added_edges = 0;
+        u64 added_weight = 0;
+
+        while (candidates.size() != 0) {
+            #pragma omp parallel num_threads(NUM_THREADS)
+            {
+                #pragma omp for
+                for (u32 f = 0; f < num_fragments; ++f) {
+                    shortest_edges[f] = boruvka.EMPTY_EDGE;
+                }
+
+                #pragma omp for
+                for (u32 i = 0; i < candidates.size(); ++i) {
+                    u32 from = fragment_sets.find_root(candidates[i].from);
+                    u32 to = fragment_sets.find_root(candidates[i].to);
+                    u64 encoded_edge = boruvka.encode_edge(i, candidates[i].weight);
+
+                    boruvka.update_shortest_edge(shortest_edges[from], encoded_edge);
+                    boruvka.update_shortest_edge(shortest_edges[to], encoded_edge);
+                }
+
+                /* Partners are found before any unite() so that roots don't change meanwhile */
+                #pragma omp for
+                for (u32 f = 0; f < num_fragments; ++f) {
+                    if (shortest_edges[f] != boruvka.EMPTY_EDGE) {
+                        const ContractedEdge& e = candidates[boruvka.get_id(shortest_edges[f])];
+                        u32 from = fragment_sets.find_root(e.from);
+                        partner[f] = (from == f ? fragment_sets.find_root(e.to) : from);
+                    }
+                }
+
+                #pragma omp for reduction(+:added_edges, added_weight)
+                for (u32 f = 0; f < num_fragments; ++f) {
+                    if (shortest_edges[f] != boruvka.EMPTY_EDGE && fragment_sets.unite(f, partner[f])) {
+                        u32 id = candidates[boruvka.get_id(shortest_edges[f])].id;
+                        state[id] = TREE_EDGE;
+                        ++added_edges;
+                        added_weight += edges[id].weight;
+                    }
+                }
+            }
+
+            ParallelArray<u32> candidate_remains(candidates.size());
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < candidates.size(); ++i) {
+                candidate_remains[i] = !fragment_sets.same_set(candidates[i].from, candidates[i].to);
+            }
+
+            PrefixSum candidate_remains_prefix(candidates.size(), candidate_remains, NUM_THREADS);
+            ParallelArray<ContractedEdge> new_candidates(candidate_remains_prefix[candidates.size() - 1]);
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < candidates.size(); ++i) {
+                if (candidate_remains[i]) {
+                    new_candidates[candidate_remains_prefix[i] - 1] = candidates[i];
+                }
+            }
+
+            candidates.swap(new_candidates);
+        }
+
+        current_forest_size += added_edges;
+        current_forest_weight += added_weight;
+
+        /* Relabeling trees of affected nodes */
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < affected.size(); ++i) {
+            tree_id[affected[i]] = fragment_node[fragment_sets.find_root(node_fragment[i])];
+            fragment[affected[i]] = NO_FRAGMENT;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,272 @@
+#ifndef __EDGE_KERNELS_H
+#define __EDGE_KERNELS_H
+
+#include <atomic>
+#include <type_traits>
+
+#include "defs.h"
+#include "simd.h"
+
+/**
+ * Kernels of the hot Boruvka phases over structure of arrays edges
+ *
+ * min_edge_kernel(level, from, weight, begin, end, shortest_edges, run_start) - for every node u that appears
+ *     in from[begin, end) lowers shortest_edges[u] to the lightest of its edges there,
+ *     edges are encoded as (weight << 32) | index, so ties go to the smaller index
+ * relabel_edges_kernel(level, from, to, component, remains, begin, end) - replaces ends of edges
+ *     in [begin, end) with their components, remains[i] is 1 if the edge still connects two components
+ *
+ * DETAILS:
+ *
+ * Contracted edges are sorted by from, so edges of a node form a run, min_edge_kernel
+ * finds the end of a run and its minimal weight with vector compares and does one
+ * atomic update per run instead of one per edge, it is correct on any order, just slower
+ *
+ * relabel_edges_kernel is a gather of component by from and to and a vector compare,
+ * gathers take signed 32 bit indices, so node ids should stay below MAX_GATHER_NODES,
+ * graphs with more nodes should use the scalar kernel, see relabel_level()
+ *
+ * Every kernel has a scalar, an AVX2 and an AVX-512 version with the same results,
+ * the level should come from detect_simd_level() or be lower
+ *
+ * Positions are of type P: u32, or u64 for arrays of more than 2^32 edges
+ * A 64 bit position doesn't fit next to the weight, so the index in the encoding is then
+ * the offset of the edge from run_start[u], the first edge of its node,
+ * so edges of a node should form one run of less than 2^32 edges, as they do once sorted by from
+ */
+
+/* Node ids above this don't fit in the signed indices of gathers */
+const u64 MAX_GATHER_NODES = 1ULL << 31;
+
+/* Level of relabel_edges_kernel for a graph with num_nodes nodes */
+inline SimdLevel relabel_level(SimdLevel level, u64 num_nodes) {
+    return num_nodes <= MAX_GATHER_NODES ? level : SCALAR_LEVEL;
+}
+
+/* The same encoding as BoruvkaMST::encode_edge() */
+inline u64 encode_min_edge(u32 index, u32 weight) {
+    return (static_cast<u64>(weight) << 32) | index;
+}
+
+/* Index of edge i of node u in the encoding, run_start is used for 64 bit positions only */
+template<typename P>
+inline u32 min_edge_index(P i, u32 u, const P* run_start) {
+    if constexpr (std::is_same_v<P, u32>) {
+        return i;
+    } else {
+        return static_cast<u32>(i - run_start[u]);
+    }
+}
+
+/* Lowers shortest_edge to encoded_edge, this loop is wait-free */
+inline void update_min_edge(atomic_u64& shortest_edge, u64 encoded_edge) {
+    u64 old = shortest_edge.load(std::memory_order_relaxed);
+    while (old > encoded_edge) {
+        if (shortest_edge.compare_exchange_weak(old, encoded_edge)) {
+            break;
+        }
+    }
+}
+
+template<typename P>
+void min_edge_scalar(const u32* from, const u32* weight, P begin, P end, atomic_u64* shortest_edges,
+                     const P* run_start) {
+    P i = begin;
+    while (i < end) {
+        u32 u = from[i];
+        u32 best_weight = weight[i];
+        P best_index = i;
+
+        for (++i; i < end && from[i] == u; ++i) {
+            if (weight[i] < best_weight) {
+                best_weight = weight[i];
+                best_index = i;
+            }
+        }
+
+        update_min_edge(shortest_edges[u], encode_min_edge(min_edge_index(best_index, u, run_start), best_weight));
+    }
+}
+
+template<typename P>
+void relabel_edges_scalar(u32* from, u32* to, const u32* component, u32* remains, P begin, P end) {
+    for (P i = begin; i < end; ++i) {
+        u32 new_from = component[from[i]];
+        u32 new_to = component[to[i]];
+        from[i] = new_from;
+        to[i] = new_to;
+        remains[i] = (new_from != new_to);
+    }
+}
+
+#if HAS_X86_SIMD
+
+__attribute__((target("avx2")))
+inline u32 horizontal_min_avx2(__m256i x) {
+    __m128i m = _mm_min_epu32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_min_epu32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(m);
+}
+
+template<typename P>
+__attribute__((target("avx2")))
+void min_edge_avx2(const u32* from, const u32* weight, P begin, P end, atomic_u64* shortest_edges,
+                   const P* run_start) {
+    const u32 WIDTH = 8;
+
+    P i = begin;
+    while (i < end) {
+        u32 u = from[i];
+        P run_begin = i;
+        __m256i node = _mm256_set1_epi32(u);
+        __m256i min_weight = _mm256_set1_epi32(-1);
+
+        /* Whole vectors inside the run */
+        while (i + WIDTH <= end) {
+            __m256i same = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i)), node);
+            if (_mm256_movemask_ps(_mm256_castsi256_ps(same)) != 0xFF) break;
+
+            min_weight = _mm256_min_epu32(min_weight, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weight + i)));
+            i += WIDTH;
+        }
+
+        u32 best_weight = horizontal_min_avx2(min_weight);
+        for (; i < end && from[i] == u; ++i) {
+            if (weight[i] < best_weight) best_weight = weight[i];
+        }
+
+        /* The first edge of the run with the minimal weight */
+        P j = run_begin;
+        __m256i best = _mm256_set1_epi32(best_weight);
+        while (j + WIDTH <= i) {
+            __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(weight + j)), best);
+            u32 mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+            if (mask != 0) {
+                j += __builtin_ctz(mask);
+                break;
+            }
+            j += WIDTH;
+        }
+        while (weight[j] != best_weight) ++j;
+
+        update_min_edge(shortest_edges[u], encode_min_edge(min_edge_index(j, u, run_start), best_weight));
+    }
+}
+
+template<typename P>
+__attribute__((target("avx2")))
+void relabel_edges_avx2(u32* from, u32* to, const u32* component, u32* remains, P begin, P end) {
+    const u32 WIDTH = 8;
+    const int* table = reinterpret_cast<const int*>(component);
+    __m256i one = _mm256_set1_epi32(1);
+
+    P i = begin;
+    for (; i + WIDTH <= end; i += WIDTH) {
+        __m256i new_from = _mm256_i32gather_epi32(table, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i)), 4);
+        __m256i new_to = _mm256_i32gather_epi32(table, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(to + i)), 4);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(from + i), new_from);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i), new_to);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(remains + i),
+                            _mm256_andnot_si256(_mm256_cmpeq_epi32(new_from, new_to), one));
+    }
+
+    relabel_edges_scalar(from, to, component, remains, i, end);
+}
+
+template<typename P>
+__attribute__((target("avx512f")))
+void min_edge_avx512(const u32* from, const u32* weight, P begin, P end, atomic_u64* shortest_edges,
+                     const P* run_start) {
+    const u32 WIDTH = 16;
+
+    P i = begin;
+    while (i < end) {
+        u32 u = from[i];
+        P run_begin = i;
+        __m512i node = _mm512_set1_epi32(u);
+        __m512i min_weight = _mm512_set1_epi32(-1);
+
+        /* Whole vectors inside the run */
+        while (i + WIDTH <= end) {
+            if (_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(from + i), node) != 0xFFFF) break;
+
+            min_weight = _mm512_min_epu32(min_weight, _mm512_loadu_si512(weight + i));
+            i += WIDTH;
+        }
+
+        u32 best_weight = _mm512_reduce_min_epu32(min_weight);
+        for (; i < end && from[i] == u; ++i) {
+            if (weight[i] < best_weight) best_weight = weight[i];
+        }
+
+        /* The first edge of the run with the minimal weight */
+        P j = run_begin;
+        __m512i best = _mm512_set1_epi32(best_weight);
+        while (j + WIDTH <= i) {
+            u32 mask = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(weight + j), best);
+            if (mask != 0) {
+                j += __builtin_ctz(mask);
+                break;
+            }
+            j += WIDTH;
+        }
+        while (weight[j] != best_weight) ++j;
+
+        update_min_edge(shortest_edges[u], encode_min_edge(min_edge_index(j, u, run_start), best_weight));
+    }
+}
+
+template<typename P>
+__attribute__((target("avx512f")))
+void relabel_edges_avx512(u32* from, u32* to, const u32* component, u32* remains, P begin, P end) {
+    const u32 WIDTH = 16;
+    __m512i one = _mm512_set1_epi32(1);
+
+    P i = begin;
+    for (; i + WIDTH <= end; i += WIDTH) {
+        __m512i new_from = _mm512_i32gather_epi32(_mm512_loadu_si512(from + i), component, 4);
+        __m512i new_to = _mm512_i32gather_epi32(_mm512_loadu_si512(to + i), component, 4);
+
+        _mm512_storeu_si512(from + i, new_from);
+        _mm512_storeu_si512(to + i, new_to);
+        _mm512_storeu_si512(remains + i, _mm512_maskz_mov_epi32(_mm512_cmpneq_epi32_mask(new_from, new_to), one));
+    }
+
+    relabel_edges_scalar(from, to, component, remains, i, end);
+}
+
+#endif
+
+template<typename P>
+void min_edge_kernel(SimdLevel level,
+                     const u32* from,
+                     const u32* weight,
+                     P begin,
+                     P end,
+                     atomic_u64* shortest_edges,
+                     const P* run_start = nullptr) {
+#if HAS_X86_SIMD
+    if (level == AVX512_LEVEL) return min_edge_avx512(from, weight, begin, end, shortest_edges, run_start);
+    if (level == AVX2_LEVEL) return min_edge_avx2(from, weight, begin, end, shortest_edges, run_start);
+#endif
+    min_edge_scalar(from, weight, begin, end, shortest_edges, run_start);
+}
+
+template<typename P>
+void relabel_edges_kernel(SimdLevel level,
+                          u32* from,
+                          u32* to,
+                          const u32* component,
+                          u32* remains,
+                          P begin,
+                          P end) {
+#if HAS_X86_SIMD
+    if (level == AVX512_LEVEL) return relabel_edges_avx512(from, to, component, remains, begin, end);
+    if (level == AVX2_LEVEL) return relabel_edges_avx2(from, to, component, remains, begin, end);
+#endif
+    relabel_edges_scalar(from, to, component, remains, begin, end);
+}
+
+#endif
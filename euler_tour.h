@@ -0,0 +1,305 @@
+#ifndef __EULER_TOUR_H
+#define __EULER_TOUR_H
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "defs.h"
+#include "dsu.h"
+#include "graph.h"
+#include "list_ranking.h"
+#include "parallel_algorithms.h"
+#include "parallel_array.h"
+#include "parallel_memory.h"
+#include "prefix_sum.h"
+
+/**
+ * INTERFACE:
+ *
+ * RootedForest(uint32_t num_nodes,
+ *              const ParallelArray<BasicEdge<W, I>>& edges,
+ *              uint32_t NUM_THREADS) - roots every tree of a forest at its smallest node,
+ *     edges are undirected, each given once in any direction, e.g. the output of BoruvkaMST
+ * uint32_t num_nodes() - number of nodes
+ * bool is_root(uint32_t u) - checks if u is the root of its tree
+ * parent[u] - parent of u, NO_PARENT for roots
+ * depth[u] - number of edges between u and its root
+ * preorder[u] - position of u in a preorder of the whole forest, trees go by their roots,
+ *     so the subtree of u is exactly the nodes in [preorder[u], preorder[u] + subtree_size[u])
+ * subtree_size[u] - number of nodes in the subtree of u, u included
+ *
+ * RootedForest root_forest_sequential(num_nodes, edges) - the same forest from a DFS on one thread, the baseline,
+ *     parents, depths and sizes are equal, preorders may visit children in another order
+ *
+ * DETAILS:
+ *
+ * Euler tour with O(n) work and polylogarithmic depth:
+ * 1. Edges are united in a DSU, an edge that closes a cycle throws std::invalid_argument,
+ *    the smallest node of every set is its root
+ * 2. Every edge becomes two arcs, arcs are sorted by (from, to), so arcs of a node form a run,
+ *    the twin of an arc is found with a binary search in the run of its head
+ * 3. The arc after (u, v) on the tour is the arc after (v, u) in the run of v, cyclically,
+ *    the tour of a tree is cut where it returns to its root, so children of a node are visited
+ *    by their ids, starting after its parent and wrapping around
+ * 4. Every root gets a virtual arc that enters it, tours are chained through them in the order of roots,
+ *    so the whole forest is one list, it is ranked with rank_list()
+ * 5. An arc goes down if it comes before its twin, prefix sums of down arcs over the tour give
+ *    preorder and subtree sizes, prefix sums of +1 for down and -1 for up arcs give depths
+ *
+ * -1 is stored as 2^32 - 1, sums wrap around, and depths are below 2^32, so u32 prefix sums are exact
+ *
+ * Arcs are u32, so 2 * (number of edges) + num_nodes should be below 2^32, otherwise std::invalid_argument is thrown
+ */
+struct RootedForest {
+    static constexpr u32 NO_PARENT = std::numeric_limits<u32>::max();
+
+    const u32 NUM_THREADS;
+
+    ParallelArray<u32> parent;
+    ParallelArray<u32> depth;
+    ParallelArray<u32> preorder;
+    ParallelArray<u32> subtree_size;
+
+    RootedForest(u32 num_nodes, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+                                                                         parent(num_nodes, NUM_THREADS),
+                                                                         depth(num_nodes, NUM_THREADS),
+                                                                         preorder(num_nodes, NUM_THREADS),
+                                                                         subtree_size(num_nodes, NUM_THREADS) {}
+
+    template<typename W, typename I>
+    RootedForest(u32 num_nodes,
+                 const ParallelArray<BasicEdge<W, I>>& edges,
+                 u32 NUM_THREADS = omp_get_max_threads()) : RootedForest(num_nodes, NUM_THREADS) {
+        if (num_nodes == 0) {
+            if (edges.size() != 0) throw std::out_of_range("Node id out of range");
+            return;
+        }
+        if (2 * edges.size() + num_nodes >= LIST_END) {
+            throw std::invalid_argument("Forest has too many arcs for 32 bit arc ids");
+        }
+
+        u32 num_edges = edges.size();
+        u32 num_arcs = 2 * num_edges;
+
+        ParallelArray<u32> root_flag = find_roots(num_nodes, edges);
+
+        ParallelArray<u64> arcs(num_arcs, NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < num_edges; ++i) {
+            arcs[2 * i] = pack_arc(edges[i].from, edges[i].to);
+            arcs[2 * i + 1] = pack_arc(edges[i].to, edges[i].from);
+        }
+        parallel_sort(arcs.begin(), arcs.end());
+
+        /* Arcs of u are arcs[first_arc[u], end_arc[u]), nodes without arcs keep an empty run */
+        ParallelArray<u32> first_arc(num_nodes, NUM_THREADS);
+        ParallelArray<u32> end_arc(num_nodes, NUM_THREADS);
+        parallel_zero(first_arc.begin(), num_nodes, NUM_THREADS);
+        parallel_zero(end_arc.begin(), num_nodes, NUM_THREADS);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 a = 0; a < num_arcs; ++a) {
+            u32 u = arc_from(arcs[a]);
+            if (a == 0 || arc_from(arcs[a - 1]) != u) first_arc[u] = a;
+            if (a + 1 == num_arcs || arc_from(arcs[a + 1]) != u) end_arc[u] = a + 1;
+        }
+
+        PrefixSum root_prefix(num_nodes, root_flag, NUM_THREADS);
+        u32 num_roots = root_prefix[num_nodes - 1];
+        u32 list_size = num_arcs + num_roots;
+
+        /* Virtual arc of the root with index x is num_arcs + x, the tour after the last root ends the list */
+        auto virtual_arc = [&](u32 x) {
+            return x < num_roots ? num_arcs + x : LIST_END;
+        };
+
+        ParallelArray<u32> twin(num_arcs, NUM_THREADS);
+        ParallelArray<u32> rank(0, NUM_THREADS);
+        {
+            ParallelArray<u32> next(list_size, NUM_THREADS);
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 a = 0; a < num_arcs; ++a) {
+                u32 u = arc_from(arcs[a]);
+                u32 v = arc_to(arcs[a]);
+                u32 t = std::lower_bound(arcs.begin() + first_arc[v], arcs.begin() + end_arc[v], pack_arc(v, u)) -
+                        arcs.begin();
+                twin[a] = t;
+
+                if (t + 1 < end_arc[v]) {
+                    next[a] = t + 1;
+                } else if (root_flag[v]) {
+                    next[a] = virtual_arc(root_prefix[v]);
+                } else {
+                    next[a] = first_arc[v];
+                }
+            }
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 u = 0; u < num_nodes; ++u) {
+                if (root_flag[u]) {
+                    u32 x = root_prefix[u] - 1;
+                    next[num_arcs + x] = (first_arc[u] < end_arc[u] ? first_arc[u] : virtual_arc(x + 1));
+                }
+            }
+
+            /* Node 0 is the smallest node of its tree, so its virtual arc starts the list */
+            ParallelArray<u32> tour_rank = rank_list(next, virtual_arc(0), nullptr, NUM_THREADS);
+            rank.swap(tour_rank);
+        }
+
+        ParallelArray<u32> is_down(list_size, NUM_THREADS);
+        ParallelArray<u32> depth_step(list_size, NUM_THREADS);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 a = 0; a < list_size; ++a) {
+            bool down = (a >= num_arcs || rank[a] < rank[twin[a]]);
+            is_down[rank[a]] = down;
+            depth_step[rank[a]] = (a >= num_arcs ? 0 : (down ? 1 : std::numeric_limits<u32>::max()));
+        }
+
+        PrefixSum down_prefix(list_size, is_down, NUM_THREADS);
+        PrefixSum depth_prefix(list_size, depth_step, NUM_THREADS);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 a = 0; a < num_arcs; ++a) {
+            u32 t = rank[a];
+            if (t < rank[twin[a]]) {
+                u32 v = arc_to(arcs[a]);
+                parent[v] = arc_from(arcs[a]);
+                depth[v] = depth_prefix[t];
+                preorder[v] = down_prefix[t] - 1;
+                subtree_size[v] = down_prefix[rank[twin[a]]] - down_prefix[t] + 1;
+            }
+        }
+
+        /* The tree of a root ends right before the virtual arc of the next root */
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 u = 0; u < num_nodes; ++u) {
+            if (root_flag[u]) {
+                u32 x = root_prefix[u] - 1;
+                u32 t = rank[num_arcs + x];
+                u32 last = (x + 1 < num_roots ? rank[num_arcs + x + 1] - 1 : list_size - 1);
+                parent[u] = NO_PARENT;
+                depth[u] = 0;
+                preorder[u] = down_prefix[t] - 1;
+                subtree_size[u] = down_prefix[last] - down_prefix[t] + 1;
+            }
+        }
+    }
+
+    u32 num_nodes() const {
+        return parent.size();
+    }
+
+    bool is_root(u32 u) const {
+        return parent[u] == NO_PARENT;
+    }
+
+    static u64 pack_arc(u32 from, u32 to) {
+        return (static_cast<u64>(from) << 32) | to;
+    }
+
+    static u32 arc_from(u64 arc) {
+        return static_cast<u32>(arc >> 32);
+    }
+
+    static u32 arc_to(u64 arc) {
+        return static_cast<u32>(arc);
+    }
+
+    /* root_flag[u] is 1 if u is the smallest node of its tree */
+    template<typename W, typename I>
+    ParallelArray<u32> find_roots(u32 num_nodes, const ParallelArray<BasicEdge<W, I>>& edges) {
+        u32 num_edges = edges.size();
+
+        u32 out_of_range = 0;
+        #pragma omp parallel for num_threads(NUM_THREADS) reduction(+:out_of_range)
+        for (u32 i = 0; i < num_edges; ++i) {
+            out_of_range += (edges[i].from >= num_nodes || edges[i].to >= num_nodes);
+        }
+        if (out_of_range != 0) {
+            throw std::out_of_range("Node id out of range");
+        }
+
+        DSU node_sets(num_nodes, NUM_THREADS);
+        u32 cycles = 0;
+        #pragma omp parallel for num_threads(NUM_THREADS) reduction(+:cycles)
+        for (u32 i = 0; i < num_edges; ++i) {
+            cycles += !node_sets.unite(edges[i].from, edges[i].to);
+        }
+        if (cycles != 0) {
+            throw std::invalid_argument("Edges should form a forest");
+        }
+
+        ParallelArray<u32> component(num_nodes, NUM_THREADS);
+        ParallelArray<atomic_u32> smallest(num_nodes, NUM_THREADS);
+        parallel_fill(reinterpret_cast<u32*>(smallest.begin()), num_nodes, std::numeric_limits<u32>::max(), NUM_THREADS);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 u = 0; u < num_nodes; ++u) {
+            component[u] = node_sets.find_root(u);
+            u32 old = smallest[component[u]].load(std::memory_order_relaxed);
+            while (old > u && !smallest[component[u]].compare_exchange_weak(old, u)) {}
+        }
+
+        ParallelArray<u32> root_flag(num_nodes, NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 u = 0; u < num_nodes; ++u) {
+            root_flag[u] = (smallest[component[u]] == u);
+        }
+
+        return root_flag;
+    }
+};
+
+template<typename W, typename I>
+RootedForest root_forest_sequential(u32 num_nodes, const ParallelArray<BasicEdge<W, I>>& edges) {
+    RootedForest forest(num_nodes, 1);
+
+    std::vector<std::vector<u32>> adjacency(num_nodes);
+    for (const auto& e : edges) {
+        adjacency[e.from].push_back(e.to);
+        adjacency[e.to].push_back(e.from);
+    }
+    for (auto& neighbours : adjacency) {
+        std::sort(neighbours.begin(), neighbours.end());
+    }
+
+    /* Iterative DFS, a recursive one overflows the stack on deep trees */
+    std::vector<u8> visited(num_nodes);
+    std::vector<std::pair<u32, u32>> stack;
+    u32 order = 0;
+
+    auto enter = [&](u32 u, u32 parent, u32 depth) {
+        visited[u] = 1;
+        forest.parent[u] = parent;
+        forest.depth[u] = depth;
+        forest.preorder[u] = order++;
+        stack.push_back({ u, 0 });
+    };
+
+    for (u32 root = 0; root < num_nodes; ++root) {
+        if (visited[root]) continue;
+
+        enter(root, RootedForest::NO_PARENT, 0);
+        while (!stack.empty()) {
+            auto& [u, i] = stack.back();
+            if (i < adjacency[u].size()) {
+                u32 v = adjacency[u][i++];
+                if (!visited[v]) enter(v, u, forest.depth[u] + 1);
+            } else {
+                forest.subtree_size[u] = order - forest.preorder[u];
+                stack.pop_back();
+            }
+        }
+    }
+
+    return forest;
+}
+
+#endif
@@ -2,47 +2,75 @@
 #define __GRAPH_H
 
 #include <algorithm>
+#include <atomic>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <omp.h>
-#include <pair>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "defs.h"
 #include "parallel_algorithms.h"
 #include "parallel_array.h"
-#include "parallel_random.h"
+#include "parallel_memory.h"
+#include "prefix_sum.h"
 #include "utils.h"
+#include "weight_traits.h"
 
-struct Edge {
-    u32 from;
-    u32 to;
-    u32 weight;
+/**
+ * Edge with weights of type W and node ids of type I, see weight_traits.h for supported types
+ * Edge, Graph and GraphView are the u32 versions every engine takes by default
+ */
+template<typename W = u32, typename I = u32>
+struct BasicEdge {
+    static_assert(IndexTraits<I>::supported, "Node ids should be u16 or u32");
+
+    using Weight = W;
+    using Index = I;
 
-    Edge() {}
+    I from;
+    I to;
+    W weight;
 
-    Edge(u32 from, u32 to, u32 weight) : from(from), to(to), weight(weight) {}
+    BasicEdge() {}
+
+    BasicEdge(I from, I to, W weight) : from(from), to(to), weight(weight) {}
 };
 
-bool operator<(const Edge& a, const Edge& b) {
+template<typename W, typename I>
+bool operator<(const BasicEdge<W, I>& a, const BasicEdge<W, I>& b) {
     return std::tie(a.from, a.to, a.weight) < std::tie(b.from, b.to, b.weight);
 }
 
-struct Graph {
-    ParallelArray<u32> nodes;
-    ParallelArray<Edge> edges;
+using Edge = BasicEdge<>;
+
+/**
+ * Node ids are of type I, edges are counted with 64 bit sizes,
+ * so a graph may have more than 2^32 directed edges, see BoruvkaMST for 64 bit edge ids
+ */
+template<typename W = u32, typename I = u32>
+struct BasicGraph {
+    using Weight = W;
+    using Index = I;
+
+    ParallelArray<I> nodes;
+    ParallelArray<BasicEdge<W, I>> edges;
 
-    Graph(u32 num_nodes, u32 num_edges) : nodes(num_nodes),
-                                          edges(num_edges) {}
+    BasicGraph(u32 num_nodes, u64 num_edges) : nodes(num_nodes),
+                                               edges(num_edges) {}
 
     u32 num_nodes() const {
         return nodes.size();
     }
 
-    u32 num_edges() const {
+    u64 num_edges() const {
         return edges.size();
     }
 
@@ -51,76 +79,240 @@ struct Graph {
     }
 };
 
+using Graph = BasicGraph<>;
+
 /**
- * TODO: use a parallel sort
- **/
-Graph load_graph(std::string filename) {
-    std::cout << "Loading graph from path " << filename << "\n";
-    std::ifstream in(filename);
+ * Read-only view of a Graph or of node and edge arrays stored elsewhere
+ *
+ * MST engines take a GraphView, a Graph converts to it implicitly, so running one
+ * never copies the input graph, copy the Graph itself if you need a copy
+ */
+template<typename W = u32, typename I = u32>
+struct BasicGraphView {
+    using Weight = W;
+    using Index = I;
 
-    u32 num_nodes;
-    u32 num_edges;
+    ArrayView<I> nodes;
+    ArrayView<BasicEdge<W, I>> edges;
 
-    in >> num_nodes >> num_edges;
+    BasicGraphView(const BasicGraph<W, I>& graph) : nodes(graph.nodes), edges(graph.edges) {}
+
+    BasicGraphView(ArrayView<I> nodes, ArrayView<BasicEdge<W, I>> edges) : nodes(nodes), edges(edges) {}
+
+    u32 num_nodes() const {
+        return nodes.size();
+    }
+
+    u64 num_edges() const {
+        return edges.size();
+    }
+};
 
-    std::cout << num_nodes << " nodes and " << num_edges << " edges\n";
+using GraphView = BasicGraphView<>;
 
-    Graph G(num_nodes, num_edges * 2);
-    RandomSequence R(num_edges);
+/* Bytes load_graph() reads at once, every chunk is parsed and bucketed by its own task */
+const u64 LOAD_CHUNK_SIZE = 1 << 24;
+/* load_graph() buckets edges by the top LOAD_BUCKET_BITS bits of from */
+const u32 LOAD_BUCKET_BITS = 12;
 
-    std::vector<std::pair<u32, u32>> edges_data;
+/* Reads the next unsigned number of [p, end), false if there is none or it is followed by another character */
+inline bool read_number(const char*& p, const char* end, u64& value) {
+    while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+    if (p == end || *p < '0' || *p > '9') return false;
 
-    #pragma omp parallel for
-    for (u32 i = 0; i < num_nodes; ++i) {
-        G.nodes[i] = i;
+    value = 0;
+    while (p != end && *p >= '0' && *p <= '9' && value <= std::numeric_limits<u32>::max()) {
+        value = value * 10 + (*p - '0');
+        ++p;
     }
+    return p == end || *p == ' ' || *p == '\n' || *p == '\r' || *p == '\t';
+}
 
-    for (u32 i = 0; i < num_edges; ++i) {
-        u32 from, to;
-        in >> from >> to;
-        edges_data.push_back({ from, to });
+/* Edges of one chunk of a graph file, edges of bucket b are [bucket_begin[b], bucket_begin[b + 1]) */
+struct LoadedChunk {
+    std::vector<Edge> edges;
+    std::vector<u64> bucket_begin;
+};
+
+/**
+ * Loads an unweighted graph: the number of nodes, the number of edges, then one "from to" line per edge
+ * Every edge gets a random weight and is stored in both directions, edges are sorted
+ *
+ * Reading, parsing and sorting are pipelined: one thread reads chunk_size bytes at a time,
+ * cut at the last line break, and hands each chunk to a task that parses it, adds both directions
+ * and buckets its edges by the top bits of from while the next chunks are read
+ * Then every bucket gathers its edges from all chunks with a counting sort by from, so only
+ * the few edges of every node are compared, a sort of whole chunks and a merge of them compare all
+ *
+ * The graph has the edges the file has, the number of edges it starts with isn't trusted
+ * Throws std::invalid_argument if the file can't be read, doesn't match the format or has node ids out of range
+ */
+Graph load_graph(std::string filename, u32 NUM_THREADS = omp_get_max_threads(), u64 chunk_size = LOAD_CHUNK_SIZE) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        throw std::invalid_argument("Can't open graph file " + filename);
     }
 
-    for (u32 i = 0; i < num_edges; ++i) {
-        G.edges[2 * i] = Edge(edges_data[i].first, edges_data[i].second, R[i]);
-        G.edges[2 * i + 1] = Edge(edges_data[i].second, edges_data[i].first, R[i]);
+    u64 num_nodes = 0;
+    u64 num_edges = 0;
+    in >> num_nodes >> num_edges;
+    if (!in || num_nodes > std::numeric_limits<u32>::max()) {
+        throw std::invalid_argument("Graph file " + filename + " doesn't match the format");
     }
 
-    G.sort_edges();
+    u32 node_bits = num_nodes > 1 ? 64 - __builtin_clzll(num_nodes - 1) : 0;
+    u32 shift = node_bits > LOAD_BUCKET_BITS ? node_bits - LOAD_BUCKET_BITS : 0;
+    u32 num_buckets = ((std::max<u64>(num_nodes, 1) - 1) >> shift) + 1;
+
+    std::atomic<bool> malformed(false);
+    u64 seed = std::random_device{}();
+
+    /* Deques keep the chunks in place while the reader appends new ones */
+    std::deque<std::string> texts;
+    std::deque<LoadedChunk> chunks;
+
+    #pragma omp parallel num_threads(NUM_THREADS)
+    #pragma omp single
+    {
+        std::string carry;
+        for (u64 k = 0; !malformed; ++k) {
+            texts.push_back(std::move(carry));
+            chunks.emplace_back();
+            std::string* text = &texts.back();
+            LoadedChunk* chunk = &chunks.back();
+
+            u64 kept = text->size();
+            text->resize(kept + chunk_size);
+            in.read(&(*text)[kept], chunk_size);
+            text->resize(kept + in.gcount());
+            bool last = !in;
+
+            /* A line cut by the chunk end goes to the next chunk */
+            u64 cut = last ? text->size() : text->rfind('\n') + 1;
+            carry.assign(*text, cut, std::string::npos);
+            text->resize(cut);
+
+            #pragma omp task firstprivate(text, chunk, k)
+            {
+                const char* begin = text->data();
+                const char* end = begin + text->size();
+                std::mt19937 weights(seed + k);
+                std::vector<Edge> parsed;
+
+                u64 from, to;
+                while (read_number(begin, end, from)) {
+                    if (!read_number(begin, end, to) || from >= num_nodes || to >= num_nodes) {
+                        malformed = true;
+                        break;
+                    }
+                    u32 weight = weights();
+                    parsed.push_back(Edge(from, to, weight));
+                    parsed.push_back(Edge(to, from, weight));
+                }
+                if (begin != end) malformed = true;
+                std::string().swap(*text);
+
+                std::vector<u64>& bucket_begin = chunk->bucket_begin;
+                bucket_begin.assign(num_buckets + 1, 0);
+                for (const Edge& e : parsed) ++bucket_begin[(e.from >> shift) + 1];
+                for (u32 b = 0; b < num_buckets; ++b) bucket_begin[b + 1] += bucket_begin[b];
+
+                std::vector<u64> position(bucket_begin.begin(), bucket_begin.end() - 1);
+                chunk->edges.resize(parsed.size());
+                for (const Edge& e : parsed) chunk->edges[position[e.from >> shift]++] = e;
+            }
+
+            if (last) break;
+        }
+    }
 
-    std::cout << "Graph loaded\n";
+    if (malformed) {
+        throw std::invalid_argument("Graph file " + filename + " doesn't match the format");
+    }
+
+    ParallelArray<u64> bucket_size(num_buckets, NUM_THREADS);
+    #pragma omp parallel for num_threads(NUM_THREADS)
+    for (u32 b = 0; b < num_buckets; ++b) {
+        bucket_size[b] = 0;
+        for (const LoadedChunk& chunk : chunks) {
+            bucket_size[b] += chunk.bucket_begin[b + 1] - chunk.bucket_begin[b];
+        }
+    }
+    PrefixSum bucket_end(num_buckets, bucket_size, NUM_THREADS);
+
+    Graph G(num_nodes, bucket_end[num_buckets - 1]);
+    parallel_iota(G.nodes.begin(), num_nodes, 0u);
+
+    /* Buckets are counting sorted by from into their place, then every node sorts its few edges by to */
+    #pragma omp parallel num_threads(NUM_THREADS)
+    {
+        std::vector<u64> node_begin(1ULL << shift);
+
+        #pragma omp for schedule(dynamic)
+        for (u32 b = 0; b < num_buckets; ++b) {
+            u64 first_node = static_cast<u64>(b) << shift;
+            u32 bucket_nodes = std::min<u64>(num_nodes - first_node, 1ULL << shift);
+
+            std::fill(node_begin.begin(), node_begin.begin() + bucket_nodes, 0);
+            for (const LoadedChunk& chunk : chunks) {
+                for (u64 i = chunk.bucket_begin[b]; i < chunk.bucket_begin[b + 1]; ++i) {
+                    ++node_begin[chunk.edges[i].from - first_node];
+                }
+            }
+            u64 position = bucket_end[b] - bucket_size[b];
+            for (u32 u = 0; u < bucket_nodes; ++u) {
+                u64 degree = node_begin[u];
+                node_begin[u] = position;
+                position += degree;
+            }
+
+            for (const LoadedChunk& chunk : chunks) {
+                for (u64 i = chunk.bucket_begin[b]; i < chunk.bucket_begin[b + 1]; ++i) {
+                    G.edges[node_begin[chunk.edges[i].from - first_node]++] = chunk.edges[i];
+                }
+            }
+
+            /* node_begin[u] is the end of the edges of u now */
+            u64 begin = bucket_end[b] - bucket_size[b];
+            for (u32 u = 0; u < bucket_nodes; ++u) {
+                std::sort(G.edges.begin() + begin, G.edges.begin() + node_begin[u], [](const Edge& x, const Edge& y) {
+                    return (static_cast<u64>(x.to) << 32 | x.weight) < (static_cast<u64>(y.to) << 32 | y.weight);
+                });
+                begin = node_begin[u];
+            }
+        }
+    }
 
     return G;
 }
 
 /**
  * Creates a random connected graph with n nodes and m edges
- * m >= n - 1
+ * m >= n - 1, weights are spread over the whole range of W
  */
-Graph generate_graph(u32 n, u32 m) {
-    Graph G(n, 2 * m);
-    u32 cnt = 0;
+template<typename W = u32, typename I = u32>
+BasicGraph<W, I> generate_graph(u32 n, u64 m) {
+    BasicGraph<W, I> G(n, 2 * m);
+    u64 cnt = 0;
 
-    for (u32 i = 0; i < n; ++i) {
-        G.nodes[i] = i;
-    }
+    parallel_iota(G.nodes.begin(), n, I(0));
 
     for (u32 i = 1; i <= n - 1; ++i) {
-        u32 weight = gen();
+        W weight = WeightTraits<W>::random(gen);
         u32 v = randint(0, i - 1);
 
-        G.edges[cnt++] = Edge(i, v, weight);
-        G.edges[cnt++] = Edge(v, i, weight);
+        G.edges[cnt++] = BasicEdge<W, I>(i, v, weight);
+        G.edges[cnt++] = BasicEdge<W, I>(v, i, weight);
     }
 
-    for (u32 i = 1; i <= m - n + 1; ++i) {
-        u32 weight = gen();
+    for (u64 i = 1; i <= m - n + 1; ++i) {
+        W weight = WeightTraits<W>::random(gen);
         u32 u = randint(0, n - 1);
         u32 v = randint(0, n - 2);
         if (v >= u) ++v;
 
-        G.edges[cnt++] = Edge(u, v, weight);
-        G.edges[cnt++] = Edge(v, u, weight);
+        G.edges[cnt++] = BasicEdge<W, I>(u, v, weight);
+        G.edges[cnt++] = BasicEdge<W, I>(v, u, weight);
     }
 
     G.sort_edges();
@@ -135,8 +327,9 @@ void dfs(u32 u, std::vector<std::vector<u32>>& g, std::vector<u32>& used) {
     }
 }
 
-bool is_connected(Graph G) {
-    std::vector<std::vector<u32>> g(G.num_edges());
+template<typename W, typename I>
+bool is_connected(BasicGraphView<W, I> G) {
+    std::vector<std::vector<u32>> g(G.num_nodes());
     std::vector<u32> used(G.num_nodes());
     for (auto e : G.edges) {
         g[e.from].push_back(e.to);
@@ -154,4 +347,9 @@ bool is_connected(Graph G) {
     return num_comp == 1;
 }
 
+template<typename W, typename I>
+bool is_connected(const BasicGraph<W, I>& G) {
+    return is_connected(BasicGraphView<W, I>(G));
+}
+
 #endif
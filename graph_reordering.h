@@ -0,0 +1,318 @@
+#ifndef __GRAPH_REORDERING_H
+#define __GRAPH_REORDERING_H
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "defs.h"
+#include "graph.h"
+#include "parallel_algorithms.h"
+#include "parallel_array.h"
+#include "parallel_memory.h"
+#include "prefix_sum.h"
+
+/**
+ * INTERFACE:
+ *
+ * ParallelArray<uint32_t> node_order(GraphView graph, NodeOrder order, uint32_t NUM_THREADS) - new_id[u] of every node
+ * ReorderedGraph(GraphView graph, NodeOrder order, uint32_t NUM_THREADS) - copy of graph with relabeled nodes
+ * ReorderedGraph(GraphView graph, ParallelArray<uint32_t> new_id, NUM_THREADS) - the same with a given order
+ * graph - relabeled graph, edges are sorted again
+ * new_id[u], old_id[v] - the permutation of nodes and its inverse
+ * old_edge_id[i] - position of edge i of graph in the input graph
+ * ParallelArray<E> to_original_ids(const ParallelArray<E>& ids) - edge ids of graph as positions in the input
+ * ParallelArray<Edge> to_original_edges(const ParallelArray<Edge>& edges) - edges of graph with the input node ids
+ *
+ * DETAILS:
+ *
+ * Input ids are often arbitrary, then neighbours of a node are spread over the whole id range and
+ * per-node arrays indexed by them (shortest edges, DSU parents, components) are read at random
+ * A new order gives nearby ids to nodes that are close in the graph:
+ *
+ * DEGREE_ORDER - by degree, highest first, hubs that most edges point to share cache lines
+ * BFS_ORDER - in order of a breadth-first search, like Cuthill-McKee: every node gets its id right after
+ *     the nodes of the previous level, neighbours of one node get consecutive ids, ids of edge ends stay close
+ *
+ * BFS is level-synchronous: the frontier claims unvisited neighbours with an atomic minimum of the
+ * frontier position, then each frontier node numbers the neighbours it won in the order of its edges,
+ * so the order doesn't depend on the number of threads. Every component starts from its smallest node
+ * Isolated nodes just take the next id, and levels with few edges are walked on the calling thread
+ * in the same order, so graphs with many small components don't pay for a parallel round per level
+ *
+ * Edges should be sorted by from, like load_graph() and generate_graph() make them,
+ * otherwise std::invalid_argument is thrown, the relabeled graph is sorted the same way
+ * Edges of a node stay together under any order, so relabeling moves each run of edges
+ * to the place of its new id and sorts only the run, not the whole graph
+ */
+enum NodeOrder {
+    ORIGINAL_ORDER,
+    DEGREE_ORDER,
+    BFS_ORDER,
+    NUM_NODE_ORDERS
+};
+
+const char* const NODE_ORDER_NAMES[NUM_NODE_ORDERS] = { "original", "degree", "bfs" };
+
+/* Edges of u are graph.edges[offset[u], offset[u + 1]) */
+template<typename W, typename I>
+ParallelArray<u64> edge_offsets(BasicGraphView<W, I> graph, u32 NUM_THREADS = omp_get_max_threads()) {
+    bool sorted = true;
+    #pragma omp parallel for num_threads(NUM_THREADS) reduction(&&:sorted)
+    for (u64 i = 1; i < graph.num_edges(); ++i) {
+        sorted = sorted && graph.edges[i - 1].from <= graph.edges[i].from;
+    }
+    if (!sorted) {
+        throw std::invalid_argument("Edges should be sorted by from for reordering");
+    }
+
+    ParallelArray<u64> offset(static_cast<u64>(graph.num_nodes()) + 1, NUM_THREADS);
+    #pragma omp parallel for num_threads(NUM_THREADS)
+    for (u32 u = 0; u <= graph.num_nodes(); ++u) {
+        offset[u] = std::lower_bound(graph.edges.begin(), graph.edges.end(), u,
+                                     [](const BasicEdge<W, I>& e, u32 node) {
+                                         return e.from < node;
+                                     }) - graph.edges.begin();
+    }
+    return offset;
+}
+
+template<typename W, typename I>
+ParallelArray<u32> degree_order(BasicGraphView<W, I> graph, u32 NUM_THREADS = omp_get_max_threads()) {
+    u32 num_nodes = graph.num_nodes();
+    ParallelArray<u64> offset = edge_offsets(graph, NUM_THREADS);
+
+    /* ~degree sorts highest degrees first, ties go by id */
+    ParallelArray<u64> order(num_nodes, NUM_THREADS);
+    #pragma omp parallel for num_threads(NUM_THREADS)
+    for (u32 u = 0; u < num_nodes; ++u) {
+        u64 degree = std::min<u64>(offset[u + 1] - offset[u], std::numeric_limits<u32>::max());
+        order[u] = (static_cast<u64>(~static_cast<u32>(degree)) << 32) | u;
+    }
+    parallel_sort(order.begin(), order.end());
+
+    ParallelArray<u32> new_id(num_nodes, NUM_THREADS);
+    #pragma omp parallel for num_threads(NUM_THREADS)
+    for (u32 i = 0; i < num_nodes; ++i) {
+        new_id[static_cast<u32>(order[i])] = i;
+    }
+    return new_id;
+}
+
+template<typename W, typename I>
+ParallelArray<u32> bfs_order(BasicGraphView<W, I> graph, u32 NUM_THREADS = omp_get_max_threads()) {
+    const u32 UNVISITED = std::numeric_limits<u32>::max();
+    /* A parallel level costs a few regions and a prefix sum, less work than this is walked on the calling thread */
+    const u64 SEQUENTIAL_FRONTIER_EDGES = 4096;
+
+    u32 num_nodes = graph.num_nodes();
+    ParallelArray<u64> offset = edge_offsets(graph, NUM_THREADS);
+
+    ParallelArray<u32> new_id(num_nodes, NUM_THREADS);
+    ParallelArray<atomic_u32> claim(num_nodes, NUM_THREADS);
+    parallel_fill(new_id.begin(), num_nodes, UNVISITED, NUM_THREADS);
+    parallel_fill(reinterpret_cast<u32*>(claim.begin()), num_nodes, UNVISITED, NUM_THREADS);
+
+    /* Parallel edges to the same node are neighbours in the sorted edges, only the first one counts */
+    auto first_copy = [&](u64 i) {
+        return i == 0 || graph.edges[i - 1].from != graph.edges[i].from || graph.edges[i - 1].to != graph.edges[i].to;
+    };
+
+    u32 next_id = 0;
+    for (u32 start = 0; start < num_nodes; ++start) {
+        if (new_id[start] != UNVISITED) continue;
+
+        new_id[start] = next_id++;
+        if (offset[start] == offset[start + 1]) continue;
+
+        ParallelArray<u32> frontier(1, NUM_THREADS);
+        frontier[0] = start;
+
+        while (frontier.size() != 0) {
+            u32 frontier_size = frontier.size();
+
+            /* Frontier nodes have at least one edge, so a large frontier has many edges too */
+            u64 frontier_edges = 0;
+            for (u32 f = 0; f < frontier_size && frontier_edges < SEQUENTIAL_FRONTIER_EDGES; ++f) {
+                frontier_edges += offset[frontier[f] + 1] - offset[frontier[f]];
+            }
+            if (frontier_edges < SEQUENTIAL_FRONTIER_EDGES) {
+                std::vector<u32> next;
+                for (u32 f = 0; f < frontier_size; ++f) {
+                    u32 u = frontier[f];
+                    for (u64 i = offset[u]; i < offset[u + 1]; ++i) {
+                        u32 v = graph.edges[i].to;
+                        if (new_id[v] != UNVISITED) continue;
+
+                        new_id[v] = next_id++;
+                        next.push_back(v);
+                    }
+                }
+
+                ParallelArray<u32> next_frontier(next.size(), NUM_THREADS);
+                std::copy(next.begin(), next.end(), next_frontier.begin());
+                frontier.swap(next_frontier);
+                continue;
+            }
+
+            #pragma omp parallel for num_threads(NUM_THREADS) schedule(dynamic, 64)
+            for (u32 f = 0; f < frontier_size; ++f) {
+                u32 u = frontier[f];
+                for (u64 i = offset[u]; i < offset[u + 1]; ++i) {
+                    u32 v = graph.edges[i].to;
+                    if (new_id[v] != UNVISITED) continue;
+
+                    u32 old = claim[v].load(std::memory_order_relaxed);
+                    while (old > f && !claim[v].compare_exchange_weak(old, f)) {}
+                }
+            }
+
+            ParallelArray<u32> won(frontier_size, NUM_THREADS);
+            #pragma omp parallel for num_threads(NUM_THREADS) schedule(dynamic, 64)
+            for (u32 f = 0; f < frontier_size; ++f) {
+                u32 u = frontier[f];
+                u32 count = 0;
+                for (u64 i = offset[u]; i < offset[u + 1]; ++i) {
+                    u32 v = graph.edges[i].to;
+                    count += (claim[v] == f && new_id[v] == UNVISITED && first_copy(i));
+                }
+                won[f] = count;
+            }
+
+            PrefixSum won_prefix(frontier_size, won, NUM_THREADS);
+            ParallelArray<u32> next_frontier(won_prefix[frontier_size - 1], NUM_THREADS);
+
+            /* A node is won by one frontier node, so only its winner reads and writes its new_id here */
+            #pragma omp parallel for num_threads(NUM_THREADS) schedule(dynamic, 64)
+            for (u32 f = 0; f < frontier_size; ++f) {
+                u32 u = frontier[f];
+                u32 position = won_prefix[f] - won[f];
+                for (u64 i = offset[u]; i < offset[u + 1]; ++i) {
+                    u32 v = graph.edges[i].to;
+                    if (claim[v] == f && new_id[v] == UNVISITED && first_copy(i)) {
+                        next_frontier[position] = v;
+                        new_id[v] = next_id + position;
+                        ++position;
+                    }
+                }
+            }
+
+            next_id += next_frontier.size();
+            frontier.swap(next_frontier);
+        }
+    }
+
+    return new_id;
+}
+
+template<typename W, typename I>
+ParallelArray<u32> node_order(BasicGraphView<W, I> graph, NodeOrder order, u32 NUM_THREADS = omp_get_max_threads()) {
+    if (order == DEGREE_ORDER) return degree_order(graph, NUM_THREADS);
+    if (order == BFS_ORDER) return bfs_order(graph, NUM_THREADS);
+
+    ParallelArray<u32> new_id(graph.num_nodes(), NUM_THREADS);
+    parallel_iota(new_id.begin(), graph.num_nodes(), 0u, NUM_THREADS);
+    return new_id;
+}
+
+template<typename W = u32, typename I = u32>
+struct BasicReorderedGraph {
+    using EdgeType = BasicEdge<W, I>;
+
+    const u32 NUM_THREADS;
+
+    BasicGraph<W, I> graph;
+    ParallelArray<u32> new_id;
+    ParallelArray<u32> old_id;
+    ParallelArray<u64> old_edge_id;
+
+    BasicReorderedGraph(BasicGraphView<W, I> input,
+                        NodeOrder order,
+                        u32 NUM_THREADS = omp_get_max_threads()) : BasicReorderedGraph(input,
+                                                                                       node_order(input, order, NUM_THREADS),
+                                                                                       NUM_THREADS) {}
+
+    BasicReorderedGraph(BasicGraphView<W, I> input,
+                        ParallelArray<u32> node_new_id,
+                        u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+                                                                   graph(input.num_nodes(), input.num_edges()),
+                                                                   new_id(0, NUM_THREADS),
+                                                                   old_id(input.num_nodes(), NUM_THREADS),
+                                                                   old_edge_id(input.num_edges(), NUM_THREADS) {
+        if (node_new_id.size() != input.num_nodes()) {
+            throw std::invalid_argument("Node order should have an id for every node");
+        }
+        new_id.swap(node_new_id);
+
+        u32 num_nodes = input.num_nodes();
+        u64 num_edges = input.num_edges();
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 u = 0; u < num_nodes; ++u) {
+            old_id[new_id[u]] = u;
+            graph.nodes[u] = new_id[input.nodes[u]];
+        }
+        parallel_sort(graph.nodes.begin(), graph.nodes.end());
+
+        if (num_edges == 0) return;
+
+        /* Edges of new node v are the run of old node old_id[v], runs are moved whole, then sorted by to */
+        ParallelArray<u64> offset = edge_offsets(input, NUM_THREADS);
+        ParallelArray<u32> degree(num_nodes, NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 v = 0; v < num_nodes; ++v) {
+            degree[v] = offset[old_id[v] + 1] - offset[old_id[v]];
+        }
+
+        PrefixSum<u32, u64> degree_prefix(num_nodes, degree, NUM_THREADS);
+
+        #pragma omp parallel num_threads(NUM_THREADS)
+        {
+            std::vector<std::pair<EdgeType, u64>> run;
+
+            #pragma omp for schedule(dynamic, 256)
+            for (u32 v = 0; v < num_nodes; ++v) {
+                u64 old_begin = offset[old_id[v]];
+                u64 begin = degree_prefix[v] - degree[v];
+
+                run.clear();
+                for (u64 i = old_begin; i < old_begin + degree[v]; ++i) {
+                    const EdgeType& e = input.edges[i];
+                    run.push_back({ EdgeType(v, new_id[e.to], e.weight), i });
+                }
+                std::sort(run.begin(), run.end());
+
+                for (u32 k = 0; k < run.size(); ++k) {
+                    graph.edges[begin + k] = run[k].first;
+                    old_edge_id[begin + k] = run[k].second;
+                }
+            }
+        }
+    }
+
+    template<typename E>
+    ParallelArray<E> to_original_ids(const ParallelArray<E>& ids) const {
+        ParallelArray<E> result(ids.size(), NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u64 i = 0; i < ids.size(); ++i) {
+            result[i] = old_edge_id[ids[i]];
+        }
+        return result;
+    }
+
+    ParallelArray<EdgeType> to_original_edges(const ParallelArray<EdgeType>& edges) const {
+        ParallelArray<EdgeType> result(edges.size(), NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u64 i = 0; i < edges.size(); ++i) {
+            result[i] = EdgeType(old_id[edges[i].from], old_id[edges[i].to], edges[i].weight);
+        }
+        return result;
+    }
+};
+
+using ReorderedGraph = BasicReorderedGraph<>;
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef __INSTRUMENTATION_H
+#define __INSTRUMENTATION_H
+
+#include <atomic>
+#include <omp.h>
+#include <ostream>
+#include <vector>
+
+#include "defs.h"
+
+/**
+ * Hot path instrumentation, enabled with -DENABLE_INSTRUMENTATION
+ *
+ * INTERFACE:
+ *
+ * INSTRUMENT_ALLOCATION(bytes) - adds bytes to the global allocation counter
+ * uint64_t allocated_bytes() - total bytes allocated by ParallelArray and PrefixSum so far
+ * InstrumentedCounter - event counter that is safe to increment from several threads
+ * BoruvkaProfile - per round statistics of BoruvkaMST, can be written as CSV or JSON
+ *
+ * DETAILS:
+ *
+ * Without ENABLE_INSTRUMENTATION every macro expands to nothing and every struct
+ * here is empty with empty inline methods, so disabled builds don't pay for
+ * a single clock read or atomic increment
+ */
+
+#ifdef ENABLE_INSTRUMENTATION
+
+atomic_u64& allocated_bytes_counter() {
+    static atomic_u64 counter(0);
+    return counter;
+}
+
+#define INSTRUMENT_ALLOCATION(bytes) allocated_bytes_counter().fetch_add((bytes), std::memory_order_relaxed)
+
+u64 allocated_bytes() {
+    return allocated_bytes_counter().load(std::memory_order_relaxed);
+}
+
+/**
+ * Relaxed atomic counter, copying it copies the current value
+ */
+struct InstrumentedCounter {
+    atomic_u64 value;
+
+    InstrumentedCounter() : value(0) {}
+
+    InstrumentedCounter(const InstrumentedCounter& other) : value(other.get()) {}
+
+    void add(u64 x = 1) {
+        value.fetch_add(x, std::memory_order_relaxed);
+    }
+
+    u64 get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+#else
+
+#define INSTRUMENT_ALLOCATION(bytes)
+
+u64 allocated_bytes() {
+    return 0;
+}
+
+struct InstrumentedCounter {
+    void add(u64 = 1) {}
+
+    u64 get() const {
+        return 0;
+    }
+};
+
+#endif
+
+enum BoruvkaPhase {
+    MIN_EDGE_PHASE,
+    SELECT_PHASE,
+    MST_APPEND_PHASE,
+    EDGE_FILTER_PHASE,
+    NODE_FILTER_PHASE,
+    SORT_PHASE,
+    NUM_PHASES
+};
+
+const char* const BORUVKA_PHASE_NAMES[NUM_PHASES] = {
+    "min_edge", "select", "mst_append", "edge_filter", "node_filter", "sort"
+};
+
+/**
+ * One round of BoruvkaMST, times are wall clock seconds
+ * The final round done with Kruskal's algorithm is marked as sequential and has no phases
+ */
+struct BoruvkaRoundStats {
+    u32 nodes_in;
+    u64 edges_in;
+    u32 nodes_out;
+    u64 edges_out;
+    bool sequential;
+    double phase_time[NUM_PHASES];
+    double total_time;
+    u64 cas_retries;
+    u64 allocated_bytes;
+};
+
+#ifdef ENABLE_INSTRUMENTATION
+
+struct BoruvkaProfile {
+    std::vector<BoruvkaRoundStats> rounds;
+
+    double round_start;
+    double phase_start;
+    u64 cas_retries_start;
+    u64 allocated_bytes_start;
+
+    void clear() {
+        rounds.clear();
+    }
+
+    void start_round(u32 nodes, u64 edges, u64 cas_retries) {
+        BoruvkaRoundStats round = {};
+        round.nodes_in = nodes;
+        round.edges_in = edges;
+        rounds.push_back(round);
+
+        cas_retries_start = cas_retries;
+        allocated_bytes_start = allocated_bytes();
+        round_start = phase_start = omp_get_wtime();
+    }
+
+    /* Phase lasts from the end of the previous one */
+    void end_phase(BoruvkaPhase phase) {
+        double now = omp_get_wtime();
+        rounds.back().phase_time[phase] += now - phase_start;
+        phase_start = now;
+    }
+
+    void end_round(u32 nodes, u64 edges, u64 cas_retries, bool sequential = false) {
+        BoruvkaRoundStats& round = rounds.back();
+        round.total_time = omp_get_wtime() - round_start;
+        round.nodes_out = nodes;
+        round.edges_out = edges;
+        round.sequential = sequential;
+        round.cas_retries = cas_retries - cas_retries_start;
+        round.allocated_bytes = allocated_bytes() - allocated_bytes_start;
+    }
+
+    void write_csv(std::ostream& out) const {
+        out << "round,mode,nodes_in,edges_in,nodes_out,edges_out";
+        for (u32 phase = 0; phase < NUM_PHASES; ++phase) {
+            out << "," << BORUVKA_PHASE_NAMES[phase];
+        }
+        out << ",total,cas_retries,allocated_bytes\n";
+
+        for (u32 i = 0; i < rounds.size(); ++i) {
+            const BoruvkaRoundStats& round = rounds[i];
+            out << i + 1 << "," << (round.sequential ? "sequential" : "parallel") << ","
+                << round.nodes_in << "," << round.edges_in << ","
+                << round.nodes_out << "," << round.edges_out;
+            for (u32 phase = 0; phase < NUM_PHASES; ++phase) {
+                out << "," << round.phase_time[phase];
+            }
+            out << "," << round.total_time << "," << round.cas_retries << "," << round.allocated_bytes << "\n";
+        }
+    }
+
+    void write_json(std::ostream& out) const {
+        out << "[";
+        for (u32 i = 0; i < rounds.size(); ++i) {
+            const BoruvkaRoundStats& round = rounds[i];
+            out << (i == 0 ? "\n" : ",\n")
+                << "  {\"round\": " << i + 1
+                << ", \"mode\": \"" << (round.sequential ? "sequential" : "parallel") << "\""
+                << ", \"nodes_in\": " << round.nodes_in
+                << ", \"edges_in\": " << round.edges_in
+                << ", \"nodes_out\": " << round.nodes_out
+                << ", \"edges_out\": " << round.edges_out;
+            for (u32 phase = 0; phase < NUM_PHASES; ++phase) {
+                out << ", \"" << BORUVKA_PHASE_NAMES[phase] << "\": " << round.phase_time[phase];
+            }
+            out << ", \"total\": " << round.total_time
+                << ", \"cas_retries\": " << round.cas_retries
+                << ", \"allocated_bytes\": " << round.allocated_bytes << "}";
+        }
+        out << "\n]\n";
+    }
+};
+
+#else
+
+struct BoruvkaProfile {
+    void clear() {}
+
+    void start_round(u32, u64, u64) {}
+
+    void end_phase(BoruvkaPhase) {}
+
+    void end_round(u32, u64, u64, bool = false) {}
+
+    void write_csv(std::ostream&) const {}
+
+    void write_json(std::ostream&) const {}
+};
+
+#endif
+
+#endif
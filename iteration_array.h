@@ -1,26 +1,231 @@
 #ifndef __ITERATION_ARRAY_H
 #define __ITERATION_ARRAY_H
 
-#include <bitset>
-#include <list>
+#include <omp.h>
+#include <stdexcept>
 
 #include "defs.h"
 #include "parallel_array.h"
+#include "parallel_memory.h"
+#include "prefix_sum.h"
 
+/**
+ * INTERFACE:
+ *
+ * IterationArray<T>(uint32_t size, uint32_t NUM_THREADS) - array of size values with an empty set of active ids
+ * uint32_t size() - number of slots, active or not
+ * uint32_t count() - number of active ids
+ * bool is_sparse() - whether active ids are kept as a list, see DETAILS
+ * bool contains(uint32_t id) - checks if id is active
+ * T& operator[](uint32_t id) - value of slot id, it is kept when id is deactivated
+ * void for_each(F f) - calls f(id) for every active id in parallel, in no particular order
+ * void activate(ArrayView<uint32_t> ids) - activates distinct ids, active ones are skipped
+ * void deactivate(ArrayView<uint32_t> ids) - deactivates distinct ids, inactive ones are skipped
+ * void deactivate_if(F predicate) - deactivates every active id with predicate(id) == true
+ *
+ * DETAILS:
+ *
+ * An active set for frontier algorithms, like super-vertices left in a round of Boruvka's algorithm
+ *
+ * Membership is a dense array of flags, it is always up to date, so contains() is O(1)
+ * While the set is dense for_each() scans all the flags, that costs O(size) per call,
+ * once count() drops below size / SPARSE_RATIO active ids are also compacted into a list
+ * and for_each() and deactivate_if() only touch them
+ * The list is dropped when the set becomes dense again at size / DENSE_RATIO,
+ * ratios differ so a set around the threshold doesn't rebuild the list on every call
+ *
+ * Bulk operations are compactions with PrefixSum, f and predicate are called from several threads
+ */
 template<typename T>
 struct IterationArray {
+    static constexpr u32 SPARSE_RATIO = 32;
+    static constexpr u32 DENSE_RATIO = 16;
+
+    const u32 NUM_THREADS;
+
     ParallelArray<T> arr;
-    ParallelArray<bool> is_empty;
-    std::list<int> non_empty;
+    ParallelArray<u8> active;
+
+    /* Active ids while the set is sparse, empty otherwise */
+    ParallelArray<u32> active_ids;
+    bool sparse;
+    u32 active_count;
+
+    IterationArray(u32 size, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+                                                                        arr(size, NUM_THREADS),
+                                                                        active(size, NUM_THREADS),
+                                                                        active_ids(0, NUM_THREADS),
+                                                                        sparse(size != 0),
+                                                                        active_count(0) {
+        parallel_zero(active.begin(), size, NUM_THREADS);
+    }
+
+    u32 size() const {
+        return arr.size();
+    }
+
+    u32 count() const {
+        return active_count;
+    }
+
+    bool is_sparse() const {
+        return sparse;
+    }
 
-    IterationArray(u32 size) : arr(size), is_empty(size) {}
+    bool contains(u32 id) const {
+        return active[id];
+    }
 
-    const T& operator[](u32 id) {
+    const T& operator[](u32 id) const {
+        if (id >= size()) {
+            throw std::out_of_range("Iteration array id out of range");
+        }
         return arr[id];
     }
 
     T& operator[](u32 id) {
+        if (id >= size()) {
+            throw std::out_of_range("Iteration array id out of range");
+        }
+        return arr[id];
+    }
+
+    template<typename F>
+    void for_each(F f) const {
+        if (sparse) {
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < active_ids.size(); ++i) {
+                f(active_ids[i]);
+            }
+            return;
+        }
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 id = 0; id < size(); ++id) {
+            if (active[id]) f(id);
+        }
+    }
+
+    void activate(ArrayView<u32> ids) {
+        if (ids.size() == 0) return;
+
+        ParallelArray<u32> is_new(ids.size(), NUM_THREADS);
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < ids.size(); ++i) {
+            is_new[i] = !active[ids[i]];
+        }
+
+        PrefixSum is_new_prefix(ids.size(), is_new, NUM_THREADS);
+        u32 num_new = is_new_prefix[ids.size() - 1];
+
+        if (sparse) {
+            ParallelArray<u32> new_ids(active_ids.size() + num_new, NUM_THREADS);
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < active_ids.size(); ++i) {
+                new_ids[i] = active_ids[i];
+            }
+
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < ids.size(); ++i) {
+                if (is_new[i]) {
+                    new_ids[active_ids.size() + is_new_prefix[i] - 1] = ids[i];
+                }
+            }
+            active_ids.swap(new_ids);
+        }
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < ids.size(); ++i) {
+            active[ids[i]] = 1;
+        }
+
+        active_count += num_new;
+        update_representation();
+    }
+
+    void deactivate(ArrayView<u32> ids) {
+        ParallelArray<u8> to_remove(size(), NUM_THREADS);
+        parallel_zero(to_remove.begin(), size(), NUM_THREADS);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < ids.size(); ++i) {
+            to_remove[ids[i]] = 1;
+        }
+
+        deactivate_if([&](u32 id) {
+            return to_remove[id];
+        });
+    }
+
+    template<typename F>
+    void deactivate_if(F predicate) {
+        if (sparse) {
+            ParallelArray<u32> remains(active_ids.size(), NUM_THREADS);
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 i = 0; i < active_ids.size(); ++i) {
+                remains[i] = !predicate(active_ids[i]);
+            }
+
+            active_count = compact_ids(active_ids, remains);
+            update_representation();
+            return;
+        }
+
+        u32 removed = 0;
+        #pragma omp parallel for num_threads(NUM_THREADS) reduction(+:removed)
+        for (u32 id = 0; id < size(); ++id) {
+            if (active[id] && predicate(id)) {
+                active[id] = 0;
+                ++removed;
+            }
+        }
+
+        active_count -= removed;
+        update_representation();
+    }
+
+    /**
+     * Keeps ids[i] with remains[i] != 0 in ids and clears flags of the rest,
+     * returns the number of ids left
+     */
+    u32 compact_ids(ParallelArray<u32>& ids, const ParallelArray<u32>& remains) {
+        if (ids.size() == 0) return 0;
+
+        PrefixSum remains_prefix(ids.size(), remains, NUM_THREADS);
+        ParallelArray<u32> new_ids(remains_prefix[ids.size() - 1], NUM_THREADS);
+
+        #pragma omp parallel for num_threads(NUM_THREADS)
+        for (u32 i = 0; i < ids.size(); ++i) {
+            if (remains[i]) {
+                new_ids[remains_prefix[i] - 1] = ids[i];
+            } else {
+                active[ids[i]] = 0;
+            }
+        }
+
+        ids.swap(new_ids);
+        return ids.size();
+    }
+
+    /* Builds or drops the list of active ids once the density crosses a threshold */
+    void update_representation() {
+        if (!sparse && static_cast<u64>(active_count) * SPARSE_RATIO < size()) {
+            ParallelArray<u32> all_ids(size(), NUM_THREADS);
+            ParallelArray<u32> is_active(size(), NUM_THREADS);
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u32 id = 0; id < size(); ++id) {
+                all_ids[id] = id;
+                is_active[id] = active[id];
+            }
 
+            compact_ids(all_ids, is_active);
+            active_ids.swap(all_ids);
+            sparse = true;
+        } else if (sparse && static_cast<u64>(active_count) * DENSE_RATIO >= size()) {
+            ParallelArray<u32> empty(0, NUM_THREADS);
+            active_ids.swap(empty);
+            sparse = false;
+        }
     }
 };
 
@@ -0,0 +1,110 @@
+#ifndef __LIST_RANKING_H
+#define __LIST_RANKING_H
+
+#include <limits>
+#include <omp.h>
+
+#include "defs.h"
+#include "parallel_array.h"
+#include "prefix_sum.h"
+
+/**
+ * INTERFACE:
+ *
+ * ParallelArray<uint32_t> rank_list(const ParallelArray<uint32_t>& next,
+ *                                   uint32_t head,
+ *                                   const uint32_t* weight,
+ *                                   uint32_t NUM_THREADS) - rank[i] is the sum of weights of the elements
+ *     before i on the list that starts at head, next[i] is the element after i or LIST_END,
+ *     every element should be on the list, weights are 1 if weight is nullptr
+ * ParallelArray<uint32_t> rank_list_sequential(next, head, weight) - the same ranks from a walk on one thread
+ *
+ * DETAILS:
+ *
+ * Pointer jumping does O(n log n) work, this is sublist ranking with O(n) work:
+ * 1. Roughly every LIST_SUBLIST_LENGTH-th element is a splitter, picked by a hash of its id, head always is
+ * 2. Each splitter walks its sublist up to the next splitter and writes the local ranks and the sublist of every element
+ * 3. Sublists make a list of their own, LIST_SUBLIST_LENGTH times shorter, with sublist weights as weights,
+ *    it is ranked recursively, lists shorter than LIST_SEQUENTIAL_CUTOFF are walked on one thread
+ * 4. Local ranks get the ranks of their sublists added
+ *
+ * Sublists are O(LIST_SUBLIST_LENGTH log n) long with high probability, so the depth is polylogarithmic
+ * Walks are random accesses, as in any list ranking, but every element is visited twice, not log n times
+ *
+ * Sums of all weights should fit in 32 bits
+ */
+constexpr u32 LIST_END = std::numeric_limits<u32>::max();
+constexpr u32 LIST_SUBLIST_BITS = 6;
+constexpr u32 LIST_SUBLIST_LENGTH = 1 << LIST_SUBLIST_BITS;
+constexpr u32 LIST_SEQUENTIAL_CUTOFF = 1 << 16;
+
+/* Fibonacci hashing, ids that are close in memory aren't close on the list */
+inline bool is_list_splitter(u32 i) {
+    return ((i * 0x9E3779B97F4A7C15ULL) >> (64 - LIST_SUBLIST_BITS)) == 0;
+}
+
+inline ParallelArray<u32> rank_list_sequential(const ParallelArray<u32>& next, u32 head, const u32* weight = nullptr) {
+    ParallelArray<u32> rank(next.size(), 1);
+    u32 sum = 0;
+    for (u32 i = head; i != LIST_END; i = next[i]) {
+        rank[i] = sum;
+        sum += (weight == nullptr ? 1 : weight[i]);
+    }
+    return rank;
+}
+
+inline ParallelArray<u32> rank_list(const ParallelArray<u32>& next,
+                                    u32 head,
+                                    const u32* weight = nullptr,
+                                    u32 NUM_THREADS = omp_get_max_threads()) {
+    u32 size = next.size();
+    if (size < LIST_SEQUENTIAL_CUTOFF || NUM_THREADS == 1) {
+        return rank_list_sequential(next, head, weight);
+    }
+
+    ParallelArray<u32> is_splitter(size, NUM_THREADS);
+    #pragma omp parallel for num_threads(NUM_THREADS)
+    for (u32 i = 0; i < size; ++i) {
+        is_splitter[i] = (i == head || is_list_splitter(i));
+    }
+
+    PrefixSum splitter_prefix(size, is_splitter, NUM_THREADS);
+    u32 num_sublists = splitter_prefix[size - 1];
+
+    /* rank holds ranks inside sublists until sublists are ranked */
+    ParallelArray<u32> rank(size, NUM_THREADS);
+    ParallelArray<u32> sublist(size, NUM_THREADS);
+    ParallelArray<u32> sublist_next(num_sublists, NUM_THREADS);
+    ParallelArray<u32> sublist_weight(num_sublists, NUM_THREADS);
+
+    /* Walks differ in length, chunks of many ids hold many splitters and even them out */
+    #pragma omp parallel for num_threads(NUM_THREADS) schedule(dynamic, 4096)
+    for (u32 i = 0; i < size; ++i) {
+        if (!is_splitter[i]) continue;
+
+        u32 s = splitter_prefix[i] - 1;
+        u32 local_rank = 0;
+        u32 j = i;
+        do {
+            sublist[j] = s;
+            rank[j] = local_rank;
+            local_rank += (weight == nullptr ? 1 : weight[j]);
+            j = next[j];
+        } while (j != LIST_END && !is_splitter[j]);
+
+        sublist_next[s] = (j == LIST_END ? LIST_END : splitter_prefix[j] - 1);
+        sublist_weight[s] = local_rank;
+    }
+
+    ParallelArray<u32> sublist_rank = rank_list(sublist_next, splitter_prefix[head] - 1,
+                                                sublist_weight.begin(), NUM_THREADS);
+
+    #pragma omp parallel for num_threads(NUM_THREADS)
+    for (u32 i = 0; i < size; ++i) {
+        rank[i] += sublist_rank[sublist[i]];
+    }
+
+    return rank;
+}
+
+#endif
@@ -10,8 +10,12 @@
 
 // TODO write my own qsort implementation
 template<typename It>
-void parallel_sort(It begin, It end) {
-    __gnu_parallel::sort(begin, end);
+void parallel_sort(It begin, It end, u32 NUM_THREADS = omp_get_max_threads()) {
+    if (NUM_THREADS == 1) {
+        std::sort(begin, end);
+        return;
+    }
+    __gnu_parallel::sort(begin, end, __gnu_parallel::default_parallel_tag(NUM_THREADS));
 }
 
 #endif
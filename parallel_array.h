@@ -2,72 +2,106 @@
 #define __PARALLEL_ARRAY_H
 
 #include <omp.h>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 #include "defs.h"
-
+#include "instrumentation.h"
+#include "parallel_memory.h"
+
+/**
+ * INTERFACE:
+ *
+ * ParallelArray<T>(uint64_t size, uint32_t NUM_THREADS) - uninitialized array of size elements
+ * uint64_t size() - number of elements
+ * T& operator[](uint64_t id) - element id
+ * void swap(ParallelArray<T>& other) - exchanges contents without copying
+ * begin(), end() - pointers to the elements
+ *
+ * ArrayView<T>(const ParallelArray<T>& arr) - read-only view of arr, it doesn't own or copy elements
+ * ArrayView<T>(const T* data, uint64_t size) - view of size elements starting at data, e.g. of a std::vector
+ *
+ * DETAILS:
+ *
+ * Copies are deep and made with NUM_THREADS threads by parallel_copy(),
+ * moves and swaps only exchange pointers, so ParallelArray can be returned
+ * and stored in containers without copying its elements
+ *
+ * ArrayView is two words and is passed by value, a ParallelArray converts to it implicitly,
+ * it is valid as long as the array it views isn't destroyed, resized or swapped
+ *
+ * Sizes and ids are 64 bit, so arrays of edges of the largest graphs fit,
+ * loops of callers that never see more than 2^32 elements keep u32 counters
+ */
 template<typename T>
 struct ParallelArray {
     const u32 NUM_THREADS;
 
-    u32 arr_size;
+    u64 arr_size;
     T* data;
 
-    ParallelArray(u32 arr_size, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+    ParallelArray(u64 arr_size, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
                                                                            arr_size(arr_size) {
         data = static_cast<T*>(operator new[] (arr_size * sizeof(T)));
+        INSTRUMENT_ALLOCATION(arr_size * sizeof(T));
     }
 
-    ParallelArray(ParallelArray<T>& other) : NUM_THREADS(other.NUM_THREADS),
-                                                arr_size(other.arr_size) {
+    ParallelArray(const ParallelArray<T>& other) : NUM_THREADS(other.NUM_THREADS),
+                                                   arr_size(other.arr_size) {
         data = static_cast<T*>(operator new[] (arr_size * sizeof(T)));
-
-        #pragma omp parallel for num_threads(NUM_THREADS)
-        for (u32 i = 0; i < arr_size; ++i) {
-            data[i] = other.data[i];
+        INSTRUMENT_ALLOCATION(arr_size * sizeof(T));
+
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            parallel_copy(other.data, data, arr_size, NUM_THREADS);
+        } else {
+            #pragma omp parallel for num_threads(NUM_THREADS)
+            for (u64 i = 0; i < arr_size; ++i) {
+                data[i] = other.data[i];
+            }
         }
     }
 
-    ParallelArray(ParallelArray<T>&& other) : NUM_THREADS(other.NUM_THREADS) {
-        std::swap(arr_size, other.arr_size);
-        std::swap(data, other.data);
+    ParallelArray(ParallelArray<T>&& other) noexcept : NUM_THREADS(other.NUM_THREADS),
+                                                       arr_size(other.arr_size),
+                                                       data(other.data) {
+        other.arr_size = 0;
+        other.data = nullptr;
     }
 
     ParallelArray<T>& operator=(const ParallelArray<T>& other) {
-        delete[] data;
-        arr_size = other.arr_size;
-        data = static_cast<T*>(operator new[] (arr_size * sizeof(T)));
+        if (this == &other) return *this;
 
-        #pragma omp parallel for num_threads(NUM_THREADS)
-        for (u32 i = 0; i < arr_size; ++i) {
-            data[i] = other.data[i];
-        }
+        ParallelArray<T> copy(other);
+        swap(copy);
+        return *this;
+    }
 
+    ParallelArray<T>& operator=(ParallelArray<T>&& other) noexcept {
+        swap(other);
         return *this;
     }
 
-    u32 size() const {
+    u64 size() const {
         return arr_size;
     }
 
-    const T& operator[](u32 id) const {
+    const T& operator[](u64 id) const {
         if (id >= arr_size) {
             throw std::out_of_range("Parallel array id out of range");
         }
         return data[id];
     }
 
-    T& operator[](u32 id) {
+    T& operator[](u64 id) {
         if (id >= arr_size) {
             throw std::out_of_range("Parallel array id out of range");
         }
         return data[id];
     }
 
-    void swap(ParallelArray<T> other) {
-        if (this == &other) {
-            throw std::invalid_argument("Swapping with the same ParallelArray");
-        }
+    /* NUM_THREADS stays with the object, only elements are exchanged */
+    void swap(ParallelArray<T>& other) noexcept {
         std::swap(arr_size, other.arr_size);
         std::swap(data, other.data);
     }
@@ -89,7 +123,36 @@ struct ParallelArray {
     }
 
     ~ParallelArray() {
-        delete[] data;
+        operator delete[] (data);
+    }
+};
+
+template<typename T>
+struct ArrayView {
+    const T* data;
+    u64 arr_size;
+
+    ArrayView(const T* data, u64 arr_size) : data(data), arr_size(arr_size) {}
+
+    ArrayView(const ParallelArray<T>& arr) : data(arr.begin()), arr_size(arr.size()) {}
+
+    u64 size() const {
+        return arr_size;
+    }
+
+    const T& operator[](u64 id) const {
+        if (id >= arr_size) {
+            throw std::out_of_range("Array view id out of range");
+        }
+        return data[id];
+    }
+
+    const T* begin() const {
+        return data;
+    }
+
+    const T* end() const {
+        return data + arr_size;
     }
 };
 
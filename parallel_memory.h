@@ -0,0 +1,294 @@
+#ifndef __PARALLEL_MEMORY_H
+#define __PARALLEL_MEMORY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <omp.h>
+#include <type_traits>
+#include <unistd.h>
+
+#include "defs.h"
+#include "simd.h"
+
+/**
+ * INTERFACE:
+ *
+ * parallel_fill(T* data, uint64_t size, T value, uint32_t NUM_THREADS, MemoryStores stores) - data[i] = value
+ * parallel_zero(T* data, uint64_t size, NUM_THREADS, stores) - data[i] = 0
+ * parallel_iota(T* data, uint64_t size, T first, NUM_THREADS, stores) - data[i] = first + i
+ * parallel_copy(const T* source, T* destination, uint64_t size, NUM_THREADS, stores) - destination[i] = source[i]
+ * uint64_t non_temporal_threshold() - arrays of at least this many bytes are written with streaming stores
+ *
+ * T should be trivially copyable, source and destination shouldn't overlap
+ *
+ * DETAILS:
+ *
+ * Every thread writes a contiguous range that starts and ends on a page boundary, so no two threads
+ * write to the same page: with first touch every page lands on the NUMA node of the thread that
+ * writes it, and there is no false sharing at the edges of the ranges
+ * Small arrays are written by fewer threads, each one gets at least MIN_BYTES_PER_THREAD
+ *
+ * AUTO_STORES switches to non-temporal stores once the array doesn't fit in the last level cache:
+ * they write whole lines to memory without reading them first and don't evict the rest of the cache,
+ * which the array would push out anyway, smaller arrays use regular stores and stay in cache
+ * for whoever reads them next
+ *
+ * parallel_copy() is the exception, with AUTO_STORES it calls memcpy() on every range, which already
+ * switches to streaming stores on large copies and was faster than ours
+ *
+ * Streaming stores are the 16 byte SSE2 ones every x86-64 CPU has, wider stores don't add bandwidth,
+ * write combining merges stores into full lines either way
+ * They are used for element sizes of 1, 2, 4, 8 and 16 bytes and iota only streams integers,
+ * everything else uses regular stores
+ */
+enum MemoryStores {
+    AUTO_STORES,
+    REGULAR_STORES,
+    NON_TEMPORAL_STORES,
+    NUM_MEMORY_STORES
+};
+
+const char* const MEMORY_STORES_NAMES[NUM_MEMORY_STORES] = { "auto", "regular", "non_temporal" };
+
+const u64 MEMORY_PAGE_SIZE = 4096;
+const u64 MIN_BYTES_PER_THREAD = 1 << 16;
+const u64 STREAMING_STORE_SIZE = 16;
+
+/* Used if the size of the last level cache is unknown */
+const u64 DEFAULT_LAST_LEVEL_CACHE_SIZE = 32 << 20;
+
+u64 non_temporal_threshold() {
+    static const u64 threshold = []() {
+#ifdef _SC_LEVEL3_CACHE_SIZE
+        long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if (size > 0) return static_cast<u64>(size);
+#endif
+        return DEFAULT_LAST_LEVEL_CACHE_SIZE;
+    }();
+    return threshold;
+}
+
+bool use_non_temporal_stores(u64 bytes, MemoryStores stores) {
+    return stores == NON_TEMPORAL_STORES || (stores == AUTO_STORES && bytes >= non_temporal_threshold());
+}
+
+/* Splits [0, size) of data into one page aligned range per thread and calls chunk(begin, end) for each */
+template<typename T, typename Chunk>
+void for_each_page_chunk(const T* data, u64 size, u32 NUM_THREADS, Chunk chunk) {
+    if (size == 0) return;
+
+    u32 threads = std::max<u64>(1, std::min<u64>(NUM_THREADS, size * sizeof(T) / MIN_BYTES_PER_THREAD));
+
+    /* Elements before the first page boundary go to the first thread, the rest is split in whole pages */
+    u64 page_elements = 1;
+    u64 head = 0;
+    u64 misalignment = reinterpret_cast<uintptr_t>(data) % MEMORY_PAGE_SIZE;
+    if (MEMORY_PAGE_SIZE % sizeof(T) == 0 && misalignment % sizeof(T) == 0) {
+        page_elements = MEMORY_PAGE_SIZE / sizeof(T);
+        head = std::min(size, (MEMORY_PAGE_SIZE - misalignment) % MEMORY_PAGE_SIZE / sizeof(T));
+    }
+    u64 num_pages = (size - head) / page_elements;
+
+    #pragma omp parallel num_threads(threads) if(threads > 1)
+    {
+        u32 thread_num = omp_get_thread_num();
+        u32 num_threads = omp_get_num_threads();
+        u64 begin = thread_num == 0 ? 0 : head + num_pages * thread_num / num_threads * page_elements;
+        u64 end = thread_num + 1 == num_threads ? size : head + num_pages * (thread_num + 1) / num_threads * page_elements;
+
+        chunk(begin, end);
+    }
+}
+
+/* Writes out[i] = generate(i) for begin <= i < end with regular stores */
+template<typename T, typename Generator>
+void write_chunk(T* out, u64 begin, u64 end, Generator& generate) {
+    for (u64 i = begin; i < end; ++i) {
+        out[i] = generate(i);
+    }
+}
+
+#if HAS_X86_SIMD && defined(__SSE2__)
+#define HAS_STREAMING_STORES 1
+
+/* Whether streaming stores can write T, lanes of a store should be whole elements */
+template<typename T>
+constexpr bool can_stream() {
+    return STREAMING_STORE_SIZE % sizeof(T) == 0;
+}
+
+/**
+ * Same as write_chunk(), but whole aligned blocks of STREAMING_STORE_SIZE bytes are written with
+ * streaming stores, generate_block(i) should return out[i], ..., out[i + STREAMING_STORE_SIZE / sizeof(T) - 1]
+ * The block is built in registers: going through memory stalls on store forwarding
+ */
+template<typename T, typename Generator, typename BlockGenerator>
+void stream_chunk(T* out, u64 begin, u64 end, Generator& generate, BlockGenerator& generate_block) {
+    const u64 WIDTH = STREAMING_STORE_SIZE / sizeof(T);
+
+    u64 i = begin;
+    for (; i < end && reinterpret_cast<uintptr_t>(out + i) % STREAMING_STORE_SIZE != 0; ++i) {
+        out[i] = generate(i);
+    }
+
+    for (; i + WIDTH <= end; i += WIDTH) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(out + i), generate_block(i));
+    }
+
+    for (; i < end; ++i) {
+        out[i] = generate(i);
+    }
+
+    /* Streaming stores are weakly ordered, they should be visible once the threads join */
+    _mm_sfence();
+}
+
+/* Block of STREAMING_STORE_SIZE bytes with every element equal to value */
+template<typename T>
+__m128i broadcast_block(T value) {
+    T values[STREAMING_STORE_SIZE / sizeof(T)];
+    std::fill(values, values + STREAMING_STORE_SIZE / sizeof(T), value);
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+}
+
+/* Lane-wise a + b for integers of size of T */
+template<typename T>
+__m128i add_lanes(__m128i a, __m128i b) {
+    if constexpr (sizeof(T) == 1) return _mm_add_epi8(a, b);
+    else if constexpr (sizeof(T) == 2) return _mm_add_epi16(a, b);
+    else if constexpr (sizeof(T) == 4) return _mm_add_epi32(a, b);
+    else return _mm_add_epi64(a, b);
+}
+#endif
+
+template<typename T>
+void parallel_fill(T* data,
+                   u64 size,
+                   T value,
+                   u32 NUM_THREADS = omp_get_max_threads(),
+                   MemoryStores stores = AUTO_STORES) {
+    static_assert(std::is_trivially_copyable_v<T>, "parallel_fill() needs a trivially copyable type");
+
+    auto generate = [value](u64) {
+        return value;
+    };
+
+#ifdef HAS_STREAMING_STORES
+    if constexpr (can_stream<T>()) {
+        if (use_non_temporal_stores(size * sizeof(T), stores)) {
+            __m128i block = broadcast_block(value);
+            auto generate_block = [block](u64) {
+                return block;
+            };
+
+            for_each_page_chunk(data, size, NUM_THREADS, [&](u64 begin, u64 end) {
+                stream_chunk(data, begin, end, generate, generate_block);
+            });
+            return;
+        }
+    }
+#endif
+
+    for_each_page_chunk(data, size, NUM_THREADS, [&](u64 begin, u64 end) {
+        write_chunk(data, begin, end, generate);
+    });
+}
+
+template<typename T>
+void parallel_zero(T* data, u64 size, u32 NUM_THREADS = omp_get_max_threads(), MemoryStores stores = AUTO_STORES) {
+    static_assert(std::is_trivially_copyable_v<T>, "parallel_zero() needs a trivially copyable type");
+
+#ifdef HAS_STREAMING_STORES
+    if constexpr (can_stream<T>()) {
+        if (use_non_temporal_stores(size * sizeof(T), stores)) {
+            auto generate = [](u64) {
+                return T();
+            };
+            auto generate_block = [](u64) {
+                return _mm_setzero_si128();
+            };
+
+            for_each_page_chunk(data, size, NUM_THREADS, [&](u64 begin, u64 end) {
+                stream_chunk(data, begin, end, generate, generate_block);
+            });
+            return;
+        }
+    }
+#endif
+
+    for_each_page_chunk(data, size, NUM_THREADS, [&](u64 begin, u64 end) {
+        std::memset(static_cast<void*>(data + begin), 0, (end - begin) * sizeof(T));
+    });
+}
+
+template<typename T>
+void parallel_iota(T* data,
+                   u64 size,
+                   T first,
+                   u32 NUM_THREADS = omp_get_max_threads(),
+                   MemoryStores stores = AUTO_STORES) {
+    static_assert(std::is_trivially_copyable_v<T>, "parallel_iota() needs a trivially copyable type");
+
+    auto generate = [first](u64 i) {
+        return static_cast<T>(first + i);
+    };
+
+#ifdef HAS_STREAMING_STORES
+    if constexpr (can_stream<T>() && std::is_integral_v<T>) {
+        if (use_non_temporal_stores(size * sizeof(T), stores)) {
+            T offsets[STREAMING_STORE_SIZE / sizeof(T)];
+            for (u64 k = 0; k < STREAMING_STORE_SIZE / sizeof(T); ++k) {
+                offsets[k] = static_cast<T>(k);
+            }
+            __m128i offsets_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(offsets));
+
+            auto generate_block = [&](u64 i) {
+                return add_lanes<T>(broadcast_block(generate(i)), offsets_block);
+            };
+
+            for_each_page_chunk(data, size, NUM_THREADS, [&](u64 begin, u64 end) {
+                stream_chunk(data, begin, end, generate, generate_block);
+            });
+            return;
+        }
+    }
+#endif
+
+    for_each_page_chunk(data, size, NUM_THREADS, [&](u64 begin, u64 end) {
+        write_chunk(data, begin, end, generate);
+    });
+}
+
+template<typename T>
+void parallel_copy(const T* source,
+                   T* destination,
+                   u64 size,
+                   u32 NUM_THREADS = omp_get_max_threads(),
+                   MemoryStores stores = AUTO_STORES) {
+    static_assert(std::is_trivially_copyable_v<T>, "parallel_copy() needs a trivially copyable type");
+
+#ifdef HAS_STREAMING_STORES
+    if constexpr (can_stream<T>()) {
+        if (stores == NON_TEMPORAL_STORES) {
+            auto generate = [source](u64 i) {
+                return source[i];
+            };
+            auto generate_block = [source](u64 i) {
+                return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            };
+
+            for_each_page_chunk(destination, size, NUM_THREADS, [&](u64 begin, u64 end) {
+                stream_chunk(destination, begin, end, generate, generate_block);
+            });
+            return;
+        }
+    }
+#endif
+
+    for_each_page_chunk(destination, size, NUM_THREADS, [&](u64 begin, u64 end) {
+        std::memcpy(static_cast<void*>(destination + begin), source + begin, (end - begin) * sizeof(T));
+    });
+}
+
+#endif
@@ -10,30 +10,30 @@
 
 /**
 * INTERFACE:
-* RandomSequence(uint32_t size,
+* RandomSequence(uint64_t size,
                  uint32_t NUM_THREADS) - constructs a random sequence of given size using NUM_THREADS
-* uint32_t operator[i] const - ith number
+* uint32_t operator[i] const - ith number, sizes and ids are 64 bit like in ParallelArray
 */
 struct RandomSequence {
     const u32 NUM_THREADS;
     ParallelArray<u32> arr;
 
-    RandomSequence(u32 size, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS), arr(size) {
+    RandomSequence(u64 size, u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS), arr(size) {
         #pragma omp parallel shared(arr)
         {
             std::mt19937 gen(std::random_device{}());
             #pragma omp for
-            for (u32 i = 0; i < size; ++i) {
+            for (u64 i = 0; i < size; ++i) {
                 arr[i] = gen();
             }
         }
     }
 
-    u32 size() const {
+    u64 size() const {
         return arr.size();
     }
 
-    u32 operator[](u32 id) {
+    u32 operator[](u64 id) {
         return arr[id];
     }
 };
@@ -0,0 +1,288 @@
+#ifndef __PARALLEL_REDUCE_H
+#define __PARALLEL_REDUCE_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <omp.h>
+#include <type_traits>
+#include <vector>
+
+#include "defs.h"
+#include "parallel_array.h"
+
+/**
+ * INTERFACE:
+ *
+ * R parallel_transform_reduce(uint64_t begin,
+ *                             uint64_t end,
+ *                             R identity,
+ *                             Transform transform,
+ *                             Combine combine,
+ *                             uint32_t NUM_THREADS) - combine of transform(i) for begin <= i < end
+ * R parallel_transform_reduce(ParallelArray<T> arr, R identity, Transform transform, Combine combine, NUM_THREADS)
+ *     - the same over transform(arr[i])
+ * T parallel_reduce(ParallelArray<T> arr, T identity, Combine combine, NUM_THREADS) - combine of all elements
+ *
+ * R parallel_transform_sum(begin, end, Transform transform, SumMode mode, NUM_THREADS) - sum of transform(i)
+ * T parallel_sum(ParallelArray<T> arr, SumMode mode, NUM_THREADS) - sum of all elements
+ *
+ * combine defaults to + and should be associative and commutative with identity as its neutral element
+ * Pass transform and combine as lambdas, a function pointer is called indirectly and nothing gets vectorized
+ *
+ * DETAILS:
+ *
+ * Every thread reduces a contiguous block into a result padded to its own cache line, so threads
+ * never write to a shared line like local_sum in pi.cc does, then results are combined in thread order
+ * Every thread gets at least REDUCE_MIN_ELEMENTS_PER_THREAD elements, like in PrefixSum
+ *
+ * Inside a block there are REDUCE_UNROLL independent accumulators, element i goes to i % REDUCE_UNROLL
+ * A single accumulator is one long dependency chain the compiler can't break for floating point,
+ * separate ones fit in a vector register and the additions don't wait for each other
+ *
+ * Sums have a SumMode, it only matters for floating point:
+ * PLAIN_SUM - accumulators as above, the error grows linearly with the size
+ * KAHAN_SUM - Neumaier compensated summation in every accumulator, the error doesn't grow with the size,
+ *             it costs about four more additions per element
+ * PAIRWISE_SUM - blocks of PAIRWISE_BLOCK elements are summed plainly, then added up in a binary tree,
+ *                the error grows logarithmically and it is almost as fast as PLAIN_SUM
+ * DETERMINISTIC_SUM - see below
+ *
+ * In the first three modes the result depends on how the range is split between threads,
+ * so it changes with the number of threads
+ *
+ * DETERMINISTIC_SUM splits the range into blocks of DETERMINISTIC_BLOCK elements counted from begin,
+ * no matter how many threads there are, threads only decide who sums which block
+ * Block sums are written to an array and added up with pairwise_sum(), a fixed tree, so the result
+ * is bitwise identical at any thread count and on any machine running the same binary
+ * It doesn't hold across builds with -ffast-math or -ffp-contract=fast, which reorder or fuse additions
+ */
+const u32 REDUCE_UNROLL = 8;
+const u64 REDUCE_MIN_ELEMENTS_PER_THREAD = 16'384;
+const u64 PAIRWISE_BLOCK = 256;
+const u64 DETERMINISTIC_BLOCK = 4096;
+const u32 CACHE_LINE_SIZE = 64;
+
+enum SumMode {
+    PLAIN_SUM,
+    KAHAN_SUM,
+    PAIRWISE_SUM,
+    DETERMINISTIC_SUM,
+    NUM_SUM_MODES
+};
+
+const char* const SUM_MODE_NAMES[NUM_SUM_MODES] = { "plain", "kahan", "pairwise", "deterministic" };
+
+template<typename T>
+struct alignas(CACHE_LINE_SIZE) PaddedValue {
+    T value;
+};
+
+/* Neumaier's version of Kahan summation, it also handles terms larger than the sum */
+template<typename T>
+struct KahanAccumulator {
+    T sum = 0;
+    T compensation = 0;
+
+    void add(T x) {
+        T total = sum + x;
+        compensation += std::abs(sum) >= std::abs(x) ? (sum - total) + x : (x - total) + sum;
+        sum = total;
+    }
+
+    KahanAccumulator<T> merge(const KahanAccumulator<T>& other) const {
+        KahanAccumulator<T> result = { sum, compensation + other.compensation };
+        result.add(other.sum);
+        return result;
+    }
+
+    T result() const {
+        return sum + compensation;
+    }
+};
+
+u32 reduce_threads_for(u64 size, u32 max_threads) {
+    u64 threads = size / REDUCE_MIN_ELEMENTS_PER_THREAD;
+    return std::max<u64>(1, std::min<u64>(threads, max_threads));
+}
+
+/* Splits [begin, end) into one contiguous block per thread, block_reduce(l, r) reduces a block */
+template<typename R, typename BlockReduce, typename Combine>
+R reduce_blocks(u64 begin, u64 end, R identity, BlockReduce& block_reduce, Combine& combine, u32 NUM_THREADS) {
+    u32 threads = reduce_threads_for(end - begin, NUM_THREADS);
+    std::vector<PaddedValue<R>> partial(threads, { identity });
+
+    #pragma omp parallel num_threads(threads) if(threads > 1)
+    {
+        u32 thread_num = omp_get_thread_num();
+        u32 num_threads = omp_get_num_threads();
+        u64 l = begin + (end - begin) * thread_num / num_threads;
+        u64 r = begin + (end - begin) * (thread_num + 1) / num_threads;
+
+        partial[thread_num].value = block_reduce(l, r);
+    }
+
+    R result = identity;
+    for (const auto& p : partial) {
+        result = combine(result, p.value);
+    }
+    return result;
+}
+
+template<typename R, typename Transform, typename Combine>
+R unrolled_reduce(u64 begin, u64 end, R identity, Transform& transform, Combine& combine) {
+    R acc[REDUCE_UNROLL];
+    std::fill(acc, acc + REDUCE_UNROLL, identity);
+
+    u64 i = begin;
+    for (; i + REDUCE_UNROLL <= end; i += REDUCE_UNROLL) {
+        for (u32 k = 0; k < REDUCE_UNROLL; ++k) {
+            acc[k] = combine(acc[k], transform(i + k));
+        }
+    }
+    for (; i < end; ++i) {
+        acc[0] = combine(acc[0], transform(i));
+    }
+
+    for (u32 width = REDUCE_UNROLL / 2; width > 0; width /= 2) {
+        for (u32 k = 0; k < width; ++k) {
+            acc[k] = combine(acc[k], acc[k + width]);
+        }
+    }
+    return acc[0];
+}
+
+template<typename R, typename Transform>
+KahanAccumulator<R> unrolled_kahan_sum(u64 begin, u64 end, Transform& transform) {
+    KahanAccumulator<R> acc[REDUCE_UNROLL];
+
+    u64 i = begin;
+    for (; i + REDUCE_UNROLL <= end; i += REDUCE_UNROLL) {
+        for (u32 k = 0; k < REDUCE_UNROLL; ++k) {
+            acc[k].add(transform(i + k));
+        }
+    }
+    for (; i < end; ++i) {
+        acc[0].add(transform(i));
+    }
+
+    for (u32 width = REDUCE_UNROLL / 2; width > 0; width /= 2) {
+        for (u32 k = 0; k < width; ++k) {
+            acc[k] = acc[k].merge(acc[k + width]);
+        }
+    }
+    return acc[0];
+}
+
+template<typename R, typename Transform>
+R pairwise_sum(u64 begin, u64 end, Transform& transform) {
+    if (end - begin <= PAIRWISE_BLOCK) {
+        std::plus<R> plus;
+        return unrolled_reduce(begin, end, R(0), transform, plus);
+    }
+
+    u64 middle = begin + (end - begin) / 2;
+    return pairwise_sum<R>(begin, middle, transform) + pairwise_sum<R>(middle, end, transform);
+}
+
+template<typename R, typename Transform>
+R deterministic_sum(u64 begin, u64 end, Transform& transform, u32 NUM_THREADS) {
+    u64 num_blocks = (end - begin + DETERMINISTIC_BLOCK - 1) / DETERMINISTIC_BLOCK;
+    std::vector<R> block_sum(num_blocks);
+    u32 threads = reduce_threads_for(end - begin, NUM_THREADS);
+    std::plus<R> plus;
+
+    #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+    for (u64 block = 0; block < num_blocks; ++block) {
+        u64 l = begin + block * DETERMINISTIC_BLOCK;
+        u64 r = std::min(end, l + DETERMINISTIC_BLOCK);
+        block_sum[block] = unrolled_reduce(l, r, R(0), transform, plus);
+    }
+
+    const R* sums = block_sum.data();
+    auto block_value = [sums](u64 block) {
+        return sums[block];
+    };
+    return pairwise_sum<R>(0, num_blocks, block_value);
+}
+
+template<typename R, typename Transform, typename Combine = std::plus<R>>
+R parallel_transform_reduce(u64 begin,
+                            u64 end,
+                            R identity,
+                            Transform transform,
+                            Combine combine = Combine(),
+                            u32 NUM_THREADS = omp_get_max_threads()) {
+    auto block_reduce = [&](u64 l, u64 r) {
+        return unrolled_reduce(l, r, identity, transform, combine);
+    };
+    return reduce_blocks(begin, end, identity, block_reduce, combine, NUM_THREADS);
+}
+
+template<typename T, typename R, typename Transform, typename Combine = std::plus<R>>
+R parallel_transform_reduce(const ParallelArray<T>& arr,
+                            R identity,
+                            Transform transform,
+                            Combine combine = Combine(),
+                            u32 NUM_THREADS = omp_get_max_threads()) {
+    const T* data = arr.begin();
+    return parallel_transform_reduce(0, arr.size(), identity, [&](u64 i) {
+        return transform(data[i]);
+    }, combine, NUM_THREADS);
+}
+
+template<typename T, typename Combine = std::plus<T>>
+T parallel_reduce(const ParallelArray<T>& arr,
+                  T identity,
+                  Combine combine = Combine(),
+                  u32 NUM_THREADS = omp_get_max_threads()) {
+    const T* data = arr.begin();
+    return parallel_transform_reduce(0, arr.size(), identity, [data](u64 i) {
+        return data[i];
+    }, combine, NUM_THREADS);
+}
+
+template<typename Transform, typename R = std::decay_t<std::invoke_result_t<Transform&, u64>>>
+R parallel_transform_sum(u64 begin,
+                         u64 end,
+                         Transform transform,
+                         SumMode mode = PLAIN_SUM,
+                         u32 NUM_THREADS = omp_get_max_threads()) {
+    /* Integer sums are exact, every mode is the plain one */
+    if constexpr (std::is_floating_point_v<R>) {
+        if (mode == KAHAN_SUM) {
+            auto block_reduce = [&](u64 l, u64 r) {
+                return unrolled_kahan_sum<R>(l, r, transform);
+            };
+            auto merge = [](const KahanAccumulator<R>& a, const KahanAccumulator<R>& b) {
+                return a.merge(b);
+            };
+            return reduce_blocks(begin, end, KahanAccumulator<R>(), block_reduce, merge, NUM_THREADS).result();
+        }
+
+        if (mode == PAIRWISE_SUM) {
+            auto block_reduce = [&](u64 l, u64 r) {
+                return pairwise_sum<R>(l, r, transform);
+            };
+            std::plus<R> plus;
+            return reduce_blocks(begin, end, R(0), block_reduce, plus, NUM_THREADS);
+        }
+
+        if (mode == DETERMINISTIC_SUM) {
+            return deterministic_sum<R>(begin, end, transform, NUM_THREADS);
+        }
+    }
+
+    std::plus<R> plus;
+    return parallel_transform_reduce(begin, end, R(0), transform, plus, NUM_THREADS);
+}
+
+template<typename T>
+T parallel_sum(const ParallelArray<T>& arr, SumMode mode = PLAIN_SUM, u32 NUM_THREADS = omp_get_max_threads()) {
+    const T* data = arr.begin();
+    return parallel_transform_sum(0, arr.size(), [data](u64 i) {
+        return data[i];
+    }, mode, NUM_THREADS);
+}
+
+#endif
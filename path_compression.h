@@ -0,0 +1,19 @@
+#ifndef __PATH_COMPRESSION_H
+#define __PATH_COMPRESSION_H
+
+/**
+ * How find_root() shortens the path it walks
+ *
+ * FULL_COMPRESSION - a second pass points every node on the path to the root
+ * PATH_HALVING - every other node on the path is pointed to its grandparent
+ * PATH_SPLITTING - every node on the path is pointed to its grandparent
+ */
+enum PathCompression {
+    FULL_COMPRESSION,
+    PATH_HALVING,
+    PATH_SPLITTING
+};
+
+const char* const PATH_COMPRESSION_NAMES[] = { "full", "halving", "splitting" };
+
+#endif
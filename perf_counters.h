@@ -0,0 +1,185 @@
+#ifndef __PERF_COUNTERS_H
+#define __PERF_COUNTERS_H
+
+#include <linux/perf_event.h>
+#include <omp.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "defs.h"
+
+enum PerfEvent {
+    CYCLES_EVENT,
+    INSTRUCTIONS_EVENT,
+    LLC_MISSES_EVENT,
+    DTLB_MISSES_EVENT,
+    BRANCH_MISSES_EVENT,
+    NUM_PERF_EVENTS
+};
+
+const char* const PERF_EVENT_NAMES[NUM_PERF_EVENTS] = {
+    "cycles", "instructions", "llc_misses", "dtlb_misses", "branch_misses"
+};
+
+/**
+ * Values of all events summed over threads, supported[e] is false
+ * if the kernel or the CPU couldn't count event e
+ */
+struct PerfCounts {
+    u64 value[NUM_PERF_EVENTS];
+    bool supported[NUM_PERF_EVENTS];
+};
+
+/**
+ * INTERFACE:
+ *
+ * PerfCounters(uint32_t NUM_THREADS) - opens counters for every thread of a team of NUM_THREADS
+ * bool available() - checks if at least one event can be counted
+ * void start() - resets and enables all counters
+ * PerfCounts stop() - disables counters and returns their sums over all threads
+ *
+ * DETAILS:
+ *
+ * Counters are opened with perf_event_open for each OpenMP thread separately,
+ * inside a parallel region of NUM_THREADS threads, since counters opened by the
+ * master thread don't follow pool threads that already exist
+ * OpenMP keeps the same threads for the following regions of the same size,
+ * so counters opened here see the work of those regions
+ *
+ * Only user space is counted, this works with perf_event_paranoid <= 2
+ * Events that couldn't be opened on some thread are marked as unsupported,
+ * if the kernel multiplexes counters, their values are scaled by enabled / running time
+ *
+ * start() and stop() talk to counters of other threads from the calling thread,
+ * so they must be called outside of parallel regions
+ */
+struct PerfCounters {
+    const u32 NUM_THREADS;
+
+    /* fds[thread * NUM_PERF_EVENTS + event], -1 if unavailable */
+    std::vector<int> fds;
+    bool supported[NUM_PERF_EVENTS];
+
+    PerfCounters(u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
+                                                            fds(NUM_THREADS * NUM_PERF_EVENTS, -1) {
+        #pragma omp parallel num_threads(NUM_THREADS)
+        {
+            u32 thread = omp_get_thread_num();
+            for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+                fds[thread * NUM_PERF_EVENTS + event] = open_event(static_cast<PerfEvent>(event));
+            }
+        }
+
+        for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+            supported[event] = true;
+            for (u32 thread = 0; thread < NUM_THREADS; ++thread) {
+                supported[event] = supported[event] && fds[thread * NUM_PERF_EVENTS + event] != -1;
+            }
+        }
+
+        for (u32 thread = 0; thread < NUM_THREADS; ++thread) {
+            for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+                int& fd = fds[thread * NUM_PERF_EVENTS + event];
+                if (!supported[event] && fd != -1) {
+                    close(fd);
+                    fd = -1;
+                }
+            }
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+        for (int fd : fds) {
+            if (fd != -1) close(fd);
+        }
+    }
+
+    static int open_event(PerfEvent event) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const u64 READ_MISS = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+        switch (event) {
+            case CYCLES_EVENT:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case INSTRUCTIONS_EVENT:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case LLC_MISSES_EVENT:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_LL | READ_MISS;
+                break;
+            case DTLB_MISSES_EVENT:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_DTLB | READ_MISS;
+                break;
+            case BRANCH_MISSES_EVENT:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            default:
+                return -1;
+        }
+
+        /* pid = 0, cpu = -1: the calling thread on any CPU */
+        return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    bool available() const {
+        for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+            if (supported[event]) return true;
+        }
+        return false;
+    }
+
+    void start() {
+        for (int fd : fds) {
+            if (fd == -1) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    PerfCounts stop() {
+        for (int fd : fds) {
+            if (fd != -1) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+
+        PerfCounts counts;
+        for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+            counts.value[event] = 0;
+            counts.supported[event] = supported[event];
+        }
+
+        for (u32 thread = 0; thread < NUM_THREADS; ++thread) {
+            for (u32 event = 0; event < NUM_PERF_EVENTS; ++event) {
+                int fd = fds[thread * NUM_PERF_EVENTS + event];
+                if (fd == -1) continue;
+
+                /* value, time enabled, time running */
+                u64 data[3];
+                if (read(fd, data, sizeof(data)) != sizeof(data) || data[2] == 0) continue;
+
+                counts.value[event] += static_cast<u64>(static_cast<double>(data[0]) * data[1] / data[2]);
+            }
+        }
+
+        return counts;
+    }
+};
+
+#endif
@@ -1,20 +1,24 @@
+#include <cmath>
+#include <iomanip>
 #include <iostream>
 #include <omp.h>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "benchmark.h"
 #include "defs.h"
+#include "parallel_reduce.h"
 #include "timer.h"
 
 const u64 num_steps = 100'000'000;
 const long double delta = 1.0 / num_steps;
 
 // Bad version
-void par_pi_bad() {
+double par_pi_bad() {
     double res = 0;
     escape(&res);
 
-    std::cout << "Threads: " << omp_get_max_threads() << "\n";
     std::vector<long double> local_sum(omp_get_max_threads());
 
     #pragma omp parallel
@@ -31,16 +35,15 @@ void par_pi_bad() {
     }
 
     for (size_t i = 0; i < (size_t)omp_get_max_threads(); ++i) {
-        std::cout << "Thread no. " << i << " produced " << local_sum[i] << "\n";
         res += local_sum[i];
     }
 
     escape(&res);
-    std::cout << "Parallel " << res << "\n";
+    return res;
 }
 
 // Better version
-void par_pi_med() {
+double par_pi_med() {
     double res = 0;
     escape(&res);
 
@@ -62,11 +65,11 @@ void par_pi_med() {
     }
 
     escape(&res);
-    std::cout << "Parallel " << res << "\n";
+    return res;
 }
 
 // Incorrect version
-void par_pi_mistake() {
+double par_pi_mistake() {
     double res = 0;
     escape(&res);
 
@@ -76,10 +79,10 @@ void par_pi_mistake() {
     }
 
     escape(&res);
-    std::cout << "Parallel " << res << "\n";
+    return res;
 }
 
-void par_pi_good() {
+double par_pi_good() {
     double res = 0;
     escape(&res);
 
@@ -89,10 +92,24 @@ void par_pi_good() {
     }
 
     escape(&res);
-    std::cout << "Parallel " << res << "\n";
+    return res;
 }
 
-void seq_pi() {
+// A term in double, unlike long double it can be vectorized
+double pi_term(u64 step) {
+    double x = static_cast<double>(delta) * step;
+    return 4 / (1 + x * x) * static_cast<double>(delta);
+}
+
+double par_pi_reduce(SumMode mode) {
+    double res = parallel_transform_sum(0, num_steps, [](u64 step) {
+        return pi_term(step);
+    }, mode);
+    escape(&res);
+    return res;
+}
+
+long double seq_pi() {
     long double res = 0;
     escape(&res);
 
@@ -101,33 +118,70 @@ void seq_pi() {
     }
 
     escape(&res);
-    std::cout << "Sequential " << res << "\n";
+    return res;
 }
 
-int main() {
-    u64 seq_time, par_time;
-
-    {
-        u64 start_time = currentSeconds();
-        seq_pi();
-        u64 end_time = currentSeconds();
-        seq_time = end_time - start_time;
+/**
+ * Arguments are the same as in parse_benchmark_args(), e.g. threads=1,2,4,8 format=json
+ * par_pi_mistake() is racy, so it isn't measured
+ */
+int main(int argc, char* argv[]) {
+    Benchmark benchmark(parse_benchmark_args(argc, argv));
+    long double seq_result = 0;
+    double bad_result = 0, med_result = 0, good_result = 0;
+    double reduce_result[NUM_SUM_MODES] = {};
+    std::set<double> reduction_results, deterministic_results;
+
+    benchmark.run_sequential("pi/sequential", num_steps, [&]() {
+        seq_result = seq_pi();
+    });
+
+    benchmark.run("pi/parallel_false_sharing", num_steps, [&]() {
+        bad_result = par_pi_bad();
+    });
+
+    benchmark.run("pi/parallel_atomic", num_steps, [&]() {
+        med_result = par_pi_med();
+    });
+
+    benchmark.run("pi/parallel_reduction", num_steps, [&]() {
+        good_result = par_pi_good();
+        reduction_results.insert(good_result);
+    });
+
+    for (u32 mode = 0; mode < NUM_SUM_MODES; ++mode) {
+        benchmark.run(std::string("pi/parallel_reduce_") + SUM_MODE_NAMES[mode], num_steps, [&]() {
+            reduce_result[mode] = par_pi_reduce(static_cast<SumMode>(mode));
+            if (mode == DETERMINISTIC_SUM) deterministic_results.insert(reduce_result[mode]);
+        });
     }
 
-    std::cout << "\n-----\n\n";
+    benchmark.report();
 
-    {
-        u64 start_time = currentSeconds();
-        par_pi_good();
-        u64 end_time = currentSeconds();
-        par_time = end_time - start_time;
+    std::cerr << std::setprecision(15)
+              << "Sequential " << seq_result << "\n"
+              << "Parallel (false sharing) " << bad_result << "\n"
+              << "Parallel (atomic) " << med_result << "\n"
+              << "Parallel (reduction) " << good_result << "\n";
+    for (u32 mode = 0; mode < NUM_SUM_MODES; ++mode) {
+        std::cerr << "Parallel reduce (" << SUM_MODE_NAMES[mode] << ") " << reduce_result[mode]
+                  << ", differs from sequential by " << std::fabs(reduce_result[mode] - seq_result) << "\n";
     }
 
-    std::cout << "\n-----\n\n";
+    std::cerr << "Over all thread counts reduction(+:) gave " << reduction_results.size()
+              << " different results, the deterministic reduce gave " << deterministic_results.size() << "\n";
+
+    double seq_time = benchmark.find("pi/sequential", 1).median();
+    std::cerr << std::setprecision(3);
+    for (u32 threads : benchmark.config.threads) {
+        std::cerr << "Parallel is " << seq_time / benchmark.find("pi/parallel_reduction", threads).median()
+                  << " times faster with " << threads << " threads, parallel_reduce is "
+                  << seq_time / benchmark.find("pi/parallel_reduce_plain", threads).median() << " times faster\n";
+        std::cerr << "Deterministic reduce takes "
+                  << benchmark.find("pi/parallel_reduce_deterministic", threads).median() /
+                     benchmark.find("pi/parallel_reduce_plain", threads).median()
+                  << " times as long as the plain one with " << threads << " threads\n";
+    }
 
-    std::cout << "Sequential: " << seq_time << " ns\n"
-              << "Parallel: " << par_time << " ns\n"
-              << "Parallel is " << (double)seq_time / par_time << " times faster\n";
-    
     return 0;
-}
\ No newline at end of file
+}
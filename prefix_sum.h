@@ -1,74 +1,105 @@
 #ifndef __PREFIX_SUM_H
 #define __PREFIX_SUM_H
 
+#include <algorithm>
 #include <new>
 #include <omp.h>
 #include <stdexcept>
 #include <vector>
 
 #include "defs.h"
+#include "instrumentation.h"
 #include "parallel_array.h"
+#include "scan_kernels.h"
+#include "simd.h"
 
 /**
  * INTERFACE:
  * 
- * PrefixSum(uint32_t size, ParallelArray<u32> arr, uint32_t NUM_THREADS) - constructs an array of prefix sums using NUM_THREADS
- * uint32_t operator[i] - returns ith prefix sum = a[0] + ... + a[i]
+ * PrefixSum(uint64_t size,
+ *           const ParallelArray<T>& arr,
+ *           uint32_t NUM_THREADS,
+ *           SimdLevel level) - constructs an array of prefix sums using NUM_THREADS
+ * S operator[i] - returns ith prefix sum = a[0] + ... + a[i]
  * 
- * TODO: I may later add alignment to ParallelArray and use it here
- *       Also now that I think of it this should be a function, not a struct
+ * Every thread gets at least MIN_ELEMENTS_PER_THREAD elements, small arrays
+ * are summed by fewer threads or without a parallel region at all
+ *
+ * DETAILS:
+ *
+ * T is deduced from arr, so PrefixSum prefix(n, arr) works for u32, u64 and float arrays alike
+ * Sums are of type S, T by default, sizes are 64 bit, so PrefixSum<u32, u64> counts
+ * more than 2^32 flags without widening them first
+ *
+ * Each thread takes a contiguous block, first sums it, then, once sums of all blocks
+ * are known, scans it with its offset as the carry, so the output is written only once
+ * Both passes read arr, which is cheaper than writing prefix_sum twice, and the last
+ * block is never summed
+ *
+ * The scan is a kernel from scan_kernels.h, by default the best one this CPU supports
+ *
+ * TODO: this should be a function, not a struct
  */
+template<typename T = u32, typename S = T>
 struct PrefixSum {
+    static constexpr u32 MIN_ELEMENTS_PER_THREAD = 16'384;
+    static constexpr std::align_val_t ALIGNMENT = static_cast<std::align_val_t>(256);
+
     const u32 NUM_THREADS;
 
-    u32 arr_size;
-    u32* prefix_sum;
+    u64 arr_size;
+    S* prefix_sum;
 
-    PrefixSum(u32 arr_size,
-              ParallelArray<u32> arr,
-              u32 NUM_THREADS = omp_get_max_threads()) : NUM_THREADS(NUM_THREADS),
-                                                         arr_size(arr_size) {
+    PrefixSum(u64 arr_size,
+              const ParallelArray<T>& arr,
+              u32 NUM_THREADS = omp_get_max_threads(),
+              SimdLevel level = detect_simd_level()) : NUM_THREADS(threads_for(arr_size, NUM_THREADS)),
+                                                       arr_size(arr_size) {
 
-        prefix_sum = static_cast<u32*>(operator new[] (arr_size * sizeof(u32),                    // array size
-                                                       static_cast<std::align_val_t>(256)));  // alignment
+        prefix_sum = static_cast<S*>(operator new[] (arr_size * sizeof(S), ALIGNMENT));
+        INSTRUMENT_ALLOCATION(arr_size * sizeof(S));
 
-        std::vector<u32> thread_sum(NUM_THREADS);
+        std::vector<S> thread_sum(this->NUM_THREADS);
 
-        #pragma omp parallel num_threads(NUM_THREADS)
+        #pragma omp parallel num_threads(this->NUM_THREADS) if(this->NUM_THREADS > 1)
         {
             u32 thread_num = omp_get_thread_num();
-            u32 current_sum = 0;
+            u32 num_threads = omp_get_num_threads();
+            u64 block_size = (arr_size + num_threads - 1) / num_threads;
+            u64 begin = std::min(arr_size, thread_num * block_size);
+            u64 end = std::min(arr_size, begin + block_size);
 
-            #pragma omp for schedule(static) nowait
-            for (u32 i = 0; i < arr_size; ++i) {
-                current_sum += arr[i];
-                prefix_sum[i] = current_sum;
+            /* Nobody needs the sum of the last block, a single thread makes only one pass */
+            if (thread_num + 1 < num_threads) {
+                thread_sum[thread_num] = sum_kernel<T, S>(arr.begin() + begin, end - begin);
             }
-            thread_sum[thread_num] = current_sum;
             #pragma omp barrier
 
-            u32 offset = 0;
+            S offset = 0;
             for (u32 i = 0; i < thread_num; ++i) {
                 offset += thread_sum[i];
             }
 
-            // __builtin_assume_aligned(prefix_sum, 256);
-            #pragma omp for simd schedule(static)
-            for (u32 i = 0; i < arr_size; ++i) {
-                prefix_sum[i] += offset;
-            }
+            inclusive_scan_kernel(level, arr.begin() + begin, prefix_sum + begin, end - begin, offset);
         }
     }
 
-    u32 size() {
+    PrefixSum(const PrefixSum&) = delete;
+
+    static u32 threads_for(u64 arr_size, u32 max_threads) {
+        u64 threads = arr_size / MIN_ELEMENTS_PER_THREAD;
+        return std::max<u64>(1, std::min<u64>(threads, max_threads));
+    }
+
+    u64 size() {
         return arr_size;
     }
 
     ~PrefixSum() {
-        delete[] prefix_sum;
+        operator delete[] (prefix_sum, ALIGNMENT);
     }
 
-    u32 operator[](u32 id) {
+    S operator[](u64 id) {
         if (id >= arr_size) {
             throw std::out_of_range("Prefix sum index out of range");
         }
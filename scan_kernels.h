@@ -0,0 +1,214 @@
+#ifndef __SCAN_KERNELS_H
+#define __SCAN_KERNELS_H
+
+#include "defs.h"
+#include "simd.h"
+
+/**
+ * Inclusive scan kernels
+ *
+ * S inclusive_scan_kernel(level, in, out, size, carry) - out[i] = carry + in[0] + ... + in[i],
+ *     returns carry + the sum of all elements, so blocks can be chained
+ * S sum_kernel<T, S>(in, size) - in[0] + ... + in[size - 1]
+ *
+ * Elements are of type T and sums of type S, S is T unless sums may overflow it,
+ * e.g. counts of more than 2^32 u32 flags
+ *
+ * DETAILS:
+ *
+ * SIMD versions exist for u32, u64 and float when S is T, any other pair uses the scalar loop
+ * A vector is scanned in registers in log2(width) steps: it is added to itself
+ * shifted by 1, 2, 4, ... elements, then the carry (the last element of the previous
+ * vector, broadcast) is added and the new carry is broadcast from the last lane
+ *
+ * In the float kernels additions happen in a different order than in the scalar loop,
+ * so results may differ in the last bits, they are still the same from run to run
+ */
+template<typename T, typename S = T>
+S inclusive_scan_scalar(const T* in, S* out, u64 size, S carry) {
+    for (u64 i = 0; i < size; ++i) {
+        carry += in[i];
+        out[i] = carry;
+    }
+    return carry;
+}
+
+template<typename T, typename S = T>
+S sum_kernel(const T* in, u64 size) {
+    S sum = 0;
+    #pragma omp simd reduction(+:sum)
+    for (u64 i = 0; i < size; ++i) {
+        sum += in[i];
+    }
+    return sum;
+}
+
+#if HAS_X86_SIMD
+
+/* Moves lane sums of the lower 128 bit half into the upper one */
+__attribute__((target("avx2")))
+inline __m256i carry_lower_half_avx2(__m256i x) {
+    __m256i last = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm256_permute2x128_si256(last, last, 0x08);
+}
+
+__attribute__((target("avx2")))
+u32 inclusive_scan_u32_avx2(const u32* in, u32* out, u64 size, u32 carry) {
+    const u32 WIDTH = 8;
+    __m256i offset = _mm256_set1_epi32(carry);
+    __m256i last = _mm256_set1_epi32(7);
+
+    u64 i = 0;
+    for (; i + WIDTH <= size; i += WIDTH) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+        x = _mm256_add_epi32(x, carry_lower_half_avx2(x));
+        x = _mm256_add_epi32(x, offset);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+        offset = _mm256_permutevar8x32_epi32(x, last);
+    }
+
+    return inclusive_scan_scalar(in + i, out + i, size - i, static_cast<u32>(_mm256_extract_epi32(offset, 0)));
+}
+
+__attribute__((target("avx2")))
+u64 inclusive_scan_u64_avx2(const u64* in, u64* out, u64 size, u64 carry) {
+    const u32 WIDTH = 4;
+    __m256i offset = _mm256_set1_epi64x(carry);
+    __m256i zero = _mm256_setzero_si256();
+
+    u64 i = 0;
+    for (; i + WIDTH <= size; i += WIDTH) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(zero, _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 1, 0, 0)), 0xF0));
+        x = _mm256_add_epi64(x, offset);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+        offset = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    return inclusive_scan_scalar(in + i, out + i, size - i, static_cast<u64>(_mm256_extract_epi64(offset, 0)));
+}
+
+__attribute__((target("avx2")))
+float inclusive_scan_float_avx2(const float* in, float* out, u64 size, float carry) {
+    const u32 WIDTH = 8;
+    __m256 offset = _mm256_set1_ps(carry);
+    __m256i last = _mm256_set1_epi32(7);
+
+    u64 i = 0;
+    for (; i + WIDTH <= size; i += WIDTH) {
+        __m256 x = _mm256_loadu_ps(in + i);
+        x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 4)));
+        x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 8)));
+        x = _mm256_add_ps(x, _mm256_castsi256_ps(carry_lower_half_avx2(_mm256_castps_si256(x))));
+        x = _mm256_add_ps(x, offset);
+        _mm256_storeu_ps(out + i, x);
+        offset = _mm256_permutevar8x32_ps(x, last);
+    }
+
+    return inclusive_scan_scalar(in + i, out + i, size - i, _mm256_cvtss_f32(offset));
+}
+
+__attribute__((target("avx512f")))
+u32 inclusive_scan_u32_avx512(const u32* in, u32* out, u64 size, u32 carry) {
+    const u32 WIDTH = 16;
+    __m512i offset = _mm512_set1_epi32(carry);
+    __m512i zero = _mm512_setzero_si512();
+    __m512i last = _mm512_set1_epi32(15);
+
+    u64 i = 0;
+    for (; i + WIDTH <= size; i += WIDTH) {
+        __m512i x = _mm512_loadu_si512(in + i);
+        x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 15));
+        x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 14));
+        x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 12));
+        x = _mm512_add_epi32(x, _mm512_alignr_epi32(x, zero, 8));
+        x = _mm512_add_epi32(x, offset);
+        _mm512_storeu_si512(out + i, x);
+        offset = _mm512_permutexvar_epi32(last, x);
+    }
+
+    return inclusive_scan_scalar(in + i, out + i, size - i, static_cast<u32>(_mm512_cvtsi512_si32(offset)));
+}
+
+__attribute__((target("avx512f")))
+u64 inclusive_scan_u64_avx512(const u64* in, u64* out, u64 size, u64 carry) {
+    const u32 WIDTH = 8;
+    __m512i offset = _mm512_set1_epi64(carry);
+    __m512i zero = _mm512_setzero_si512();
+    __m512i last = _mm512_set1_epi64(7);
+
+    u64 i = 0;
+    for (; i + WIDTH <= size; i += WIDTH) {
+        __m512i x = _mm512_loadu_si512(in + i);
+        x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 7));
+        x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 6));
+        x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 4));
+        x = _mm512_add_epi64(x, offset);
+        _mm512_storeu_si512(out + i, x);
+        offset = _mm512_permutexvar_epi64(last, x);
+    }
+
+    return inclusive_scan_scalar(in + i, out + i, size - i,
+                                 static_cast<u64>(_mm_cvtsi128_si64(_mm512_castsi512_si128(offset))));
+}
+
+__attribute__((target("avx512f")))
+float inclusive_scan_float_avx512(const float* in, float* out, u64 size, float carry) {
+    const u32 WIDTH = 16;
+    __m512 offset = _mm512_set1_ps(carry);
+    __m512i zero = _mm512_setzero_si512();
+    __m512i last = _mm512_set1_epi32(15);
+
+    u64 i = 0;
+    for (; i + WIDTH <= size; i += WIDTH) {
+        __m512 x = _mm512_loadu_ps(in + i);
+        x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(x), zero, 15)));
+        x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(x), zero, 14)));
+        x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(x), zero, 12)));
+        x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(x), zero, 8)));
+        x = _mm512_add_ps(x, offset);
+        _mm512_storeu_ps(out + i, x);
+        offset = _mm512_permutexvar_ps(last, x);
+    }
+
+    return inclusive_scan_scalar(in + i, out + i, size - i, _mm512_cvtss_f32(offset));
+}
+
+#endif
+
+template<typename T, typename S>
+S inclusive_scan_kernel(SimdLevel, const T* in, S* out, u64 size, S carry) {
+    return inclusive_scan_scalar(in, out, size, carry);
+}
+
+template<>
+u32 inclusive_scan_kernel(SimdLevel level, const u32* in, u32* out, u64 size, u32 carry) {
+#if HAS_X86_SIMD
+    if (level == AVX512_LEVEL) return inclusive_scan_u32_avx512(in, out, size, carry);
+    if (level == AVX2_LEVEL) return inclusive_scan_u32_avx2(in, out, size, carry);
+#endif
+    return inclusive_scan_scalar(in, out, size, carry);
+}
+
+template<>
+u64 inclusive_scan_kernel(SimdLevel level, const u64* in, u64* out, u64 size, u64 carry) {
+#if HAS_X86_SIMD
+    if (level == AVX512_LEVEL) return inclusive_scan_u64_avx512(in, out, size, carry);
+    if (level == AVX2_LEVEL) return inclusive_scan_u64_avx2(in, out, size, carry);
+#endif
+    return inclusive_scan_scalar(in, out, size, carry);
+}
+
+template<>
+float inclusive_scan_kernel(SimdLevel level, const float* in, float* out, u64 size, float carry) {
+#if HAS_X86_SIMD
+    if (level == AVX512_LEVEL) return inclusive_scan_float_avx512(in, out, size, carry);
+    if (level == AVX2_LEVEL) return inclusive_scan_float_avx2(in, out, size, carry);
+#endif
+    return inclusive_scan_scalar(in, out, size, carry);
+}
+
+#endif
@@ -1,27 +1,88 @@
 #ifndef __SEQUENTIAL_DSU_H
 #define __SEQUENTIAL_DSU_H
 
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
 #include "defs.h"
+#include "path_compression.h"
 
+/**
+ * INTERFACE:
+ *
+ * SequentialDSU(uint32_t N, PathCompression compression) - constructs a DSU of size N
+ * uint32_t size() - number of nodes
+ * uint32_t find_root(uint32_t id) - finds root node of id
+ * bool same_set(uint32_t id1, uint32_t id2) - checks if id1 and id2 are in the same set
+ * bool unite(uint32_t id1, uint32_t id2) - unites sets of id1 and id2, returns false if they were already united
+ *
+ * DETAILS:
+ *
+ * The sequential baseline for all concurrent DSUs, so it should be the best one we can write:
+ * union by rank and path compression, which gives O(\alpha N) amortized time per query
+ *
+ * Ranks never exceed log2(N) < 32, so they take a byte, and they are interleaved with
+ * parents in a single packed array of 5 byte nodes, so a step of find_root touches one cache line
+ *
+ * Unlike the concurrent DSUs it can be copied, e.g. to branch from a partially united state
+ */
 struct SequentialDSU {
-    u32 size;
-    u32* parent;
-    u32* rank;
-
-    SequentialDSU(u32 size) : size(size) {
-        rank = new u32[size];
-        parent = new u32[size];
-        for (u32 i = 0; i < size; ++i) parent[i] = i;
+    struct __attribute__((packed)) Node {
+        u32 parent;
+        u8 rank;
+    };
+
+    PathCompression compression;
+    std::vector<Node> nodes;
+
+    SequentialDSU(u32 size, PathCompression compression = PATH_HALVING) : compression(compression),
+                                                                           nodes(size) {
+        if (size == 0) {
+            throw std::invalid_argument("DSU size cannot be zero");
+        }
+
+        for (u32 i = 0; i < size; ++i) {
+            nodes[i] = { i, 0 };
+        }
+    }
+
+    u32 size() const {
+        return nodes.size();
     }
 
-    ~SequentialDSU() {
-        delete[] parent;
-        delete[] rank;
+    u32 get_parent(u32 id) const {
+        return nodes[id].parent;
     }
 
     u32 find_root(u32 id) {
-        while (id != parent[id]) {
-            id = parent[id];
+        if (compression == FULL_COMPRESSION) {
+            u32 root = id;
+            while (root != nodes[root].parent) root = nodes[root].parent;
+
+            while (id != root) {
+                u32 next = nodes[id].parent;
+                nodes[id].parent = root;
+                id = next;
+            }
+
+            return root;
+        }
+
+        if (compression == PATH_HALVING) {
+            while (id != nodes[id].parent) {
+                u32 grandparent = nodes[nodes[id].parent].parent;
+                nodes[id].parent = grandparent;
+                id = grandparent;
+            }
+
+            return id;
+        }
+
+        while (id != nodes[id].parent) {
+            u32 next = nodes[id].parent;
+            nodes[id].parent = nodes[next].parent;
+            id = next;
         }
 
         return id;
@@ -31,14 +92,17 @@ struct SequentialDSU {
         return find_root(id1) == find_root(id2);
     }
 
-    void unite(u32 id1, u32 id2) {
+    bool unite(u32 id1, u32 id2) {
         id1 = find_root(id1);
         id2 = find_root(id2);
 
-        if (rank[id1] < rank[id2]) std::swap(id1, id2);
+        if (id1 == id2) return false;
+
+        if (nodes[id1].rank < nodes[id2].rank) std::swap(id1, id2);
 
-        parent[id2] = id1;
-        if (rank[id1] == rank[id2]) ++rank[id1];
+        nodes[id2].parent = id1;
+        if (nodes[id1].rank == nodes[id2].rank) ++nodes[id1].rank;
+        return true;
     }
 };
 
@@ -2,37 +2,64 @@
 #define __SEQUENTIAL_MST_H
 
 #include <algorithm>
+#include <limits>
+#include <tuple>
 #include <vector>
 
 #include "graph.h"
 #include "parallel_array.h"
 #include "sequential_dsu.h"
 
+/**
+ * Boruvka's algorithm on a single thread, the baseline for BoruvkaMST
+ *
+ * The first round reads the input graph through its view,
+ * later rounds work on contracted nodes and edges of its own
+ * W and I are the weight and node id types, see BoruvkaMST
+ */
+template<typename W = u32, typename I = u32>
 struct SequentialMST {
-    ParallelArray<Edge> calculate_mst(Graph graph) {
+    using EdgeType = BasicEdge<W, I>;
+    using GraphViewType = BasicGraphView<W, I>;
+
+    static constexpr u32 NO_EDGE = std::numeric_limits<u32>::max();
+
+    /**
+     * Ties between equal weights are broken by the end nodes, the same way from both of them,
+     * breaking them by position let equal weights close a cycle once edges were contracted
+     */
+    static bool lighter(const EdgeType& a, const EdgeType& b) {
+        return std::make_tuple(a.weight, std::min<u32>(a.from, a.to), std::max<u32>(a.from, a.to)) <
+               std::make_tuple(b.weight, std::min<u32>(b.from, b.to), std::max<u32>(b.from, b.to));
+    }
+
+    ParallelArray<EdgeType> calculate_mst(GraphViewType graph) {
         SequentialDSU node_sets(graph.num_nodes());
-        ParallelArray<Edge> mst(graph.num_nodes() - 1);
+        ParallelArray<EdgeType> mst(graph.num_nodes() - 1);
         u32 current_mst_size = 0;
         u32 initial_num_nodes = graph.num_nodes();
 
+        std::vector<I> nodes;
+        std::vector<EdgeType> edges;
+
         while (graph.num_nodes() != 1) {
-            std::vector<std::pair<u32, u32>> shortest_edges(initial_num_nodes, 
-                                                           { 0, std::numeric_limits<u32>::max() });
+            std::vector<u32> shortest_edges(initial_num_nodes, NO_EDGE);
 
             for (u32 i = 0; i < graph.num_edges(); ++i) {
-                const Edge& e = graph.edges[i];
+                const EdgeType& e = graph.edges[i];
+                u32& shortest = shortest_edges[e.from];
 
-                if (shortest_edges[e.from].second > e.weight) {
-                    shortest_edges[e.from] = { i, e.weight };
+                if (shortest == NO_EDGE || lighter(e, graph.edges[shortest])) {
+                    shortest = i;
                 }
             }
 
             for (u32 i = 0; i < graph.num_nodes(); ++i) {
                 u32 u = graph.nodes[i];
-                const Edge& min_edge_u = graph.edges[shortest_edges[u].first];
+                const EdgeType& min_edge_u = graph.edges[shortest_edges[u]];
 
                 u32 v = min_edge_u.to;
-                const Edge& min_edge_v = graph.edges[shortest_edges[v].first];
+                const EdgeType& min_edge_v = graph.edges[shortest_edges[v]];
                 
                 if (min_edge_v.to != u || (min_edge_v.to == u && u < v)) {
                     node_sets.unite(u, v);
@@ -40,35 +67,79 @@ struct SequentialMST {
                 }
             }
 
-            std::vector<Edge> new_edges;
+            std::vector<EdgeType> new_edges;
             for (u32 i = 0; i < graph.num_edges(); ++i) {
                 if (!node_sets.same_set(graph.edges[i].from, graph.edges[i].to)) {
-                    Edge e = graph.edges[i];
+                    EdgeType e = graph.edges[i];
                     e.from = node_sets.find_root(e.from);
                     e.to = node_sets.find_root(e.to);
                     new_edges.push_back(e);
                 }
             }
 
-            std::vector<u32> new_nodes;
+            std::vector<I> new_nodes;
             for (u32 i = 0; i < graph.num_nodes(); ++i) {
                 if (node_sets.find_root(graph.nodes[i]) == graph.nodes[i]) {
                     new_nodes.push_back(graph.nodes[i]);
                 }
             }
 
-            graph.nodes = ParallelArray<u32>(new_nodes.size());
-            graph.edges = ParallelArray<Edge>(new_edges.size());
+            nodes.swap(new_nodes);
+            edges.swap(new_edges);
+            graph = GraphViewType(ArrayView<I>(nodes.data(), nodes.size()), ArrayView<EdgeType>(edges.data(), edges.size()));
+        }
+
+        return mst;
+    }
+};
+
+/**
+ * Kruskal's algorithm on a single thread
+ * It has no per round overhead, so it beats Boruvka rounds on small graphs
+ */
+template<typename W = u32, typename I = u32>
+struct KruskalMST {
+    using EdgeType = BasicEdge<W, I>;
+    using GraphViewType = BasicGraphView<W, I>;
 
-            for (u32 i = 0; i < new_nodes.size(); ++i) {
-                graph.nodes[i] = new_nodes[i];
+    /**
+     * Returns ids of minimum spanning forest edges in graph.edges,
+     * only the direction with from < to of each edge is returned
+     */
+    ParallelArray<u32> calculate_mst_ids(GraphViewType graph) {
+        std::vector<u32> order;
+        for (u32 i = 0; i < graph.num_edges(); ++i) {
+            if (graph.edges[i].from < graph.edges[i].to) {
+                order.push_back(i);
             }
+        }
+
+        std::sort(order.begin(), order.end(), [&graph](u32 a, u32 b) {
+            return std::tie(graph.edges[a].weight, a) < std::tie(graph.edges[b].weight, b);
+        });
 
-            for (u32 i = 0; i < new_edges.size(); ++i) {
-                graph.edges[i] = new_edges[i];
+        SequentialDSU node_sets(graph.num_nodes());
+        std::vector<u32> mst_buffer;
+        for (u32 id : order) {
+            if (node_sets.unite(graph.edges[id].from, graph.edges[id].to)) {
+                mst_buffer.push_back(id);
             }
         }
 
+        ParallelArray<u32> mst_ids(mst_buffer.size(), 1);
+        std::copy(mst_buffer.begin(), mst_buffer.end(), mst_ids.begin());
+
+        return mst_ids;
+    }
+
+    ParallelArray<EdgeType> calculate_mst(GraphViewType graph) {
+        ParallelArray<u32> mst_ids = calculate_mst_ids(graph);
+        ParallelArray<EdgeType> mst(mst_ids.size(), 1);
+
+        for (u32 i = 0; i < mst_ids.size(); ++i) {
+            mst[i] = graph.edges[mst_ids[i]];
+        }
+
         return mst;
     }
 };
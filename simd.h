@@ -0,0 +1,53 @@
+#ifndef __SIMD_H
+#define __SIMD_H
+
+#include "defs.h"
+
+/**
+ * Instruction sets hand-written kernels are compiled for
+ *
+ * Kernels are built with __attribute__((target(...))), so the rest of the code
+ * doesn't need -mavx2 and the binary still runs on older CPUs,
+ * a kernel is picked at runtime with detect_simd_level()
+ */
+enum SimdLevel {
+    SCALAR_LEVEL,
+    AVX2_LEVEL,
+    AVX512_LEVEL,
+    NUM_SIMD_LEVELS
+};
+
+const char* const SIMD_LEVEL_NAMES[NUM_SIMD_LEVELS] = { "scalar", "avx2", "avx512" };
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HAS_X86_SIMD 1
+/* GCC 12 headers make undefined vectors with self-initialization, which -Wall reports at every inlined use */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#else
+#define HAS_X86_SIMD 0
+#endif
+
+/* The best level this CPU supports, cpuid is only asked once */
+SimdLevel detect_simd_level() {
+#if HAS_X86_SIMD
+    static const SimdLevel level = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return AVX512_LEVEL;
+        if (__builtin_cpu_supports("avx2")) return AVX2_LEVEL;
+        return SCALAR_LEVEL;
+    }();
+    return level;
+#else
+    return SCALAR_LEVEL;
+#endif
+}
+
+bool simd_level_supported(SimdLevel level) {
+    return level <= detect_simd_level();
+}
+
+#endif
@@ -5,6 +5,7 @@
 
 #include "benchmark.h"
 #include "defs.h"
+#include "parallel_reduce.h"
 #include "timer.h"
 
 std::random_device rd;
@@ -50,63 +51,63 @@ u64 par_sum(std::vector<u64>& v) {
     return res;
 }
 
+// Per-thread accumulators on separate cache lines and an unrolled inner loop
+u64 par_reduce_sum(std::vector<u64>& v) {
+    const u64* data = v.data();
+    return parallel_transform_sum(0, v.size(), [data](u64 i) {
+        return data[i];
+    });
+}
+
 u64 seq_sum(std::vector<u64>& v) {
     u64 res = 0;
     for (auto x : v) res += x;
     return res;
 }
 
-int main() {
-    const size_t NUM_CYCLES = 10;
-    const size_t CYCLE_STOP = NUM_CYCLES / 10;
-
-    u64 par_time = 0;
-    u64 seq_time = 0;
-
-    std::cout << "Start\n" << "Threads: " << omp_get_max_threads() << "\n\n";
-
-    for (size_t cycle = 1; cycle <= NUM_CYCLES; ++cycle) {
-        std::vector<u64> data = init_data();
-        u64 par_result, seq_result;
-
-        {
-            escape(&data);
-            u64 start_time = currentSeconds();
-            par_result = par_sum(data);
-            u64 end_time = currentSeconds();
-            par_time += (end_time - start_time);
-            escape(&par_result);
-        }
-
-        {
-            escape(&data);
-            u64 start_time = currentSeconds();
-            seq_result = seq_sum(data);
-            u64 end_time = currentSeconds();
-            seq_time += (end_time - start_time);
-            escape(&seq_result);
-        }
-
-        if (par_result != seq_result) {
-            std::cerr << std::fixed
-                      << "Parallel result is not equal to sequential result:\n"
-                      << "Parallel: " << par_result << "\n"
-                      << "Sequential: " << seq_result << "\n";
-            exit(-1);
-        }
-
-        if (cycle % CYCLE_STOP == 0) {
-            std::cout << std::fixed
-                      << "Step " << cycle / CYCLE_STOP << " of 10:\n"
-                      << "Parallel time: " << par_time / cycle << " ns\n"
-                      << "Sequential time: " << seq_time / cycle << " ns\n\n";
-        }
+/**
+ * Arguments are the same as in parse_benchmark_args(), e.g. threads=1,2,4,8 format=json
+ */
+int main(int argc, char* argv[]) {
+    Benchmark benchmark(parse_benchmark_args(argc, argv));
+    std::vector<u64> data = init_data();
+    u64 par_result = 0, reduce_result = 0, seq_result = 0;
+
+    benchmark.run("sum/parallel", data.size(), [&]() {
+        escape(&data);
+        par_result = par_sum(data);
+        escape(&par_result);
+    });
+
+    benchmark.run("sum/parallel_reduce", data.size(), [&]() {
+        escape(&data);
+        reduce_result = par_reduce_sum(data);
+        escape(&reduce_result);
+    });
+
+    benchmark.run_sequential("sum/sequential", data.size(), [&]() {
+        escape(&data);
+        seq_result = seq_sum(data);
+        escape(&seq_result);
+    });
+
+    if (par_result != seq_result || reduce_result != seq_result) {
+        std::cerr << std::fixed
+                  << "Parallel result is not equal to sequential result:\n"
+                  << "Parallel: " << par_result << "\n"
+                  << "Parallel reduce: " << reduce_result << "\n"
+                  << "Sequential: " << seq_result << "\n";
+        exit(-1);
+    }
+
+    benchmark.report();
+
+    double seq_time = benchmark.find("sum/sequential", 1).median();
+    for (u32 threads : benchmark.config.threads) {
+        std::cerr << "Parallelized function is " << seq_time / benchmark.find("sum/parallel", threads).median()
+                  << " times faster with " << threads << " threads, parallel_reduce is "
+                  << seq_time / benchmark.find("sum/parallel_reduce", threads).median() << " times faster\n";
     }
 
-    std::cout << std::fixed
-              << "Final results:\n"
-              << "Parallel time: " << par_time / NUM_CYCLES << " ns\n"
-              << "Sequential time: " << seq_time / NUM_CYCLES << " ns\n"
-              << "Parallelized function is " << (double)seq_time / par_time << " times faster.\n\n";
     return 0;
 }
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <limits>
+#include <omp.h>
+#include <vector>
+
+#include "../batched_mst.h"
+#include "../benchmark.h"
+#include "../boruvka.h"
+#include "../graph.h"
+
+const u32 NUM_ITER = 3;
+const u32 NUM_SMALL_GRAPHS = 1'000;
+const u32 MIN_SMALL_N = 50;
+const u32 MAX_SMALL_N = 5'000;
+const u32 NUM_LARGE_GRAPHS = 2;
+const u32 LARGE_N = 200'000;
+const u32 EDGES_PER_NODE = 5;
+
+/**
+ * Runs calculate on the whole batch NUM_ITER times and prints throughput
+ * Returns total weight of all forests to compare the engines
+ */
+template<typename F>
+u64 measure(const std::string& name, u32 num_graphs, F calculate) {
+    u64 total_weight = 0;
+    double total_time = 0;
+
+    for (u32 iter = 1; iter <= NUM_ITER; ++iter) {
+        double start = omp_get_wtime();
+        total_weight = calculate();
+        double finish = omp_get_wtime();
+        escape(&total_weight);
+
+        total_time += finish - start;
+    }
+
+    double avg_time = total_time / NUM_ITER;
+    std::cout << std::fixed << name << ": " << avg_time << " s, "
+              << num_graphs / avg_time << " graphs/s\n";
+
+    return total_weight;
+}
+
+int main() {
+    std::cout << "Threads: " << omp_get_max_threads() << "\n";
+
+    std::vector<Graph> graphs;
+    for (u32 i = 0; i < NUM_SMALL_GRAPHS; ++i) {
+        u32 n = randint(MIN_SMALL_N, MAX_SMALL_N);
+        graphs.push_back(generate_graph(n, n * EDGES_PER_NODE));
+    }
+    for (u32 i = 0; i < NUM_LARGE_GRAPHS; ++i) {
+        graphs.push_back(generate_graph(LARGE_N, LARGE_N * EDGES_PER_NODE));
+    }
+
+    std::cout << graphs.size() << " graphs generated\n";
+
+    u64 boruvka_weight = measure("BoruvkaMST one by one", graphs.size(), [&graphs]() {
+        BoruvkaMST boruvka;
+        u64 weight = 0;
+        for (const Graph& graph : graphs) {
+            auto mst_ids = boruvka.calculate_mst_ids(graph);
+            for (u32 id : mst_ids) weight += graph.edges[id].weight;
+        }
+        return weight;
+    });
+
+    std::vector<std::pair<std::string, u32>> thresholds = {
+        { "BatchedMST, everything parallel", 0 },
+        { "BatchedMST, threshold 10000", 10'000 },
+        { "BatchedMST, default threshold", BatchedMST::DEFAULT_SEQUENTIAL_THRESHOLD },
+        { "BatchedMST, threshold 1000000", 1'000'000 },
+        { "BatchedMST, everything sequential", std::numeric_limits<u32>::max() }
+    };
+
+    for (const auto& p : thresholds) {
+        u32 threshold = p.second;
+        u64 batched_weight = measure(p.first, graphs.size(), [&graphs, threshold]() {
+            BatchedMST batched(threshold);
+            MSTBatch batch = batched.calculate_msts(graphs);
+
+            u64 weight = 0;
+            for (u32 i = 0; i < batch.num_graphs(); ++i) weight += batch.weight(i);
+            return weight;
+        });
+
+        if (batched_weight != boruvka_weight) {
+            std::cerr << "Weights don't match!\nCorrect: " << boruvka_weight << "\nIncorrect: " << batched_weight << "\n";
+            exit(-1);
+        }
+    }
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <omp.h>
+#include <string>
 
 #include "../benchmark.h"
 #include "../boruvka.h"
@@ -10,52 +11,41 @@ const u32 NUM_ITER = 20;
 const u32 MAX_N = 1'000'000;
 const u32 STEP = 200'000;
 
-int main() {
+/**
+ * Arguments are the same as in parse_benchmark_args(), e.g. threads=1,2,4,8 format=json
+ */
+int main(int argc, char* argv[]) {
+    BenchmarkConfig defaults;
+    defaults.repetitions = NUM_ITER;
+    Benchmark benchmark(parse_benchmark_args(argc, argv, defaults));
+
     BoruvkaMST boruvka;
     SequentialMST sequential_mst;
 
-    std::cout << omp_get_max_threads() << "\n";
-
     for (u32 n = STEP; n <= MAX_N; n += STEP) {
-            u32 avg_par_time = 0;
-            u32 avg_seq_time = 0;
-
-            u32 m = n * 20;
-            Graph G = generate_graph(n, m);
-
-            for (u32 iter = 1; iter <= NUM_ITER; ++iter) {
-                // std::cout << "Iter no. " << iter << "\n";
-                
-                {
-                    escape(&G);
-                    u64 start = currentSeconds();
-
-                    auto mst = boruvka.calculate_mst(G);
-
-                    u64 finish = currentSeconds();
-                    escape(&mst);
-
-                    avg_par_time += finish - start;
-                }
-                // std::cout << "Parallel mst finished\n";
-                
-                {
-                    escape(&G);
-                    u64 start = currentSeconds();
-
-                    auto mst = sequential_mst.calculate_mst(G);
-
-                    u64 finish = currentSeconds();
-                    escape(&mst);
-
-                    avg_seq_time += finish - start;
-                }
-                // std::cout << "Sequential mst finished\n";
-            }
+        u32 m = n * 20;
+        Graph G = generate_graph(n, m);
+
+        benchmark.run("mst/boruvka/n=" + std::to_string(n), G.num_edges(), [&]() {
+            escape(&G);
+            auto mst = boruvka.calculate_mst(G);
+            escape(&mst);
+        });
+
+        benchmark.run_sequential("mst/sequential/n=" + std::to_string(n), G.num_edges(), [&]() {
+            escape(&G);
+            auto mst = sequential_mst.calculate_mst(G);
+            escape(&mst);
+        });
+    }
 
-            avg_par_time /= NUM_ITER;
-            avg_seq_time /= NUM_ITER;
+    benchmark.report();
 
-            std::cout << n << " " << avg_par_time << " " << avg_seq_time << " " << static_cast<double>(avg_seq_time) / avg_par_time << "\n";
+    for (u32 n = STEP; n <= MAX_N; n += STEP) {
+        double seq_time = benchmark.find("mst/sequential/n=" + std::to_string(n), 1).median();
+        for (u32 threads : benchmark.config.threads) {
+            double par_time = benchmark.find("mst/boruvka/n=" + std::to_string(n), threads).median();
+            std::cerr << n << " " << threads << " threads: " << seq_time / par_time << " times faster\n";
+        }
     }
 }
@@ -0,0 +1,77 @@
+/**
+ * Per round statistics need instrumentation, add "json" argument
+ * to get them as JSON instead of CSV
+ */
+#define ENABLE_INSTRUMENTATION
+
+#include <iostream>
+#include <omp.h>
+#include <string>
+#include <vector>
+
+#include "../benchmark.h"
+#include "../boruvka.h"
+#include "../graph.h"
+
+const u32 NUM_ITER = 10;
+const u32 N = 1'000'000;
+const u32 M = 10'000'000;
+
+/**
+ * Runs BoruvkaMST with different sequential cutoffs on the same graph
+ * and prints average time and the per round breakdown of the last run
+ */
+int main(int argc, char* argv[]) {
+    bool json = (argc > 1 && std::string(argv[1]) == "json");
+
+    std::cout << "Threads: " << omp_get_max_threads() << "\n";
+
+    Graph G = generate_graph(N, M);
+
+    std::vector<u32> cutoffs = { 0, 1'000, 10'000, 100'000, 1'000'000, BoruvkaMST<>::AUTO_CUTOFF };
+    u64 correct_weight = 0;
+
+    for (u32 cutoff : cutoffs) {
+        BoruvkaMST boruvka(cutoff);
+        double total_time = 0;
+        u64 weight = 0;
+
+        for (u32 iter = 1; iter <= NUM_ITER; ++iter) {
+            escape(&G);
+            double start = omp_get_wtime();
+
+            auto mst_ids = boruvka.calculate_mst_ids(G);
+
+            double finish = omp_get_wtime();
+            escape(&mst_ids);
+
+            total_time += finish - start;
+
+            weight = 0;
+            for (u32 id : mst_ids) weight += G.edges[id].weight;
+        }
+
+        if (cutoff == 0) {
+            correct_weight = weight;
+        } else if (weight != correct_weight) {
+            std::cerr << "Weights don't match!\nCorrect: " << correct_weight << "\nIncorrect: " << weight << "\n";
+            exit(-1);
+        }
+
+        std::cout << std::fixed << "\nCutoff: ";
+        if (cutoff == BoruvkaMST<>::AUTO_CUTOFF) {
+            std::cout << "auto (" << boruvka.sequential_cutoff(omp_get_max_threads()) << ")";
+        } else {
+            std::cout << cutoff;
+        }
+        std::cout << "\nAverage time: " << total_time / NUM_ITER << " s\n";
+
+        if (json) {
+            boruvka.profile.write_json(std::cout);
+        } else {
+            boruvka.profile.write_csv(std::cout);
+        }
+    }
+
+    return 0;
+}
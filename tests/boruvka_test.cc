@@ -12,15 +12,22 @@ int main(int argc, char* argv[]) {
     Graph G = load_graph(argv[1]);
 
     BoruvkaMST boruvka;
+    BoruvkaMST boruvka_no_cutoff(0);
     SequentialMST sequential_mst;
 
     u64 weight_to_check = 0;
+    u64 weight_no_cutoff = 0;
     u64 weight_correct = 0;
     
     {
         auto mst = boruvka.calculate_mst(G);
         for (u32 i = 0; i < mst.size(); ++i) weight_to_check += mst[i].weight;
     }
+
+    {
+        auto mst = boruvka_no_cutoff.calculate_mst(G);
+        for (u32 i = 0; i < mst.size(); ++i) weight_no_cutoff += mst[i].weight;
+    }
     
     {
         auto mst = sequential_mst.calculate_mst(G);
@@ -31,6 +38,11 @@ int main(int argc, char* argv[]) {
         std::cerr << "Weights don't match!\nCorrect: " << weight_correct << "\nIncorrect: " << weight_to_check << "\n";
         exit(-1);
     }
+    else if (weight_no_cutoff != weight_correct) {
+        std::cerr << "Weights without sequential cutoff don't match!\nCorrect: " << weight_correct
+                  << "\nIncorrect: " << weight_no_cutoff << "\n";
+        exit(-1);
+    }
     else {
         std::cout << "OK\n";
     }
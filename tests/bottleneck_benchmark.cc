@@ -0,0 +1,75 @@
+#include <random>
+#include <string>
+
+#include "../benchmark.h"
+#include "../bottleneck_index.h"
+#include "../boruvka.h"
+#include "../graph.h"
+
+const u32 AVERAGE_DEGREE = 4;
+
+/**
+ * Registered benchmarks of BottleneckIndex, see run_registered_benchmarks() for arguments
+ * size is the number of nodes, the index is built over the MST of a random graph
+ * with AVERAGE_DEGREE * size edges, query benchmarks answer size random queries
+ *
+ * bottleneck/query_unbatched calls the single query in a parallel loop,
+ * the difference to bottleneck/query is what prefetching the next queries gives
+ */
+struct BottleneckWorkload {
+    u32 num_nodes;
+    ParallelArray<Edge> mst;
+    ParallelArray<u32> from;
+    ParallelArray<u32> to;
+
+    BottleneckWorkload(u64 size) : num_nodes(size), mst(0), from(size), to(size) {
+        BoruvkaMST boruvka;
+        ParallelArray<Edge> forest = boruvka.calculate_mst(generate_graph(size, size * AVERAGE_DEGREE));
+        mst.swap(forest);
+
+        std::mt19937 gen(size);
+        for (u64 i = 0; i < size; ++i) {
+            from[i] = gen() % size;
+            to[i] = gen() % size;
+        }
+    }
+};
+
+REGISTER_BENCHMARK("bottleneck/build", SIZES(1'000'000, 10'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    BottleneckWorkload workload(size);
+
+    benchmark.run(name, size, [&]() {
+        BottleneckIndex index(workload.num_nodes, workload.mst);
+        escape(&index);
+    });
+});
+
+REGISTER_BENCHMARK("bottleneck/query", SIZES(1'000'000, 10'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    BottleneckWorkload workload(size);
+    BottleneckIndex index(workload.num_nodes, workload.mst);
+
+    benchmark.run(name, size, [&]() {
+        ParallelArray<u32> result = index.query(workload.from, workload.to);
+        escape(&result);
+    });
+});
+
+void run_query_unbatched(Benchmark& benchmark, const std::string& name, u64 size) {
+    BottleneckWorkload workload(size);
+    BottleneckIndex index(workload.num_nodes, workload.mst);
+    ParallelArray<u32> result(size);
+
+    benchmark.run(name, size, [&]() {
+        #pragma omp parallel for
+        for (u64 i = 0; i < size; ++i) {
+            result[i] = index.query(workload.from[i], workload.to[i]);
+        }
+        escape(&result);
+    });
+}
+
+REGISTER_BENCHMARK("bottleneck/query_unbatched", SIZES(1'000'000, 10'000'000), run_query_unbatched);
+
+BENCHMARK_MAIN()
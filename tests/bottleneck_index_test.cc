@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <iostream>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../bottleneck_index.h"
+#include "../boruvka.h"
+#include "../defs.h"
+#include "../graph.h"
+#include "../utils.h"
+
+/**
+ * Answers of BottleneckIndex are compared with minimax Dijkstra over the whole graph,
+ * the minimum bottleneck doesn't depend on which MST was found
+ * Forests are MSTs with some of their edges dropped, there answers are compared with a DFS over the forest
+ */
+const u32 NUM_STEPS = 30;
+const u32 MAX_NODES = 3'000;
+const u32 NUM_SOURCES = 5;
+const u32 MAX_THREADS = 8;
+
+void fail(const std::string& what, u32 step) {
+    std::cerr << what << " mismatch on step " << step << "\n";
+    exit(-1);
+}
+
+/* bottleneck[v] is the smallest largest weight over paths from source to v, NO_PATH if there are none */
+template<typename W, typename Edges>
+std::vector<W> minimax_paths(u32 num_nodes, const Edges& edges, u32 source) {
+    using Index = BottleneckIndex<W>;
+
+    std::vector<std::vector<std::pair<u32, W>>> g(num_nodes);
+    for (u32 i = 0; i < edges.size(); ++i) {
+        g[edges[i].from].push_back({ edges[i].to, edges[i].weight });
+        g[edges[i].to].push_back({ edges[i].from, edges[i].weight });
+    }
+
+    std::vector<W> bottleneck(num_nodes, Index::NO_PATH);
+    std::vector<u8> done(num_nodes);
+    std::priority_queue<std::pair<W, u32>, std::vector<std::pair<W, u32>>, std::greater<>> queue;
+    bottleneck[source] = Index::EMPTY_PATH;
+    queue.push({ Index::EMPTY_PATH, source });
+
+    while (!queue.empty()) {
+        u32 u = queue.top().second;
+        queue.pop();
+        if (done[u]) continue;
+        done[u] = 1;
+
+        for (auto [v, w] : g[u]) {
+            W through = std::max(bottleneck[u], w);
+            if (!done[v] && through < bottleneck[v]) {
+                bottleneck[v] = through;
+                queue.push({ through, v });
+            }
+        }
+    }
+
+    return bottleneck;
+}
+
+template<typename W, typename Edges>
+void check_sources(const BottleneckIndex<W>& index, u32 num_nodes, const Edges& edges, u32 step) {
+    for (u32 s = 0; s < NUM_SOURCES; ++s) {
+        u32 source = randint(0, num_nodes - 1);
+        std::vector<W> expected = minimax_paths<W>(num_nodes, edges, source);
+
+        ParallelArray<u32> from(num_nodes), to(num_nodes);
+        for (u32 v = 0; v < num_nodes; ++v) {
+            from[v] = (v % 2 == 0 ? source : v);
+            to[v] = (v % 2 == 0 ? v : source);
+        }
+        ParallelArray<W> batch = index.query(from, to);
+
+        for (u32 v = 0; v < num_nodes; ++v) {
+            if (index.query(source, v) != expected[v]) fail("Query", step);
+            if (batch[v] != expected[v]) fail("Batched query", step);
+        }
+    }
+}
+
+template<typename W>
+void check_weights(const std::string& name) {
+    std::cout << "Checking " << name << ":\n";
+
+    BoruvkaMST<W> boruvka;
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(2, MAX_NODES);
+        BasicGraph<W> G = generate_graph<W>(num_nodes, randint(num_nodes - 1, 5 * num_nodes));
+        ParallelArray<BasicEdge<W>> mst = boruvka.calculate_mst(G);
+
+        BottleneckIndex<W> index(num_nodes, mst, randint(1, MAX_THREADS));
+        check_sources(index, num_nodes, G.edges, step);
+
+        /* Every tree of a forest is the MST of its nodes */
+        std::vector<BasicEdge<W>> kept;
+        u32 drop_chance = randint(2, 100);
+        for (u32 i = 0; i < mst.size(); ++i) {
+            if (randint(1, drop_chance) != 1) kept.push_back(mst[i]);
+        }
+        ParallelArray<BasicEdge<W>> forest_edges(kept.size());
+        std::copy(kept.begin(), kept.end(), forest_edges.begin());
+
+        BottleneckIndex<W> forest_index(num_nodes, forest_edges, randint(1, MAX_THREADS));
+        check_sources(forest_index, num_nodes, forest_edges, step);
+    }
+    std::cout << "OK\n";
+}
+
+int main() {
+    check_weights<u32>("u32 weights");
+    check_weights<u16>("u16 weights");
+    check_weights<float>("float weights");
+
+    std::cout << "Checking exceptions:\n";
+    try {
+        ParallelArray<Edge> edges(1);
+        edges[0] = Edge(0, 1, 5);
+        BottleneckIndex index(2, edges);
+        index.query(0, 2);
+        std::cerr << "Query of a missing node was answered\n";
+        exit(-1);
+    } catch (std::out_of_range& e) {
+        std::cout << "std::out_of_range\n" << e.what() << "\n";
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+
+#include "../defs.h"
+
+/**
+ * Compares two JSON reports of the benchmark harness (format=json output=...),
+ * e.g. of the same benchmark built from two commits
+ *
+ * Usage: compare_benchmarks old.json new.json [threshold=0.1]
+ *
+ * Prints median times of benchmarks present in both files and exits with 1
+ * if any of them got slower by more than threshold (a fraction of the old time)
+ */
+using BenchmarkKey = std::tuple<std::string, u32>;
+
+/* Returns the raw value of a field in a one line JSON object, empty if there is none */
+std::string json_field(const std::string& line, const std::string& key) {
+    std::string pattern = "\"" + key + "\": ";
+    size_t start = line.find(pattern);
+    if (start == std::string::npos) return "";
+    start += pattern.size();
+
+    if (line[start] == '"') {
+        size_t finish = line.find('"', start + 1);
+        return line.substr(start + 1, finish - start - 1);
+    }
+
+    size_t finish = line.find_first_of(",}", start);
+    return line.substr(start, finish - start);
+}
+
+std::map<BenchmarkKey, double> load_report(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) {
+        std::cerr << "Can't open " << filename << "\n";
+        exit(-1);
+    }
+
+    std::map<BenchmarkKey, double> medians;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string name = json_field(line, "name");
+        if (name.empty()) continue;
+
+        u32 threads = std::stoul(json_field(line, "threads"));
+        medians[{ name, threads }] = std::stod(json_field(line, "median_ns"));
+    }
+    return medians;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cout << "Usage: compare_benchmarks old.json new.json [threshold=0.1]\n";
+        return 0;
+    }
+
+    double threshold = 0.1;
+    if (argc > 3) {
+        std::string argument = argv[3];
+        threshold = std::stod(argument.substr(argument.find('=') + 1));
+    }
+
+    auto old_report = load_report(argv[1]);
+    auto new_report = load_report(argv[2]);
+
+    u32 regressions = 0;
+
+    std::cout << std::fixed << std::left << std::setw(48) << "name" << std::right
+              << std::setw(8) << "threads"
+              << std::setw(14) << "old, s"
+              << std::setw(14) << "new, s"
+              << std::setw(10) << "change" << "\n";
+
+    for (const auto& [key, old_time] : old_report) {
+        auto it = new_report.find(key);
+        if (it == new_report.end()) continue;
+
+        double new_time = it->second;
+        double change = old_time == 0 ? 0 : (new_time - old_time) / old_time;
+        bool regression = change > threshold;
+        regressions += regression;
+
+        std::cout << std::left << std::setw(48) << std::get<0>(key) << std::right
+                  << std::setw(8) << std::get<1>(key)
+                  << std::setprecision(6) << std::setw(14) << old_time * 1e-9
+                  << std::setw(14) << new_time * 1e-9
+                  << std::setprecision(1) << std::setw(9) << change * 100 << "%"
+                  << (regression ? "  REGRESSION" : "") << "\n";
+    }
+
+    if (regressions > 0) {
+        std::cerr << regressions << " benchmarks got slower by more than " << threshold * 100 << "%\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../boruvka.h"
+#include "../compressed_graph.h"
+#include "../defs.h"
+#include "../graph.h"
+#include "../graph_reordering.h"
+
+/**
+ * Compresses random graphs and checks that they decompress to the same edges, that MST ids
+ * and connectivity match the ones of the source graph, also after compressing a reordered graph
+ * Graphs have self loops, parallel edges, isolated nodes and nodes with several blocks,
+ * gaps between neighbors range from zero to the number of nodes, the longest varints are checked on their own
+ */
+const u32 NUM_STEPS = 100;
+const u32 MAX_NODES = 5'000;
+const u32 MAX_THREADS = 4;
+
+void fail(const std::string& what, u32 step) {
+    std::cerr << what << " mismatch on step " << step << "\n";
+    exit(-1);
+}
+
+/* Random sorted edges in both directions, a hub node gets many of them */
+Graph random_graph(u32 num_nodes, u32 num_edges) {
+    std::vector<Edge> edges;
+    u32 hub = randint(0, num_nodes - 1);
+    for (u32 i = 0; i < num_edges; ++i) {
+        u32 from = randint(0, 3) == 0 ? hub : randint(0, num_nodes - 1);
+        u32 to = randint(0, 9) == 0 ? from : randint(0, num_nodes - 1);
+        u32 weight = gen();
+        edges.push_back(Edge(from, to, weight));
+        edges.push_back(Edge(to, from, weight));
+    }
+    std::sort(edges.begin(), edges.end());
+
+    Graph G(num_nodes, edges.size());
+    for (u32 u = 0; u < num_nodes; ++u) G.nodes[u] = u;
+    std::copy(edges.begin(), edges.end(), G.edges.begin());
+    return G;
+}
+
+u64 total_weight(const Graph& G, const ParallelArray<u32>& ids) {
+    u64 weight = 0;
+    for (u32 id : ids) weight += G.edges[id].weight;
+    return weight;
+}
+
+bool same_edge(const Edge& a, const Edge& b) {
+    return a.from == b.from && a.to == b.to && a.weight == b.weight;
+}
+
+int main() {
+    std::cout << "Checking varints:\n";
+    for (u64 value : { 0ULL, 1ULL, 127ULL, 128ULL, 16'383ULL, 16'384ULL, (1ULL << 32) - 1, (1ULL << 33) - 1 }) {
+        u8 buffer[10];
+        u32 length = CompressedGraph::encode_varint(value, buffer);
+        const u8* in = buffer;
+        if (CompressedGraph::decode_varint(in) != value || in != buffer + length ||
+            length != CompressedGraph::encode_varint(value, nullptr)) {
+            std::cerr << "Varint " << value << " doesn't decode\n";
+            exit(-1);
+        }
+    }
+    for (u32 from : { 0u, 1u, 1'000u, 0xFFFFFFFFu }) {
+        for (u32 to : { 0u, 1u, 999u, 1'001u, 0xFFFFFFFFu }) {
+            if (CompressedGraph::unzigzag(from, CompressedGraph::zigzag(from, to)) != to) {
+                std::cerr << "Zigzag of " << from << " and " << to << " doesn't decode\n";
+                exit(-1);
+            }
+        }
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking random graphs:\n";
+    BoruvkaMST boruvka;
+    BoruvkaMST boruvka_bfs(BoruvkaMST<>::AUTO_CUTOFF, detect_simd_level(), BFS_ORDER);
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(2, MAX_NODES);
+        Graph G = step % 2 == 0 ? generate_graph(num_nodes, randint(num_nodes - 1, 4 * num_nodes))
+                                : random_graph(num_nodes, randint(0, 2 * num_nodes));
+        u32 threads = randint(1, MAX_THREADS);
+        CompressedGraph compressed(G, threads);
+
+        if (compressed.num_nodes() != G.num_nodes() || compressed.num_edges() != G.num_edges()) {
+            fail("Sizes", step);
+        }
+
+        Graph decompressed = compressed.decompress();
+        for (u32 i = 0; i < G.num_edges(); ++i) {
+            if (!same_edge(decompressed.edges[i], G.edges[i])) fail("Decompressed edge", step);
+        }
+        for (u32 i = 0; i < 100 && G.num_edges() != 0; ++i) {
+            u32 id = randint(0, G.num_edges() - 1);
+            if (!same_edge(compressed.get(id), G.edges[id])) fail("get()", step);
+        }
+
+        ParallelArray<u32> mst_ids = boruvka.calculate_mst_ids(G, threads);
+        ParallelArray<u32> compressed_mst_ids = boruvka.calculate_mst_ids(compressed, threads);
+        std::sort(mst_ids.begin(), mst_ids.end());
+        std::sort(compressed_mst_ids.begin(), compressed_mst_ids.end());
+        if (!std::equal(mst_ids.begin(), mst_ids.end(), compressed_mst_ids.begin(), compressed_mst_ids.end())) {
+            fail("MST ids", step);
+        }
+
+        /* node_order doesn't apply to compressed graphs, a reordered graph is compressed instead */
+        ParallelArray<u32> bfs_mst_ids = boruvka_bfs.calculate_mst_ids(compressed, threads);
+        std::sort(bfs_mst_ids.begin(), bfs_mst_ids.end());
+        if (!std::equal(bfs_mst_ids.begin(), bfs_mst_ids.end(), compressed_mst_ids.begin(), compressed_mst_ids.end())) {
+            fail("MST ids with BFS_ORDER", step);
+        }
+        ReorderedGraph reordered(G, BFS_ORDER, threads);
+        CompressedGraph compressed_reordered(reordered.graph, threads);
+        ParallelArray<u32> reordered_mst_ids =
+            reordered.to_original_ids(boruvka.calculate_mst_ids(compressed_reordered, threads));
+        if (reordered_mst_ids.size() != mst_ids.size() || total_weight(G, reordered_mst_ids) != total_weight(G, mst_ids)) {
+            fail("Reordered MST", step);
+        }
+
+        if (is_connected(compressed, threads) != is_connected(G)) fail("is_connected()", step);
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking exceptions:\n";
+    try {
+        Graph G(3, 2);
+        for (u32 u = 0; u < 3; ++u) G.nodes[u] = u;
+        G.edges[0] = Edge(2, 0, 1);
+        G.edges[1] = Edge(0, 2, 1);
+        CompressedGraph compressed(G);
+        std::cerr << "Unsorted edges were compressed\n";
+        exit(-1);
+    } catch (std::invalid_argument& e) {
+        std::cout << "std::invalid_argument\n" << e.what() << "\n";
+    }
+
+    try {
+        /* Only the size of the view is read before the check */
+        Graph G(2, 1);
+        GraphView view(G.nodes, ArrayView<Edge>(G.edges.begin(), (1ULL << 32) + 1));
+        CompressedGraph compressed(view);
+        std::cerr << "Graph with more than 2^32 edges was compressed\n";
+        exit(-1);
+    } catch (std::invalid_argument& e) {
+        std::cout << "std::invalid_argument\n" << e.what() << "\n";
+    }
+
+    try {
+        CompressedGraph compressed(generate_graph(10, 20));
+        compressed.get(40);
+        std::cerr << "get() didn't check its id\n";
+        exit(-1);
+    } catch (std::out_of_range& e) {
+        std::cout << "std::out_of_range\n" << e.what() << "\n";
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
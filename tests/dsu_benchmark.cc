@@ -0,0 +1,88 @@
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../benchmark.h"
+#include "../dsu.h"
+#include "../dsu_randomized.h"
+#include "../dsu_rankless.h"
+#include "../sequential_dsu.h"
+
+/**
+ * Registered benchmarks of DSU variants, see run_registered_benchmarks() for arguments
+ * Every variant gets size nodes and size random unite queries, DSUs are rebuilt before each repetition
+ */
+std::vector<std::pair<u32, u32>> random_queries(u64 size) {
+    std::mt19937 gen(size);
+    std::uniform_int_distribution<u32> node(0, size - 1);
+
+    std::vector<std::pair<u32, u32>> queries(size);
+    for (auto& p : queries) {
+        p = { node(gen), node(gen) };
+    }
+    return queries;
+}
+
+template<typename T>
+void run_parallel_unite(Benchmark& benchmark, const std::string& name, u64 size) {
+    auto queries = random_queries(size);
+    std::unique_ptr<T> dsu;
+
+    benchmark.run(name, queries.size(), [&]() {
+        dsu.reset(new T(size));
+    }, [&]() {
+        escape(&queries);
+        #pragma omp parallel for
+        for (u32 i = 0; i < queries.size(); ++i) {
+            dsu->unite(queries[i].first, queries[i].second);
+        }
+        escape(dsu.get());
+    });
+}
+
+template<typename T>
+void run_parallel_find(Benchmark& benchmark, const std::string& name, u64 size) {
+    auto queries = random_queries(size);
+    T dsu(size);
+    for (u32 i = 0; i < queries.size() / 2; ++i) {
+        dsu.unite(queries[i].first, queries[i].second);
+    }
+
+    benchmark.run(name, queries.size(), [&]() {
+        escape(&queries);
+        #pragma omp parallel for
+        for (u32 i = 0; i < queries.size(); ++i) {
+            dsu.same_set(queries[i].first, queries[i].second);
+        }
+        escape(&dsu);
+    });
+}
+
+template<PathCompression COMPRESSION>
+void run_sequential_unite(Benchmark& benchmark, const std::string& name, u64 size) {
+    auto queries = random_queries(size);
+    std::unique_ptr<SequentialDSU> dsu;
+
+    benchmark.run_sequential(name, queries.size(), [&]() {
+        dsu.reset(new SequentialDSU(size, COMPRESSION));
+    }, [&]() {
+        escape(&queries);
+        for (auto p : queries) {
+            dsu->unite(p.first, p.second);
+        }
+        escape(dsu.get());
+    });
+}
+
+REGISTER_BENCHMARK("dsu/sequential_full/unite", SIZES(1'000'000, 10'000'000), run_sequential_unite<FULL_COMPRESSION>);
+REGISTER_BENCHMARK("dsu/sequential_halving/unite", SIZES(1'000'000, 10'000'000), run_sequential_unite<PATH_HALVING>);
+REGISTER_BENCHMARK("dsu/sequential_splitting/unite", SIZES(1'000'000, 10'000'000), run_sequential_unite<PATH_SPLITTING>);
+REGISTER_BENCHMARK("dsu/ranked/unite", SIZES(1'000'000, 10'000'000), run_parallel_unite<DSU>);
+REGISTER_BENCHMARK("dsu/rankless/unite", SIZES(1'000'000, 10'000'000), run_parallel_unite<RanklessDSU>);
+REGISTER_BENCHMARK("dsu/randomized/unite", SIZES(1'000'000, 10'000'000), run_parallel_unite<RandomizedDSU>);
+REGISTER_BENCHMARK("dsu/ranked/same_set", SIZES(1'000'000, 10'000'000), run_parallel_find<DSU>);
+REGISTER_BENCHMARK("dsu/rankless/same_set", SIZES(1'000'000, 10'000'000), run_parallel_find<RanklessDSU>);
+REGISTER_BENCHMARK("dsu/randomized/same_set", SIZES(1'000'000, 10'000'000), run_parallel_find<RandomizedDSU>);
+
+BENCHMARK_MAIN()
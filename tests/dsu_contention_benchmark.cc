@@ -0,0 +1,210 @@
+/**
+ * CAS retries are only counted with instrumentation
+ */
+#define ENABLE_INSTRUMENTATION
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <omp.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../benchmark.h"
+#include "../dsu.h"
+#include "../dsu_randomized.h"
+#include "../dsu_rankless.h"
+#include "../sequential_dsu.h"
+#include "../timer.h"
+
+/**
+ * Contention scenarios for DSU variants, see run_registered_benchmarks() for arguments
+ *
+ * Every scenario is a fixed list of operations on size nodes, it is split into
+ * contiguous blocks between threads and replayed on a fresh DSU in each repetition
+ *
+ * Besides throughput every result has metrics:
+ * cas_retries_per_op - failed linking CAS per operation, 0 for SequentialDSU
+ * latency_p50_ns, latency_p99_ns, latency_p999_ns - latency of every LATENCY_SAMPLE_RATE-th operation
+ */
+const u32 LATENCY_SAMPLE_RATE = 64;
+const double ZIPF_EXPONENT = 1.0;
+
+struct Operation {
+    u32 id1;
+    u32 id2;
+    bool is_find;
+};
+
+using Workload = std::vector<Operation>;
+
+/* Everything is united onto node 0 */
+Workload star_workload(u32 size) {
+    Workload workload(size - 1);
+    for (u32 i = 1; i < size; ++i) {
+        workload[i - 1] = { 0, i, false };
+    }
+    return workload;
+}
+
+/* Neighbouring nodes are united in order, so every thread grows a long path */
+Workload chain_workload(u32 size) {
+    Workload workload(size - 1);
+    for (u32 i = 1; i < size; ++i) {
+        workload[i - 1] = { i - 1, i, false };
+    }
+    return workload;
+}
+
+/* Both ends are drawn from a Zipf distribution, so a few nodes take most of the operations */
+Workload zipf_workload(u32 size) {
+    std::vector<double> cdf(size);
+    double sum = 0;
+    for (u32 i = 0; i < size; ++i) {
+        sum += 1 / std::pow(i + 1, ZIPF_EXPONENT);
+        cdf[i] = sum;
+    }
+
+    std::mt19937 gen(size);
+    std::uniform_real_distribution<double> uniform(0, sum);
+    auto zipf = [&]() {
+        return static_cast<u32>(std::lower_bound(cdf.begin(), cdf.end(), uniform(gen)) - cdf.begin());
+    };
+
+    Workload workload(size);
+    for (auto& op : workload) {
+        op = { zipf(), zipf(), false };
+    }
+    return workload;
+}
+
+/* Uniform pairs, find_ratio of them are same_set queries and the rest are unites */
+Workload mixed_workload(u32 size, double find_ratio) {
+    std::mt19937 gen(size);
+    std::uniform_int_distribution<u32> node(0, size - 1);
+    std::bernoulli_distribution is_find(find_ratio);
+
+    Workload workload(size);
+    for (auto& op : workload) {
+        op.id1 = node(gen);
+        op.id2 = node(gen);
+        op.is_find = is_find(gen);
+    }
+    return workload;
+}
+
+/**
+ * Like a Boruvka round: every node hooks onto its lightest neighbour,
+ * here a random node among nearby ids, which gives trees with many short cycles
+ */
+Workload hook_forest_workload(u32 size) {
+    const u32 NEIGHBOURHOOD = 64;
+
+    std::mt19937 gen(size);
+    std::uniform_int_distribution<u32> offset(1, NEIGHBOURHOOD);
+
+    Workload workload(size);
+    for (u32 i = 0; i < size; ++i) {
+        workload[i] = { i, static_cast<u32>((i + offset(gen)) % size), false };
+    }
+    return workload;
+}
+
+template<typename T>
+u64 cas_retries(const T& dsu) {
+    return dsu.cas_retries();
+}
+
+template<>
+u64 cas_retries(const SequentialDSU&) {
+    return 0;
+}
+
+template<typename T>
+void apply(T& dsu, const Operation& op) {
+    if (op.is_find) {
+        dsu.same_set(op.id1, op.id2);
+    } else {
+        dsu.unite(op.id1, op.id2);
+    }
+}
+
+template<typename T>
+void run_workload(Benchmark& benchmark,
+                  const std::string& name,
+                  const Workload& workload,
+                  u32 size,
+                  const std::vector<u32>& thread_counts) {
+    std::unique_ptr<T> dsu;
+    std::vector<std::vector<u64>> latencies;
+    u64 total_cas_retries = 0;
+    u32 run = 0;
+
+    for (u32 threads : thread_counts) {
+        latencies.assign(threads, {});
+        total_cas_retries = 0;
+        run = 0;
+
+        benchmark.measure(name, threads, workload.size(), [&]() {
+            dsu.reset(new T(size));
+            ++run;
+        }, [&]() {
+            bool record = run > benchmark.config.warmup;
+
+            #pragma omp parallel
+            {
+                std::vector<u64>& samples = latencies[omp_get_thread_num()];
+
+                #pragma omp for schedule(static)
+                for (u32 i = 0; i < workload.size(); ++i) {
+                    if (record && i % LATENCY_SAMPLE_RATE == 0) {
+                        u64 start = wall_time_ns();
+                        apply(*dsu, workload[i]);
+                        samples.push_back(wall_time_ns() - start);
+                    } else {
+                        apply(*dsu, workload[i]);
+                    }
+                }
+            }
+
+            if (record) total_cas_retries += cas_retries(*dsu);
+        });
+
+        std::vector<u64> all_latencies;
+        for (const auto& samples : latencies) {
+            all_latencies.insert(all_latencies.end(), samples.begin(), samples.end());
+        }
+
+        benchmark.set_metric("cas_retries_per_op",
+                             static_cast<double>(total_cas_retries) / (benchmark.config.repetitions * workload.size()));
+        benchmark.set_metric("latency_p50_ns", BenchmarkResult::percentile(all_latencies, 50));
+        benchmark.set_metric("latency_p99_ns", BenchmarkResult::percentile(all_latencies, 99));
+        benchmark.set_metric("latency_p999_ns", BenchmarkResult::percentile(all_latencies, 99.9));
+    }
+}
+
+/* Runs the workload on every DSU variant, names are scenario/variant/size */
+void run_variants(Benchmark& benchmark, const std::string& scenario, const Workload& workload, u64 size) {
+    std::string suffix = "/" + std::to_string(size);
+
+    run_workload<SequentialDSU>(benchmark, scenario + "/sequential" + suffix, workload, size, { 1 });
+    run_workload<DSU>(benchmark, scenario + "/ranked" + suffix, workload, size, benchmark.config.threads);
+    run_workload<RanklessDSU>(benchmark, scenario + "/rankless" + suffix, workload, size, benchmark.config.threads);
+    run_workload<RandomizedDSU>(benchmark, scenario + "/randomized" + suffix, workload, size, benchmark.config.threads);
+}
+
+#define REGISTER_SCENARIO(scenario, make_workload) \
+    REGISTER_BENCHMARK(scenario, SIZES(1'000'000, 10'000'000), \
+                       [](Benchmark& benchmark, const std::string&, u64 size) { \
+        run_variants(benchmark, scenario, make_workload, size); \
+    })
+
+REGISTER_SCENARIO("dsu_contention/star", star_workload(size));
+REGISTER_SCENARIO("dsu_contention/chain", chain_workload(size));
+REGISTER_SCENARIO("dsu_contention/zipf", zipf_workload(size));
+REGISTER_SCENARIO("dsu_contention/find_heavy", mixed_workload(size, 0.9));
+REGISTER_SCENARIO("dsu_contention/unite_heavy", mixed_workload(size, 0.1));
+REGISTER_SCENARIO("dsu_contention/hook_forest", hook_forest_workload(size));
+
+BENCHMARK_MAIN()
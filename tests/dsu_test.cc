@@ -1,29 +1,32 @@
 /**
  * This test relies on the same interface that dsu.h gives
- * Class name should be DSU
+ * and checks every concurrent DSU in the repo
  * 
  * If you want to check your own implementation of a parallel dsu,
- * feel free to use this one, just modify the include path
+ * include it and add it to main()
  * 
  * If you add no_correctness, no_exceptions or no_performance these
- * tests will be skipped
+ * tests will be skipped, performance settings are read by parse_benchmark_args()
  * 
  * It checks overall correctness, exceptions and performance
  */
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <omp.h>
-#include <pair>
 #include <random>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 /* Include your path here */
 #include "../benchmark.h"
 #include "../defs.h"
 #include "../dsu.h"
+#include "../dsu_randomized.h"
+#include "../dsu_rankless.h"
 #include "../timer.h"
 #include "../sequential_dsu.h"
 
@@ -42,11 +45,13 @@ const u32 MAX_SIZE = 1'000;
 
 const u32 PERF_NUM_STEPS = 20;
 const u32 PERF_SIZE = 20'000'000;
+const u32 PERF_NUM_QUERIES = 30'000'000;
 
+template<typename T>
 void dump_data(const u32 size,
                const std::vector<std::pair<u32, u32>>& queries,
-               SequentialDSU correct,
-               DSU incorrect,
+               SequentialDSU& correct,
+               T& incorrect,
                u32 a,
                u32 b) {
     std::cerr << "Component mismatch:\n"
@@ -70,14 +75,21 @@ void dump_data(const u32 size,
     std::cerr << "\nComponents " << a << " " << b << "\n";
 }
 
-void check_correctness() {
-    std::cout << std::fixed << "Checking correctness:\n";
+/* RandomizedDSU with the given compression and a constructor of one argument */
+template<PathCompression COMPRESSION>
+struct RandomizedDSUWith : RandomizedDSU {
+    RandomizedDSUWith(u32 size) : RandomizedDSU(size, COMPRESSION) {}
+};
+
+template<typename T>
+void check_correctness(const std::string& name) {
+    std::cout << std::fixed << "Checking correctness of " << name << ":\n";
     std::cout << "Checking small sizes:\n";
     for (u32 size = 1; size <= SMALL_SIZE; ++size) {
         std::cout << "Size: " << size << "\n";
         for (u32 step = 1; step <= SMALL_NUM_STEPS; ++step) {
 
-            DSU to_check(size);
+            T to_check(size);
             SequentialDSU correct(size);
 
             std::vector<std::pair<u32, u32>> queries(randint(1, size * 1.5));
@@ -116,7 +128,7 @@ void check_correctness() {
         }
 
         u32 size = randint(MAX_SIZE / 100, MAX_SIZE);
-        DSU to_check(size);
+        T to_check(size);
         SequentialDSU correct(size);
 
         std::vector<std::pair<u32, u32>> queries(randint(1, size * 1.5));  // 1.5 x size operation at max
@@ -148,11 +160,78 @@ void check_correctness() {
     std::cout << "OK\n";
 }
 
-void check_exceptions() {
-    std::cout << "Checking exceptions:\n";
-    std::cout << "DSU():\n";
+/**
+ * All compression modes of SequentialDSU should give the same sets,
+ * and a copy should go on independently of the original
+ */
+void check_sequential() {
+    std::cout << "Checking SequentialDSU compression modes:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 size = randint(1, MAX_SIZE);
+        SequentialDSU full(size, FULL_COMPRESSION);
+        SequentialDSU halving(size, PATH_HALVING);
+        SequentialDSU splitting(size, PATH_SPLITTING);
+
+        std::vector<std::pair<u32, u32>> queries(randint(1, size * 1.5));
+        for (auto& p : queries) {
+            p.first = randint(0, size - 1);
+            p.second = randint(0, size - 1);
+        }
+
+        u32 half = queries.size() / 2;
+        for (u32 i = 0; i < half; ++i) {
+            bool united = full.unite(queries[i].first, queries[i].second);
+            if (halving.unite(queries[i].first, queries[i].second) != united ||
+                splitting.unite(queries[i].first, queries[i].second) != united) {
+                std::cerr << "unite() results don't match on size " << size << "\n";
+                exit(-1);
+            }
+        }
+
+        SequentialDSU copy = full;
+        std::vector<std::pair<u32, u32>> sampled(size);
+        std::vector<u8> copy_answer(size);
+        for (u32 i = 0; i < size; ++i) {
+            sampled[i] = { i, randint(0, size - 1) };
+            copy_answer[i] = copy.same_set(i, sampled[i].second);
+        }
+
+        /* Pairs the second half joins were apart in full when it was copied */
+        std::vector<std::pair<u32, u32>> merged;
+        for (u32 i = half; i < queries.size(); ++i) {
+            if (full.unite(queries[i].first, queries[i].second)) merged.push_back(queries[i]);
+            halving.unite(queries[i].first, queries[i].second);
+            splitting.unite(queries[i].first, queries[i].second);
+        }
+
+        for (u32 i = 0; i < size; ++i) {
+            auto [a, b] = sampled[i];
+            bool same = full.same_set(a, b);
+            if (halving.same_set(a, b) != same || splitting.same_set(a, b) != same) {
+                std::cerr << "Compression modes disagree on nodes " << a << " " << b << "\n";
+                exit(-1);
+            }
+            if (copy.same_set(a, b) != copy_answer[i]) {
+                std::cerr << "Copy changed with the original on nodes " << a << " " << b << "\n";
+                exit(-1);
+            }
+        }
+        for (auto [a, b] : merged) {
+            if (copy.same_set(a, b) || !full.same_set(a, b)) {
+                std::cerr << "Copy shares unions of the original on nodes " << a << " " << b << "\n";
+                exit(-1);
+            }
+        }
+    }
+    std::cout << "OK\n";
+}
+
+template<typename T>
+void check_exceptions(const std::string& name) {
+    std::cout << "Checking exceptions of " << name << ":\n";
+    std::cout << name << "():\n";
     try {
-        DSU(0);
+        T(0);
     } catch (std::invalid_argument& e) {
         std::cout << "std::invalid_argument\n" << e.what() << "\n";
     } catch (...) {
@@ -161,7 +240,7 @@ void check_exceptions() {
     }
     std::cout << "find_root():\n";
     try {
-        DSU d(2);
+        T d(2);
         d.find_root(2);
     } catch (std::out_of_range& e) {
         std::cout << "std::out_of_range\n" << e.what() << "\n";
@@ -172,7 +251,7 @@ void check_exceptions() {
 
     std::cout << "same_set():\n";
     try {
-        DSU d(2);
+        T d(2);
         d.same_set(0, 2);
     } catch (std::out_of_range& e) {
         std::cout << "std::out_of_range\n" << e.what() << "\n";
@@ -183,7 +262,7 @@ void check_exceptions() {
 
     std::cout << "unite():\n";
     try {
-        DSU d(2);
+        T d(2);
         d.unite(0, 2);
     } catch (std::out_of_range& e) {
         std::cout << "std::out_of_range\n" << e.what() << "\n";
@@ -194,82 +273,67 @@ void check_exceptions() {
     std::cout << "OK\n";
 }
 
-void check_performance() {
+void check_performance(BenchmarkConfig config) {
     std::cout << "Checking performance on random queries:\n";
-    u64 seq_constructon_time = 0;
-    u64 par_constructon_time = 0;
-    u64 seq_query_time = 0;
-    u64 par_query_time = 0;
-    u32 total_queries = 0;
-    u64 start, finish;
-
-    for (u32 i = 1; i <= PERF_NUM_STEPS; ++i) {
-        if (i % (PERF_NUM_STEPS / 10) == 1) {
-            std::cout << "Step " << i / (PERF_NUM_STEPS / 10) + 1 << " of 10\n";
-        }
-
-        u32 size = PERF_SIZE;
+    Benchmark benchmark(config);
+    u32 size = PERF_SIZE;
+
+    std::vector<std::pair<u32, u32>> queries(PERF_NUM_QUERIES);
+    for (auto& p : queries) {
+        u32 l = randint(0, size - 1);
+        u32 r = randint(0, size - 1);
+        p.first = std::min(l, r);
+        p.second = std::max(l, r);
+    }
 
-        /* Sequential construction time */
+    benchmark.run_sequential("dsu/sequential_construction", size, [&]() {
         escape(&size);
-        start = currentSeconds();
         SequentialDSU correct(size);
-        finish = currentSeconds();
         escape(&correct);
-        seq_constructon_time += finish - start;
+    });
 
-        /* Parallel construction time */
+    benchmark.run("dsu/parallel_construction", size, [&]() {
         escape(&size);
-        start = currentSeconds();
         DSU to_check(size);
-        finish = currentSeconds();
         escape(&to_check);
-        seq_constructon_time += finish - start;
+    });
 
-        std::vector<std::pair<u32, u32>> queries(randint(1, size * 2));  // 1.5 x size operation at max
-        total_queries += queries.size();
-        for (auto& p : queries) {
-            u32 l = randint(0, size - 1);
-            u32 r = randint(0, size - 1);
-            p.first = std::min(l, r);
-            p.second = std::max(l, r);
+    std::unique_ptr<SequentialDSU> correct;
+    benchmark.run_sequential("dsu/sequential_unite", queries.size(), [&]() {
+        correct.reset(new SequentialDSU(size));
+    }, [&]() {
+        escape(&queries);
+        for (auto p : queries) {
+            correct->unite(p.first, p.second);
         }
+        escape(correct.get());
+    });
 
-        /* Sequential queries */
+    std::unique_ptr<DSU> to_check;
+    benchmark.run("dsu/parallel_unite", queries.size(), [&]() {
+        to_check.reset(new DSU(size));
+    }, [&]() {
         escape(&queries);
-        start = currentSeconds();
+        #pragma omp parallel for
         for (auto p : queries) {
-            correct.unite(p.first, p.second);
+            to_check->unite(p.first, p.second);
         }
-        finish = currentSeconds();
-        escape(&correct);
-        seq_query_time += finish - start;
+        escape(to_check.get());
+    });
 
-        /* Parallel queries */
+    std::unique_ptr<RandomizedDSU> randomized;
+    benchmark.run("dsu/randomized_unite", queries.size(), [&]() {
+        randomized.reset(new RandomizedDSU(size));
+    }, [&]() {
         escape(&queries);
-        start = currentSeconds();
         #pragma omp parallel for
         for (auto p : queries) {
-            to_check.unite(p.first, p.second);
+            randomized->unite(p.first, p.second);
         }
-        finish = currentSeconds();
-        escape(&to_check);
-        par_query_time += finish - start;
-    }
+        escape(randomized.get());
+    });
 
-    std::cout << "Sequential construction time: "
-              << static_cast<double>(seq_constructon_time) / PERF_NUM_STEPS << "\n"
-              << "Sequential query time: "
-              << static_cast<double>(seq_query_time) / PERF_NUM_STEPS << "\n"
-              << "Average unite time: "
-              << static_cast<double>(seq_query_time) / total_queries << "\n";
-
-    std::cout << "Parallel construction time: "
-              << static_cast<double>(par_constructon_time) / PERF_NUM_STEPS << "\n"
-              << "Parallel query time: "
-              << static_cast<double>(par_query_time) / PERF_NUM_STEPS << "\n"
-              << "Average unite time: "
-              << static_cast<double>(par_query_time) / total_queries << "\n";
+    benchmark.report();
 }
 
 int main(int argc, char* argv[]) {
@@ -281,15 +345,24 @@ int main(int argc, char* argv[]) {
     bool no_performance = arguments.count("no_performance");
 
     if (!no_correctness) {
-        check_correctness();
+        check_sequential();
+        check_correctness<DSU>("DSU");
+        check_correctness<RanklessDSU>("RanklessDSU");
+        check_correctness<RandomizedDSUWith<FULL_COMPRESSION>>("RandomizedDSU, full compression");
+        check_correctness<RandomizedDSUWith<PATH_HALVING>>("RandomizedDSU, path halving");
+        check_correctness<RandomizedDSUWith<PATH_SPLITTING>>("RandomizedDSU, path splitting");
     }
 
     if (!no_exceptions) {
-        check_exceptions();
+        check_exceptions<DSU>("DSU");
+        check_exceptions<RanklessDSU>("RanklessDSU");
+        check_exceptions<RandomizedDSU>("RandomizedDSU");
     }
 
     if (!no_performance) {
-        check_performance();
+        BenchmarkConfig defaults;
+        defaults.repetitions = PERF_NUM_STEPS;
+        check_performance(parse_benchmark_args(argc, argv, defaults));
     }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <iostream>
+#include <omp.h>
+#include <vector>
+
+#include "../defs.h"
+#include "../dynamic_mst.h"
+#include "../graph.h"
+#include "../sequential_dsu.h"
+
+const u32 SMALL_NUM_STEPS = 50;
+const u32 SMALL_SIZE = 30;
+
+const u32 NUM_STEPS = 3;
+const u32 MAX_SIZE = 100'000;
+
+/**
+ * Kruskal over alive edges, returns { forest size, forest weight }
+ */
+std::pair<u32, u64> correct_forest(DynamicMST& dynamic_mst) {
+    std::vector<Edge> alive;
+    for (u32 i = 0; i < dynamic_mst.num_edges(); ++i) {
+        if (dynamic_mst.is_alive(i)) alive.push_back(dynamic_mst.edge(i));
+    }
+    std::sort(alive.begin(), alive.end(), [](const Edge& a, const Edge& b) {
+        return a.weight < b.weight;
+    });
+
+    SequentialDSU node_sets(dynamic_mst.num_nodes);
+
+    u32 size = 0;
+    u64 weight = 0;
+    for (const Edge& e : alive) {
+        if (node_sets.unite(e.from, e.to)) {
+            ++size;
+            weight += e.weight;
+        }
+    }
+
+    return { size, weight };
+}
+
+void check_forest(DynamicMST& dynamic_mst) {
+    auto correct = correct_forest(dynamic_mst);
+    auto forest = dynamic_mst.forest();
+
+    SequentialDSU node_sets(dynamic_mst.num_nodes);
+
+    u64 weight = 0;
+    for (const Edge& e : forest) {
+        if (!node_sets.unite(e.from, e.to)) {
+            std::cerr << "Forest has a cycle\n";
+            exit(-1);
+        }
+        weight += e.weight;
+    }
+
+    for (u32 u = 0; u < dynamic_mst.num_nodes; ++u) {
+        for (u32 v : { 0u, u / 2, u }) {
+            if (node_sets.same_set(u, v) != (dynamic_mst.component(u) == dynamic_mst.component(v))) {
+                std::cerr << "Component mismatch for nodes " << u << " and " << v << "\n";
+                exit(-1);
+            }
+        }
+    }
+
+    if (forest.size() != dynamic_mst.forest_size() ||
+        weight != dynamic_mst.forest_weight() ||
+        forest.size() != correct.first ||
+        weight != correct.second) {
+
+        std::cerr << "Forest mismatch:\n"
+                  << "Correct: " << correct.first << " edges, weight " << correct.second << "\n"
+                  << "Incorrect: " << forest.size() << " (" << dynamic_mst.forest_size() << ") edges, weight "
+                  << weight << " (" << dynamic_mst.forest_weight() << ")\n";
+        exit(-1);
+    }
+}
+
+/**
+ * Deletes edges in random batches until the graph is empty,
+ * every batch takes tree_share of its edges from the current forest
+ */
+void run_deletions(DynamicMST& dynamic_mst, u32 batch_size, double tree_share) {
+    check_forest(dynamic_mst);
+
+    while (true) {
+        std::vector<u32> alive, tree;
+        for (u32 i = 0; i < dynamic_mst.num_edges(); ++i) {
+            if (dynamic_mst.is_tree_edge(i)) {
+                tree.push_back(i);
+            } else if (dynamic_mst.is_alive(i)) {
+                alive.push_back(i);
+            }
+        }
+        if (alive.empty() && tree.empty()) break;
+
+        std::vector<u32> batch;
+        for (u32 i = 0; i < batch_size; ++i) {
+            bool from_tree = alive.empty() || (!tree.empty() && randint(0, 999) < tree_share * 1000);
+            const std::vector<u32>& source = from_tree ? tree : alive;
+            batch.push_back(source[randint(0, source.size() - 1)]);
+        }
+
+        dynamic_mst.delete_edges(batch);
+        check_forest(dynamic_mst);
+    }
+}
+
+int main() {
+    std::cout << "Checking small graphs:\n";
+    for (u32 size = 2; size <= SMALL_SIZE; ++size) {
+        std::cout << "Size: " << size << "\n";
+        for (u32 step = 1; step <= SMALL_NUM_STEPS; ++step) {
+            Graph G = generate_graph(size, randint(size - 1, size * 3));
+            DynamicMST dynamic_mst(G);
+            run_deletions(dynamic_mst, randint(1, size), 0.5);
+        }
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking large graphs:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        std::cout << "Step " << step << " of " << NUM_STEPS << "\n";
+        u32 size = randint(MAX_SIZE / 10, MAX_SIZE);
+        Graph G = generate_graph(size, size * 3);
+        DynamicMST dynamic_mst(G);
+
+        for (u32 batch = 0; batch < 5; ++batch) {
+            std::vector<u32> ids;
+            for (u32 i = 0; i < 1000; ++i) ids.push_back(randint(0, dynamic_mst.num_edges() - 1));
+            dynamic_mst.delete_edges(ids);
+            check_forest(dynamic_mst);
+        }
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "../boruvka.h"
+#include "../compressed_graph.h"
+#include "../defs.h"
+#include "../edge_kernels.h"
+#include "../graph.h"
+#include "../prefix_sum.h"
+#include "../simd.h"
+
+/**
+ * Graphs with more than 2^32 edges don't fit in memory here, so 64 bit edge ids
+ * are checked on small graphs: BoruvkaMST<W, I, u64> should return the same forests as the u32 version,
+ * kernels with 64 bit positions should find the same edges, PrefixSum<u32, u64> shouldn't overflow
+ */
+const u32 NUM_STEPS = 50;
+const u32 MAX_NODES = 5'000;
+const u32 MAX_THREADS = 4;
+
+void fail(const std::string& what, u32 step) {
+    std::cerr << what << " mismatch on step " << step << "\n";
+    exit(-1);
+}
+
+template<typename Ids>
+std::vector<u64> sorted_ids(const Ids& ids) {
+    std::vector<u64> sorted(ids.begin(), ids.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+template<typename W>
+void check_forests(const std::string& name) {
+    std::cout << "Checking " << name << ":\n";
+
+    BoruvkaMST<W> boruvka(0);
+    BoruvkaMST<W> boruvka_cutoff;
+    BoruvkaMST<W, u32, u64> wide(0);
+    BoruvkaMST<W, u32, u64> wide_cutoff;
+
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(2, MAX_NODES);
+        BasicGraph<W> G = generate_graph<W>(num_nodes, randint(num_nodes - 1, 5 * num_nodes));
+        u32 threads = randint(1, MAX_THREADS);
+
+        if (sorted_ids(wide.calculate_mst_ids(G, threads)) != sorted_ids(boruvka.calculate_mst_ids(G, threads))) {
+            fail("Forest", step);
+        }
+        if (sorted_ids(wide_cutoff.calculate_mst_ids(G, threads)) !=
+            sorted_ids(boruvka_cutoff.calculate_mst_ids(G, threads))) {
+            fail("Forest with cutoff", step);
+        }
+    }
+    std::cout << "OK\n";
+}
+
+int main() {
+    std::cout << "Checking prefix sums of u32 into u64:\n";
+    for (u64 size : { 1ULL, 1'000ULL, 100'000ULL }) {
+        ParallelArray<u32> arr(size);
+        for (u64 i = 0; i < size; ++i) arr[i] = std::numeric_limits<u32>::max() - i % 7;
+
+        PrefixSum<u32, u64> prefix(size, arr);
+        u64 sum = 0;
+        for (u64 i = 0; i < size; ++i) {
+            sum += arr[i];
+            if (prefix[i] != sum) fail("Prefix sum", size);
+        }
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking min edge kernels with 64 bit positions:\n";
+    for (u32 level = 0; level < NUM_SIMD_LEVELS; ++level) {
+        if (!simd_level_supported(static_cast<SimdLevel>(level))) continue;
+
+        for (u32 step = 1; step <= NUM_STEPS; ++step) {
+            u32 size = randint(1, 10'000);
+            u32 num_nodes = randint(1, size);
+
+            std::vector<u32> from(size), weight(size);
+            for (u32 i = 0; i < size; ++i) {
+                from[i] = randint(0, num_nodes - 1);
+                weight[i] = randint(0, 100);
+            }
+            std::sort(from.begin(), from.end());
+
+            std::vector<u64> run_start(num_nodes);
+            for (u32 i = 0; i < size; ++i) {
+                if (i == 0 || from[i - 1] != from[i]) run_start[from[i]] = i;
+            }
+
+            ParallelArray<atomic_u64> narrow(num_nodes), wide(num_nodes);
+            for (u32 u = 0; u < num_nodes; ++u) {
+                narrow[u] = std::numeric_limits<u64>::max();
+                wide[u] = std::numeric_limits<u64>::max();
+            }
+
+            u32 begin = randint(0, size - 1);
+            u32 end = randint(begin + 1, size);
+            SimdLevel simd_level = static_cast<SimdLevel>(level);
+            min_edge_kernel(simd_level, from.data(), weight.data(), begin, end, narrow.begin());
+            min_edge_kernel(simd_level, from.data(), weight.data(), u64(begin), u64(end), wide.begin(), run_start.data());
+
+            for (u32 u = 0; u < num_nodes; ++u) {
+                if (narrow[u] == std::numeric_limits<u64>::max()) {
+                    if (wide[u] != narrow[u]) fail("Empty node", step);
+                } else if (wide[u] >> 32 != narrow[u] >> 32 ||
+                           run_start[u] + static_cast<u32>(wide[u]) != static_cast<u32>(narrow[u])) {
+                    fail(std::string(SIMD_LEVEL_NAMES[level]) + " kernel", step);
+                }
+            }
+        }
+    }
+    std::cout << "OK\n";
+
+    check_forests<u32>("u32 weights");
+    check_forests<u64>("u64 weights");
+
+    std::cout << "Checking compressed graphs:\n";
+    BoruvkaMST<> boruvka;
+    BoruvkaMST<u32, u32, u64> wide;
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(2, MAX_NODES);
+        CompressedGraph compressed(generate_graph(num_nodes, randint(num_nodes - 1, 5 * num_nodes)));
+        if (sorted_ids(wide.calculate_mst_ids(compressed)) != sorted_ids(boruvka.calculate_mst_ids(compressed))) {
+            fail("Compressed forest", step);
+        }
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking exceptions:\n";
+    try {
+        Graph G(3, 2);
+        for (u32 u = 0; u < 3; ++u) G.nodes[u] = u;
+        G.edges[0] = Edge(2, 0, 1);
+        G.edges[1] = Edge(0, 2, 1);
+        wide.calculate_mst_ids(G);
+        std::cerr << "Unsorted edges got 64 bit ids\n";
+        exit(-1);
+    } catch (std::invalid_argument& e) {
+        std::cout << "std::invalid_argument\n" << e.what() << "\n";
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../boruvka.h"
+#include "../defs.h"
+#include "../edge_kernels.h"
+#include "../graph.h"
+#include "../sequential_mst.h"
+#include "../simd.h"
+
+const u32 NUM_STEPS = 200;
+const u32 MAX_SIZE = 10'000;
+
+const u32 NUM_GRAPHS = 5;
+const u32 GRAPH_SIZE = 30'000;
+
+std::mt19937 rng(std::random_device{}());
+
+u32 random_int(u32 l, u32 r) {
+    return std::uniform_int_distribution<u32>(l, r)(rng);
+}
+
+/**
+ * Every supported level should give exactly the same results as the scalar kernels,
+ * from is sorted in half of the steps and weights are small to get many ties
+ */
+void check_kernels(SimdLevel level) {
+    std::cout << "Checking " << SIMD_LEVEL_NAMES[level] << " kernels:\n";
+
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 size = random_int(1, MAX_SIZE);
+        u32 num_nodes = random_int(1, size);
+        u32 max_weight = random_int(0, 100);
+
+        std::vector<u32> from(size), to(size), weight(size);
+        for (u32 i = 0; i < size; ++i) {
+            from[i] = random_int(0, num_nodes - 1);
+            to[i] = random_int(0, num_nodes - 1);
+            weight[i] = random_int(0, max_weight);
+        }
+        if (step % 2 == 0) std::sort(from.begin(), from.end());
+
+        u32 begin = random_int(0, size - 1);
+        u32 end = random_int(begin + 1, size);
+
+        ParallelArray<atomic_u64> correct(num_nodes), to_check(num_nodes);
+        for (u32 i = 0; i < num_nodes; ++i) {
+            correct[i] = std::numeric_limits<u64>::max();
+            to_check[i] = std::numeric_limits<u64>::max();
+        }
+
+        min_edge_kernel(SCALAR_LEVEL, from.data(), weight.data(), begin, end, correct.begin());
+        min_edge_kernel(level, from.data(), weight.data(), begin, end, to_check.begin());
+
+        for (u32 i = 0; i < num_nodes; ++i) {
+            if (correct[i] != to_check[i]) {
+                std::cerr << "min_edge_kernel mismatch on node " << i << ": expected " << correct[i]
+                          << " got " << to_check[i] << "\n";
+                exit(-1);
+            }
+        }
+
+        std::vector<u32> component(num_nodes);
+        for (u32& c : component) c = random_int(0, num_nodes - 1);
+
+        std::vector<u32> correct_from = from, correct_to = to, correct_remains(size, 7);
+        std::vector<u32> remains(size, 7);
+
+        relabel_edges_kernel(SCALAR_LEVEL, correct_from.data(), correct_to.data(), component.data(),
+                             correct_remains.data(), begin, end);
+        relabel_edges_kernel(level, from.data(), to.data(), component.data(), remains.data(), begin, end);
+
+        if (from != correct_from || to != correct_to || remains != correct_remains) {
+            std::cerr << "relabel_edges_kernel mismatch on size " << size << "\n";
+            exit(-1);
+        }
+    }
+    std::cout << "OK\n";
+}
+
+void check_boruvka(SimdLevel level) {
+    std::cout << "Checking BoruvkaMST with " << SIMD_LEVEL_NAMES[level] << " kernels:\n";
+
+    BoruvkaMST boruvka(0, level);
+    KruskalMST kruskal;
+
+    for (u32 step = 1; step <= NUM_GRAPHS; ++step) {
+        Graph G = generate_graph(GRAPH_SIZE, GRAPH_SIZE * 5);
+
+        u64 weight_correct = 0;
+        for (u32 id : kruskal.calculate_mst_ids(G)) weight_correct += G.edges[id].weight;
+
+        u64 weight_to_check = 0;
+        for (u32 id : boruvka.calculate_mst_ids(G)) weight_to_check += G.edges[id].weight;
+
+        if (weight_to_check != weight_correct) {
+            std::cerr << "Weights don't match!\nCorrect: " << weight_correct << "\nIncorrect: " << weight_to_check << "\n";
+            exit(-1);
+        }
+    }
+    std::cout << "OK\n";
+}
+
+int main() {
+    std::cout << "Detected: " << SIMD_LEVEL_NAMES[detect_simd_level()] << "\n";
+
+    for (u32 level = 0; level < NUM_SIMD_LEVELS; ++level) {
+        if (!simd_level_supported(static_cast<SimdLevel>(level))) continue;
+
+        check_kernels(static_cast<SimdLevel>(level));
+        check_boruvka(static_cast<SimdLevel>(level));
+    }
+
+    std::cout << "Checking relabel levels:\n";
+    for (u32 level = 0; level < NUM_SIMD_LEVELS; ++level) {
+        if (relabel_level(static_cast<SimdLevel>(level), MAX_GATHER_NODES) != level ||
+            relabel_level(static_cast<SimdLevel>(level), MAX_GATHER_NODES + 1) != SCALAR_LEVEL) {
+            std::cerr << "Gathers are used past 2^31 nodes\n";
+            exit(-1);
+        }
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
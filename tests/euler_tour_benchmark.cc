@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../benchmark.h"
+#include "../euler_tour.h"
+#include "../graph.h"
+#include "../list_ranking.h"
+
+/**
+ * Registered benchmarks of tree rooting, see run_registered_benchmarks() for arguments
+ * size is the number of nodes
+ *
+ * Trees are random recursive trees with shuffled labels, the shape of a spanning tree
+ * of a random graph, edges come in a random order and direction like BoruvkaMST output
+ *
+ * euler_tour/root_forest_sequential is the DFS with adjacency vectors consumers used to run,
+ * list_ranking benchmarks rank one random list of size elements
+ */
+ParallelArray<Edge> random_tree(u64 size) {
+    std::mt19937 gen(size);
+    std::vector<u32> label(size);
+    std::iota(label.begin(), label.end(), 0);
+    std::shuffle(label.begin(), label.end(), gen);
+
+    ParallelArray<Edge> edges(size - 1);
+    for (u32 i = 1; i < size; ++i) {
+        u32 p = gen() % i;
+        edges[i - 1] = (gen() & 1 ? Edge(label[i], label[p], 0) : Edge(label[p], label[i], 0));
+    }
+    std::shuffle(edges.begin(), edges.end(), gen);
+    return edges;
+}
+
+struct RandomList {
+    ParallelArray<u32> next;
+    u32 head;
+
+    RandomList(u64 size) : next(size) {
+        std::mt19937 gen(size);
+        std::vector<u32> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), gen);
+
+        for (u32 i = 0; i < size; ++i) {
+            next[order[i]] = (i + 1 < size ? order[i + 1] : LIST_END);
+        }
+        head = order[0];
+    }
+};
+
+REGISTER_BENCHMARK("euler_tour/root_forest", SIZES(1'000'000, 10'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<Edge> edges = random_tree(size);
+
+    benchmark.run(name, size, [&]() {
+        RootedForest forest(size, edges);
+        escape(&forest);
+    });
+});
+
+REGISTER_BENCHMARK("euler_tour/root_forest_sequential", SIZES(1'000'000, 10'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<Edge> edges = random_tree(size);
+
+    benchmark.run(name, size, [&]() {
+        RootedForest forest = root_forest_sequential(size, edges);
+        escape(&forest);
+    });
+});
+
+REGISTER_BENCHMARK("list_ranking/rank_list", SIZES(1'000'000, 10'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    RandomList list(size);
+
+    benchmark.run(name, size, [&]() {
+        ParallelArray<u32> rank = rank_list(list.next, list.head);
+        escape(&rank);
+    });
+});
+
+REGISTER_BENCHMARK("list_ranking/rank_list_sequential", SIZES(1'000'000, 10'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    RandomList list(size);
+
+    benchmark.run(name, size, [&]() {
+        ParallelArray<u32> rank = rank_list_sequential(list.next, list.head);
+        escape(&rank);
+    });
+});
+
+BENCHMARK_MAIN()
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../boruvka.h"
+#include "../defs.h"
+#include "../euler_tour.h"
+#include "../graph.h"
+#include "../list_ranking.h"
+#include "../utils.h"
+
+/**
+ * Compares rank_list() with a walk and RootedForest with a sequential DFS
+ * Lists and forests are large enough for the parallel paths, forests have random shapes and labels
+ */
+const u32 NUM_STEPS = 30;
+const u32 MAX_NODES = 300'000;
+const u32 MAX_THREADS = 8;
+
+void fail(const std::string& what, u32 step) {
+    std::cerr << what << " mismatch on step " << step << "\n";
+    exit(-1);
+}
+
+/* Random forest: node i hangs under one of the previous max_fanin nodes or starts a new tree, labels are shuffled */
+ParallelArray<Edge> random_forest(u32 num_nodes, u32 max_fanin, u32 new_tree_chance) {
+    std::vector<u32> label(num_nodes);
+    std::iota(label.begin(), label.end(), 0);
+    std::shuffle(label.begin(), label.end(), gen);
+
+    std::vector<Edge> edges;
+    for (u32 i = 1; i < num_nodes; ++i) {
+        if (randint(0, new_tree_chance) == 0) continue;
+        u32 p = randint(i > max_fanin ? i - max_fanin : 0, i - 1);
+        edges.push_back(randint(0, 1) ? Edge(label[i], label[p], 0) : Edge(label[p], label[i], 0));
+    }
+
+    ParallelArray<Edge> result(edges.size());
+    std::copy(edges.begin(), edges.end(), result.begin());
+    return result;
+}
+
+/**
+ * Children may come in another order than in the DFS, so preorder is checked to be a preorder:
+ * a permutation where the subtree of every node is right after it, nested in the subtree of its parent
+ */
+void compare_forests(const RootedForest& forest, const RootedForest& expected, u32 step) {
+    u32 num_nodes = expected.num_nodes();
+    std::vector<u32> seen(num_nodes);
+
+    for (u32 u = 0; u < num_nodes; ++u) {
+        if (forest.parent[u] != expected.parent[u]) fail("Parent", step);
+        if (forest.depth[u] != expected.depth[u]) fail("Depth", step);
+        if (forest.subtree_size[u] != expected.subtree_size[u]) fail("Subtree size", step);
+
+        if (forest.preorder[u] >= num_nodes || seen[forest.preorder[u]]++) fail("Preorder permutation", step);
+        if (forest.is_root(u)) {
+            if (forest.preorder[u] != expected.preorder[u]) fail("Preorder of root", step);
+        } else {
+            u32 p = forest.parent[u];
+            if (forest.preorder[u] <= forest.preorder[p] ||
+                forest.preorder[u] + forest.subtree_size[u] > forest.preorder[p] + forest.subtree_size[p]) {
+                fail("Preorder", step);
+            }
+        }
+    }
+}
+
+int main() {
+    std::cout << "Checking list ranking:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 size = randint(1, MAX_NODES);
+        std::vector<u32> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), gen);
+
+        ParallelArray<u32> next(size), weight(size);
+        for (u32 i = 0; i < size; ++i) {
+            next[order[i]] = (i + 1 < size ? order[i + 1] : LIST_END);
+            weight[i] = randint(0, 100);
+        }
+
+        u32 threads = randint(2, MAX_THREADS);
+        const u32* weights = (step % 2 == 0 ? weight.begin() : nullptr);
+        ParallelArray<u32> rank = rank_list(next, order[0], weights, threads);
+        ParallelArray<u32> expected = rank_list_sequential(next, order[0], weights);
+        if (!std::equal(rank.begin(), rank.end(), expected.begin())) fail("Rank", step);
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking random forests:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(1, MAX_NODES);
+        /* Small fan-in makes deep trees, large fan-in makes wide ones */
+        ParallelArray<Edge> edges = random_forest(num_nodes, randint(1, num_nodes), randint(0, 1'000));
+
+        RootedForest forest(num_nodes, edges, randint(1, MAX_THREADS));
+        compare_forests(forest, root_forest_sequential(num_nodes, edges), step);
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking minimum spanning trees:\n";
+    BoruvkaMST boruvka;
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(2, MAX_NODES / 10);
+        Graph G = generate_graph(num_nodes, randint(num_nodes - 1, 5 * num_nodes));
+        ParallelArray<Edge> mst = boruvka.calculate_mst(G);
+
+        RootedForest forest(num_nodes, mst, randint(1, MAX_THREADS));
+        compare_forests(forest, root_forest_sequential(num_nodes, mst), step);
+        if (forest.subtree_size[0] != num_nodes) fail("Spanning tree size", step);
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking exceptions:\n";
+    try {
+        ParallelArray<Edge> cycle(3);
+        cycle[0] = Edge(0, 1, 0);
+        cycle[1] = Edge(1, 2, 0);
+        cycle[2] = Edge(2, 0, 0);
+        RootedForest forest(3, cycle);
+        std::cerr << "Cycle was rooted\n";
+        exit(-1);
+    } catch (std::invalid_argument& e) {
+        std::cout << "std::invalid_argument\n" << e.what() << "\n";
+    }
+
+    try {
+        ParallelArray<Edge> edges(1);
+        edges[0] = Edge(0, 3, 0);
+        RootedForest forest(3, edges);
+        std::cerr << "Edge to a missing node was rooted\n";
+        exit(-1);
+    } catch (std::out_of_range& e) {
+        std::cout << "std::out_of_range\n" << e.what() << "\n";
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../benchmark.h"
+#include "../boruvka.h"
+#include "../compressed_graph.h"
+#include "../graph.h"
+
+const u32 AVERAGE_DEGREE = 10;
+
+/**
+ * Registered benchmarks of graph generation and storage, see run_registered_benchmarks() for arguments
+ * size is the number of nodes, graphs have AVERAGE_DEGREE * size edges
+ *
+ * graph/compress reports bytes_per_edge of Graph and of CompressedGraph,
+ * graph/scan/... benchmarks sum weights of edges going up in node ids, the scan of a min-edge search
+ *
+ * graph/load/... benchmarks read a graph file written beforehand: read is the raw bytes, the floor for the others,
+ * staged reads every line first, then symmetrizes and sorts all edges, like load_graph() did before pipelining,
+ * pipelined is load_graph() and mst is load_graph() followed by BoruvkaMST, the time to the first MST
+ */
+REGISTER_BENCHMARK("graph/generate_graph", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    benchmark.run(name, size * AVERAGE_DEGREE, [&]() {
+        Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+        escape(&G);
+    });
+});
+
+REGISTER_BENCHMARK("graph/compress", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+    double graph_bytes = static_cast<double>(G.num_edges()) * sizeof(Edge) + G.num_nodes() * sizeof(u32);
+
+    for (u32 threads : benchmark.config.threads) {
+        u64 compressed_bytes = 0;
+        benchmark.measure(name, threads, G.num_edges(), []() {}, [&]() {
+            CompressedGraph compressed(G, threads);
+            compressed_bytes = compressed.size_in_bytes();
+            escape(&compressed);
+        });
+        benchmark.set_metric("graph_bytes_per_edge", graph_bytes / G.num_edges());
+        benchmark.set_metric("compressed_bytes_per_edge", static_cast<double>(compressed_bytes) / G.num_edges());
+    }
+});
+
+u64 scan_edges(const Graph& G) {
+    u64 sum = 0;
+    #pragma omp parallel for reduction(+:sum)
+    for (u32 i = 0; i < G.num_edges(); ++i) {
+        const Edge& e = G.edges[i];
+        if (e.from < e.to) sum += e.weight;
+    }
+    return sum;
+}
+
+u64 scan_compressed(const CompressedGraph& compressed) {
+    u64 sum = 0;
+    #pragma omp parallel for reduction(+:sum)
+    for (u32 b = 0; b < compressed.num_blocks(); ++b) {
+        compressed.for_each_edge_in_block(b, [&](u32, u32 from, u32 to, u32 weight) {
+            if (from < to) sum += weight;
+        });
+    }
+    return sum;
+}
+
+REGISTER_BENCHMARK("graph/scan/edges", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+
+    benchmark.run(name, G.num_edges(), [&]() {
+        u64 sum = scan_edges(G);
+        escape(&sum);
+    });
+});
+
+REGISTER_BENCHMARK("graph/scan/compressed", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    CompressedGraph compressed(generate_graph(size, size * AVERAGE_DEGREE));
+
+    benchmark.run(name, compressed.num_edges(), [&]() {
+        u64 sum = scan_compressed(compressed);
+        escape(&sum);
+    });
+});
+
+/* Unweighted graph file in the format of load_graph(), removed when the benchmark ends */
+struct GraphFile {
+    std::string path;
+
+    GraphFile(u64 size) : path((std::filesystem::temp_directory_path() /
+                                ("graph_benchmark_" + std::to_string(size) + ".txt")).string()) {
+        Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+        std::ofstream out(path);
+        out << G.num_nodes() << "\n" << G.num_edges() / 2 << "\n";
+        for (const Edge& e : G.edges) {
+            if (e.from < e.to) out << e.from << " " << e.to << "\n";
+        }
+    }
+
+    ~GraphFile() {
+        std::remove(path.c_str());
+    }
+};
+
+Graph load_graph_staged(const std::string& path) {
+    std::ifstream in(path);
+    u32 num_nodes;
+    u64 num_edges;
+    in >> num_nodes >> num_edges;
+
+    std::vector<std::pair<u32, u32>> lines(num_edges);
+    for (u64 i = 0; i < num_edges; ++i) {
+        in >> lines[i].first >> lines[i].second;
+    }
+
+    Graph G(num_nodes, 2 * num_edges);
+    parallel_iota(G.nodes.begin(), num_nodes, 0u);
+    for (u64 i = 0; i < num_edges; ++i) {
+        u32 weight = gen();
+        G.edges[2 * i] = Edge(lines[i].first, lines[i].second, weight);
+        G.edges[2 * i + 1] = Edge(lines[i].second, lines[i].first, weight);
+    }
+    G.sort_edges();
+    return G;
+}
+
+REGISTER_BENCHMARK("graph/load/read", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    GraphFile file(size);
+
+    benchmark.run(name, size * AVERAGE_DEGREE, [&]() {
+        std::ifstream in(file.path, std::ios::binary);
+        std::stringstream text;
+        text << in.rdbuf();
+        escape(&text);
+    });
+});
+
+REGISTER_BENCHMARK("graph/load/staged", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    GraphFile file(size);
+
+    benchmark.run(name, size * AVERAGE_DEGREE, [&]() {
+        Graph G = load_graph_staged(file.path);
+        escape(&G);
+    });
+});
+
+REGISTER_BENCHMARK("graph/load/pipelined", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    GraphFile file(size);
+
+    benchmark.run(name, size * AVERAGE_DEGREE, [&]() {
+        Graph G = load_graph(file.path);
+        escape(&G);
+    });
+});
+
+REGISTER_BENCHMARK("graph/load/mst", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    GraphFile file(size);
+    BoruvkaMST boruvka;
+
+    benchmark.run(name, size * AVERAGE_DEGREE, [&]() {
+        auto mst = boruvka.calculate_mst_ids(load_graph(file.path));
+        escape(&mst);
+    });
+});
+
+BENCHMARK_MAIN()
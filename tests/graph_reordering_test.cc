@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../boruvka.h"
+#include "../defs.h"
+#include "../graph.h"
+#include "../graph_reordering.h"
+#include "../utils.h"
+
+/**
+ * Checks orders against their definitions on one thread, relabeled graphs against the input
+ * and BoruvkaMST with every order against the original one
+ * BFS order doesn't depend on the number of threads, so it is equal to a queue BFS
+ */
+const u32 NUM_STEPS = 30;
+const u32 MAX_NODES = 20'000;
+const u32 MAX_THREADS = 8;
+const u32 MANY_COMPONENTS_NODES = 200'000;
+
+void fail(const std::string& what, u32 step) {
+    std::cerr << what << " mismatch on step " << step << "\n";
+    exit(-1);
+}
+
+std::vector<u32> sequential_bfs_order(const Graph& G) {
+    const u32 UNVISITED = std::numeric_limits<u32>::max();
+    std::vector<u32> new_id(G.num_nodes(), UNVISITED);
+    u32 next_id = 0;
+
+    for (u32 start = 0; start < G.num_nodes(); ++start) {
+        if (new_id[start] != UNVISITED) continue;
+
+        std::queue<u32> queue;
+        queue.push(start);
+        new_id[start] = next_id++;
+        while (!queue.empty()) {
+            u32 u = queue.front();
+            queue.pop();
+            auto first = std::lower_bound(G.edges.begin(), G.edges.end(), Edge(u, 0, 0));
+            for (auto e = first; e != G.edges.end() && e->from == u; ++e) {
+                if (new_id[e->to] == UNVISITED) {
+                    new_id[e->to] = next_id++;
+                    queue.push(e->to);
+                }
+            }
+        }
+    }
+
+    return new_id;
+}
+
+std::vector<u32> sequential_degree_order(const Graph& G) {
+    std::vector<u32> degree(G.num_nodes()), order(G.num_nodes()), new_id(G.num_nodes());
+    for (const Edge& e : G.edges) ++degree[e.from];
+    for (u32 u = 0; u < G.num_nodes(); ++u) order[u] = u;
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+        return degree[a] > degree[b];
+    });
+    for (u32 i = 0; i < G.num_nodes(); ++i) new_id[order[i]] = i;
+    return new_id;
+}
+
+u64 total_weight(const Graph& G, const ParallelArray<u32>& ids) {
+    u64 weight = 0;
+    for (u32 id : ids) weight += G.edges[id].weight;
+    return weight;
+}
+
+int main() {
+    std::cout << "Checking orders and relabeled graphs:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(2, MAX_NODES);
+        /* Some nodes stay isolated, so the BFS has several components */
+        Graph G = generate_graph(num_nodes, randint(num_nodes - 1, 5 * num_nodes));
+        if (step % 3 == 0) {
+            Graph sparse(num_nodes, G.num_edges() / 10 * 2);
+            for (u64 i = 0; i < sparse.num_edges(); i += 2) {
+                sparse.edges[i] = G.edges[i];
+                sparse.edges[i + 1] = Edge(G.edges[i].to, G.edges[i].from, G.edges[i].weight);
+            }
+            sparse.sort_edges();
+            G.edges.swap(sparse.edges);
+        }
+        u32 threads = randint(1, MAX_THREADS);
+
+        ParallelArray<u32> bfs = bfs_order(GraphView(G), threads);
+        if (!std::equal(bfs.begin(), bfs.end(), sequential_bfs_order(G).begin())) fail("BFS order", step);
+
+        ParallelArray<u32> degree = degree_order(GraphView(G), threads);
+        if (!std::equal(degree.begin(), degree.end(), sequential_degree_order(G).begin())) fail("Degree order", step);
+
+        ReorderedGraph reordered(G, static_cast<NodeOrder>(randint(0, NUM_NODE_ORDERS - 1)), threads);
+        if (!std::is_sorted(reordered.graph.edges.begin(), reordered.graph.edges.end())) fail("Sorted edges", step);
+
+        ParallelArray<Edge> original = reordered.to_original_edges(reordered.graph.edges);
+        for (u64 i = 0; i < G.num_edges(); ++i) {
+            const Edge& e = G.edges[reordered.old_edge_id[i]];
+            if (original[i].from != e.from || original[i].to != e.to || original[i].weight != e.weight) {
+                fail("Original edge", step);
+            }
+        }
+        for (u32 u = 0; u < num_nodes; ++u) {
+            if (reordered.old_id[reordered.new_id[u]] != u || reordered.graph.nodes[u] != u) fail("Permutation", step);
+        }
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking BFS order with many components:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        /* Mostly isolated nodes and short paths, with one large component walked in parallel */
+        u32 num_nodes = randint(2, MANY_COMPONENTS_NODES);
+        Graph dense = generate_graph(std::min(num_nodes, MAX_NODES), 5 * std::min(num_nodes, MAX_NODES));
+        std::vector<Edge> edges(dense.edges.begin(), dense.edges.end());
+        for (u32 u = dense.num_nodes(); u + 1 < num_nodes; ++u) {
+            if (randint(0, 3) != 0) continue;
+            u32 weight = randint(1, 1'000'000);
+            edges.push_back(Edge(u, u + 1, weight));
+            edges.push_back(Edge(u + 1, u, weight));
+        }
+
+        Graph G(num_nodes, edges.size());
+        for (u32 u = 0; u < num_nodes; ++u) G.nodes[u] = u;
+        std::copy(edges.begin(), edges.end(), G.edges.begin());
+        G.sort_edges();
+
+        ParallelArray<u32> bfs = bfs_order(GraphView(G), randint(1, MAX_THREADS));
+        if (!std::equal(bfs.begin(), bfs.end(), sequential_bfs_order(G).begin())) fail("BFS order", step);
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking BoruvkaMST with node orders:\n";
+    BoruvkaMST boruvka;
+    BoruvkaMST boruvka_degree(BoruvkaMST<>::AUTO_CUTOFF, detect_simd_level(), DEGREE_ORDER);
+    BoruvkaMST boruvka_bfs(BoruvkaMST<>::AUTO_CUTOFF, detect_simd_level(), BFS_ORDER);
+
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(2, MAX_NODES);
+        Graph G = generate_graph(num_nodes, randint(num_nodes - 1, 5 * num_nodes));
+        u32 threads = randint(1, MAX_THREADS);
+
+        ParallelArray<u32> expected = boruvka.calculate_mst_ids(G, threads);
+        ParallelArray<u32> degree_ids = boruvka_degree.calculate_mst_ids(G, threads);
+        ParallelArray<u32> bfs_ids = boruvka_bfs.calculate_mst_ids(G, threads);
+
+        if (degree_ids.size() != expected.size() || total_weight(G, degree_ids) != total_weight(G, expected)) {
+            fail("Degree order forest", step);
+        }
+        if (bfs_ids.size() != expected.size() || total_weight(G, bfs_ids) != total_weight(G, expected)) {
+            fail("BFS order forest", step);
+        }
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking exceptions:\n";
+    try {
+        Graph G(3, 2);
+        for (u32 u = 0; u < 3; ++u) G.nodes[u] = u;
+        G.edges[0] = Edge(2, 0, 1);
+        G.edges[1] = Edge(0, 2, 1);
+        ReorderedGraph reordered(G, BFS_ORDER);
+        std::cerr << "Unsorted edges were reordered\n";
+        exit(-1);
+    } catch (std::invalid_argument& e) {
+        std::cout << "std::invalid_argument\n" << e.what() << "\n";
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../benchmark.h"
+#include "../concurrent_hash_table.h"
+#include "../parallel_array.h"
+
+/**
+ * Registered benchmarks of ConcurrentHashTable, see run_registered_benchmarks() for arguments,
+ * run them with threads=1,2,4,8,16,32,64 for scaling
+ *
+ * size is the number of operations, keys are packed pairs (u, v) of ids below sqrt(size * DUPLICATE_RATIO),
+ * so a key repeats DUPLICATE_RATIO times on average, like parallel edges between super-vertices,
+ * values are random (weight << 32) | id encodings of edges
+ *
+ * hash_table/<operation>_unordered_map are the same operations on std::unordered_map under omp critical,
+ * what hot paths fall back to without a concurrent table
+ */
+const u32 DUPLICATE_RATIO = 4;
+
+struct HashTableWorkload {
+    ParallelArray<u64> keys;
+    ParallelArray<u64> values;
+    u64 num_keys;
+
+    HashTableWorkload(u64 size) : keys(size), values(size) {
+        u32 max_id = std::max<u64>(1, std::sqrt(static_cast<double>(size / DUPLICATE_RATIO)));
+        std::mt19937 gen(size);
+
+        std::vector<u64> sorted(size);
+        for (u64 i = 0; i < size; ++i) {
+            keys[i] = ConcurrentHashTable::pack_pair(gen() % max_id, gen() % max_id);
+            values[i] = (static_cast<u64>(gen()) << 32) | i;
+            sorted[i] = keys[i];
+        }
+
+        std::sort(sorted.begin(), sorted.end());
+        num_keys = std::unique(sorted.begin(), sorted.end()) - sorted.begin();
+    }
+};
+
+void run_insert(Benchmark& benchmark, const std::string& name, u64 size) {
+    HashTableWorkload workload(size);
+    ConcurrentHashTable table(workload.num_keys);
+
+    benchmark.run(name, size, [&]() {
+        table.clear();
+    }, [&]() {
+        #pragma omp parallel for
+        for (u64 i = 0; i < size; ++i) {
+            table.insert(workload.keys[i], workload.values[i]);
+        }
+        escape(&table);
+    });
+}
+
+void run_update_min(Benchmark& benchmark, const std::string& name, u64 size) {
+    HashTableWorkload workload(size);
+    ConcurrentHashTable table(workload.num_keys);
+
+    benchmark.run(name, size, [&]() {
+        table.clear();
+    }, [&]() {
+        #pragma omp parallel for
+        for (u64 i = 0; i < size; ++i) {
+            table.update_min(workload.keys[i], workload.values[i]);
+        }
+        escape(&table);
+    });
+}
+
+void run_find(Benchmark& benchmark, const std::string& name, u64 size) {
+    HashTableWorkload workload(size);
+    ConcurrentHashTable table(workload.num_keys);
+    for (u64 i = 0; i < size; ++i) {
+        table.insert(workload.keys[i], workload.values[i]);
+    }
+
+    benchmark.run(name, size, [&]() {
+        u64 found = 0;
+        #pragma omp parallel for reduction(+:found)
+        for (u64 i = 0; i < size; ++i) {
+            found += table.find(workload.keys[i] ^ (i & 1)) != ConcurrentHashTable::NOT_FOUND;
+        }
+        escape(&found);
+    });
+}
+
+void run_entries(Benchmark& benchmark, const std::string& name, u64 size) {
+    HashTableWorkload workload(size);
+    ConcurrentHashTable table(workload.num_keys);
+    for (u64 i = 0; i < size; ++i) {
+        table.update_min(workload.keys[i], workload.values[i]);
+    }
+
+    benchmark.run(name, table.num_slots, [&]() {
+        ParallelArray<HashTableEntry> entries = table.entries();
+        escape(&entries);
+    });
+}
+
+void update_min_unordered_map(std::unordered_map<u64, u64>& map, u64 key, u64 value) {
+    auto [it, inserted] = map.emplace(key, value);
+    if (!inserted && it->second > value) it->second = value;
+}
+
+void run_insert_unordered_map(Benchmark& benchmark, const std::string& name, u64 size) {
+    HashTableWorkload workload(size);
+    std::unordered_map<u64, u64> map;
+
+    benchmark.run(name, size, [&]() {
+        map = std::unordered_map<u64, u64>();
+        map.reserve(workload.num_keys);
+    }, [&]() {
+        #pragma omp parallel for
+        for (u64 i = 0; i < size; ++i) {
+            #pragma omp critical
+            map.emplace(workload.keys[i], workload.values[i]);
+        }
+        escape(&map);
+    });
+}
+
+void run_update_min_unordered_map(Benchmark& benchmark, const std::string& name, u64 size) {
+    HashTableWorkload workload(size);
+    std::unordered_map<u64, u64> map;
+
+    benchmark.run(name, size, [&]() {
+        map = std::unordered_map<u64, u64>();
+        map.reserve(workload.num_keys);
+    }, [&]() {
+        #pragma omp parallel for
+        for (u64 i = 0; i < size; ++i) {
+            #pragma omp critical
+            update_min_unordered_map(map, workload.keys[i], workload.values[i]);
+        }
+        escape(&map);
+    });
+}
+
+void run_find_unordered_map(Benchmark& benchmark, const std::string& name, u64 size) {
+    HashTableWorkload workload(size);
+    std::unordered_map<u64, u64> map;
+    for (u64 i = 0; i < size; ++i) {
+        map.emplace(workload.keys[i], workload.values[i]);
+    }
+
+    /* Lookups in a map nobody writes to need no critical section */
+    benchmark.run(name, size, [&]() {
+        u64 found = 0;
+        #pragma omp parallel for reduction(+:found)
+        for (u64 i = 0; i < size; ++i) {
+            found += map.find(workload.keys[i] ^ (i & 1)) != map.end();
+        }
+        escape(&found);
+    });
+}
+
+REGISTER_BENCHMARK("hash_table/insert", SIZES(1'000'000, 10'000'000), run_insert);
+REGISTER_BENCHMARK("hash_table/update_min", SIZES(1'000'000, 10'000'000), run_update_min);
+REGISTER_BENCHMARK("hash_table/find", SIZES(1'000'000, 10'000'000), run_find);
+REGISTER_BENCHMARK("hash_table/entries", SIZES(1'000'000, 10'000'000), run_entries);
+REGISTER_BENCHMARK("hash_table/insert_unordered_map", SIZES(1'000'000, 10'000'000), run_insert_unordered_map);
+REGISTER_BENCHMARK("hash_table/update_min_unordered_map", SIZES(1'000'000, 10'000'000), run_update_min_unordered_map);
+REGISTER_BENCHMARK("hash_table/find_unordered_map", SIZES(1'000'000, 10'000'000), run_find_unordered_map);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../concurrent_hash_table.h"
+#include "../defs.h"
+#include "../utils.h"
+
+/**
+ * Fills tables from several threads and compares them with std::map filled on one thread
+ * Keys are packed pairs of small ids, so they repeat a lot and threads collide on them
+ */
+const u32 NUM_STEPS = 50;
+const u32 MAX_KEYS = 100'000;
+const u32 MAX_THREADS = 8;
+
+void fail(const std::string& what, u32 step) {
+    std::cerr << what << " mismatch on step " << step << "\n";
+    exit(-1);
+}
+
+int main() {
+    std::cout << "Checking random keys:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_ops = randint(1, MAX_KEYS);
+        u32 max_id = randint(1, 1'000);
+        u32 threads = randint(1, MAX_THREADS);
+
+        std::vector<u64> keys(num_ops), values(num_ops);
+        for (u32 i = 0; i < num_ops; ++i) {
+            keys[i] = ConcurrentHashTable::pack_pair(randint(0, max_id), randint(0, max_id));
+            values[i] = randint(0, 1'000'000);
+        }
+
+        std::map<u64, u64> first, minimum;
+        for (u32 i = 0; i < num_ops; ++i) {
+            first.insert({ keys[i], values[i] });
+            auto it = minimum.find(keys[i]);
+            if (it == minimum.end()) {
+                minimum[keys[i]] = values[i];
+            } else {
+                it->second = std::min(it->second, values[i]);
+            }
+        }
+
+        ConcurrentHashTable inserted(randint(first.size(), 2 * num_ops), threads);
+        ConcurrentHashTable lowered(first.size(), threads);
+        std::atomic<u32> successful_inserts(0);
+
+        #pragma omp parallel for num_threads(threads)
+        for (u32 i = 0; i < num_ops; ++i) {
+            if (inserted.insert(keys[i], values[i])) ++successful_inserts;
+            lowered.update_min(keys[i], values[i]);
+        }
+
+        if (successful_inserts != first.size() || inserted.count() != first.size()) fail("Number of keys", step);
+
+        /* Any of the inserted values may win, the rest of them should be rejected */
+        for (const auto& [key, value] : first) {
+            u64 found = inserted.find(key);
+            if (found == ConcurrentHashTable::NOT_FOUND) fail("insert()", step);
+            if (lowered.find(key) != minimum[key]) fail("update_min()", step);
+        }
+        if (inserted.contains(ConcurrentHashTable::pack_pair(max_id + 1, 0))) fail("contains()", step);
+
+        ParallelArray<HashTableEntry> entries = lowered.entries();
+        std::map<u64, u64> compacted;
+        for (const HashTableEntry& e : entries) compacted[e.key] = e.value;
+        if (entries.size() != minimum.size() || compacted != minimum) fail("entries()", step);
+
+        std::atomic<u64> key_sum(0), expected_sum(0);
+        lowered.for_each([&](u64 key, u64 value) {
+            key_sum += key ^ value;
+        });
+        for (const auto& [key, value] : minimum) expected_sum += key ^ value;
+        if (key_sum != expected_sum) fail("for_each()", step);
+
+        lowered.clear();
+        if (lowered.count() != 0 || lowered.contains(keys[0])) fail("clear()", step);
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking exceptions:\n";
+    try {
+        ConcurrentHashTable table(10);
+        table.insert(ConcurrentHashTable::EMPTY_KEY, 1);
+        std::cerr << "Reserved key was inserted\n";
+        exit(-1);
+    } catch (std::invalid_argument& e) {
+        std::cout << "std::invalid_argument\n" << e.what() << "\n";
+    }
+
+    try {
+        ConcurrentHashTable table(1);
+        for (u64 key = 0; key <= table.num_slots; ++key) table.insert(key, key);
+        std::cerr << "Full table took a key\n";
+        exit(-1);
+    } catch (std::out_of_range& e) {
+        std::cout << "std::out_of_range\n" << e.what() << "\n";
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../defs.h"
+#include "../iteration_array.h"
+#include "../parallel_array.h"
+
+/**
+ * Applies random bulk operations to IterationArray and to a vector of flags,
+ * after each of them the active sets should be equal
+ * Sizes of batches vary, so sets go from sparse to dense and back
+ */
+std::mt19937 gen(std::random_device{}());
+
+u32 randint(u32 l, u32 r) {
+    return std::uniform_int_distribution<u32>(l, r)(gen);
+}
+
+const u32 NUM_STEPS = 200;
+const u32 NUM_OPERATIONS = 30;
+const u32 MAX_SIZE = 20'000;
+
+/* Distinct random ids, about fraction of size */
+ParallelArray<u32> random_ids(u32 size, double fraction) {
+    std::vector<u32> ids;
+    for (u32 id = 0; id < size; ++id) {
+        if (std::bernoulli_distribution(fraction)(gen)) ids.push_back(id);
+    }
+    std::shuffle(ids.begin(), ids.end(), gen);
+
+    ParallelArray<u32> result(ids.size());
+    for (u32 i = 0; i < ids.size(); ++i) result[i] = ids[i];
+    return result;
+}
+
+void check_equal(const IterationArray<u32>& set, const std::vector<bool>& expected, u32 step) {
+    u32 expected_count = 0;
+    for (u32 id = 0; id < expected.size(); ++id) {
+        expected_count += expected[id];
+        if (set.contains(id) != expected[id]) {
+            std::cerr << "contains(" << id << ") mismatch on step " << step << "\n";
+            exit(-1);
+        }
+    }
+
+    if (set.count() != expected_count) {
+        std::cerr << "count() is " << set.count() << " instead of " << expected_count << " on step " << step << "\n";
+        exit(-1);
+    }
+
+    std::vector<std::atomic<u32>> visits(expected.size());
+    set.for_each([&](u32 id) {
+        visits[id].fetch_add(1);
+    });
+    for (u32 id = 0; id < expected.size(); ++id) {
+        if (visits[id] != expected[id]) {
+            std::cerr << "for_each() visited " << id << " " << visits[id] << " times on step " << step
+                      << (set.is_sparse() ? ", sparse\n" : ", dense\n");
+            exit(-1);
+        }
+    }
+}
+
+int main() {
+    std::cout << "Checking random operations:\n";
+    u32 sparse_sets = 0, dense_sets = 0;
+
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 size = randint(1, MAX_SIZE);
+        IterationArray<u32> set(size);
+        std::vector<bool> expected(size, false);
+
+        for (u32 i = 0; i < size; ++i) set[i] = i;
+
+        for (u32 operation = 0; operation < NUM_OPERATIONS; ++operation) {
+            double fraction = std::uniform_real_distribution<double>(0, 1)(gen);
+            fraction *= fraction * fraction;
+            ParallelArray<u32> ids = random_ids(size, fraction);
+
+            u32 type = randint(0, 2);
+            if (type == 0) {
+                set.activate(ids);
+                for (u32 id : ids) expected[id] = true;
+            } else if (type == 1) {
+                set.deactivate(ids);
+                for (u32 id : ids) expected[id] = false;
+            } else {
+                u32 modulo = randint(1, 4);
+                set.deactivate_if([&](u32 id) {
+                    return set[id] % modulo == 0;
+                });
+                for (u32 id = 0; id < size; ++id) {
+                    if (id % modulo == 0) expected[id] = false;
+                }
+            }
+
+            (set.is_sparse() ? sparse_sets : dense_sets)++;
+            check_equal(set, expected, step);
+        }
+    }
+
+    if (sparse_sets == 0 || dense_sets == 0) {
+        std::cerr << "Only one representation was checked\n";
+        exit(-1);
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking exceptions:\n";
+    try {
+        IterationArray<u32> set(2);
+        set[2] = 0;
+    } catch (std::out_of_range& e) {
+        std::cout << "std::out_of_range\n" << e.what() << "\n";
+    } catch (...) {
+        std::cerr << "Incorrect exception, expected std::out_of_range\n";
+        exit(-1);
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../defs.h"
+#include "../graph.h"
+#include "../utils.h"
+
+/**
+ * Writes random graph files, loads them with small chunks, so lines are cut everywhere,
+ * and compares the edges with the lines of the file: every line in both directions,
+ * both directions with the same weight
+ */
+const u32 NUM_STEPS = 30;
+const u32 MAX_NODES = 5'000;
+const u32 MAX_THREADS = 8;
+
+const std::string PATH = (std::filesystem::temp_directory_path() / "load_graph_test.txt").string();
+
+void fail(const std::string& what, u32 step) {
+    std::cerr << what << " mismatch on step " << step << "\n";
+    exit(-1);
+}
+
+void write_file(const std::string& text) {
+    std::ofstream out(PATH, std::ios::binary);
+    out << text;
+}
+
+void check_malformed(const std::string& name, const std::string& text) {
+    std::cout << name << ":\n";
+    write_file(text);
+    try {
+        load_graph(PATH, randint(1, MAX_THREADS), randint(1, 16));
+        std::cerr << "Malformed graph file was loaded\n";
+        exit(-1);
+    } catch (std::invalid_argument& e) {
+        std::cout << "std::invalid_argument\n" << e.what() << "\n";
+    }
+}
+
+int main() {
+    std::cout << "Checking loaded graphs:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(1, MAX_NODES);
+        u32 num_edges = randint(0, 3 * num_nodes);
+        std::string line_end = (step % 2 == 0 ? "\r\n" : "\n");
+
+        std::string text = std::to_string(num_nodes) + line_end + std::to_string(num_edges) + line_end;
+        std::vector<std::pair<u32, u32>> expected;
+        for (u32 i = 0; i < num_edges; ++i) {
+            u32 u = randint(0, num_nodes - 1);
+            u32 v = randint(0, num_nodes - 1);
+            expected.push_back({ u, v });
+            expected.push_back({ v, u });
+            text += std::to_string(u) + " " + std::to_string(v);
+            if (i + 1 < num_edges || step % 3 != 0) text += line_end;
+        }
+        std::sort(expected.begin(), expected.end());
+        write_file(text);
+
+        Graph G = load_graph(PATH, randint(1, MAX_THREADS), randint(1, 256));
+        if (G.num_nodes() != num_nodes || G.num_edges() != expected.size()) fail("Size", step);
+        for (u32 u = 0; u < num_nodes; ++u) {
+            if (G.nodes[u] != u) fail("Nodes", step);
+        }
+
+        std::vector<std::tuple<u32, u32, u32>> forward, backward;
+        for (u64 i = 0; i < G.num_edges(); ++i) {
+            const Edge& e = G.edges[i];
+            if (i > 0 && e < G.edges[i - 1]) fail("Sorted edges", step);
+            if (e.from != expected[i].first || e.to != expected[i].second) fail("Edges", step);
+            forward.push_back({ e.from, e.to, e.weight });
+            backward.push_back({ e.to, e.from, e.weight });
+        }
+        std::sort(backward.begin(), backward.end());
+        if (forward != backward) fail("Weights of both directions", step);
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking exceptions:\n";
+    check_malformed("Missing number", "3\n2\n0 1\n2\n");
+    check_malformed("Not a number", "3\n2\n0 1\n2 x\n");
+    check_malformed("Node out of range", "3\n2\n0 1\n2 3\n");
+    check_malformed("Missing header", "");
+    std::remove(PATH.c_str());
+
+    std::cout << "Missing file:\n";
+    try {
+        load_graph(PATH);
+        std::cerr << "Missing graph file was loaded\n";
+        exit(-1);
+    } catch (std::invalid_argument& e) {
+        std::cout << "std::invalid_argument\n" << e.what() << "\n";
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "../benchmark.h"
+#include "../parallel_array.h"
+#include "../parallel_memory.h"
+
+/**
+ * Registered benchmarks of parallel_memory.h, see run_registered_benchmarks() for arguments
+ *
+ * Every result has metrics:
+ * gb_per_s - bytes read and written per second, like STREAM counts them, without write allocate traffic
+ * stream_copy_percent - gb_per_s relative to memory/stream_copy of the same size and thread count,
+ *                       the plain a[i] = b[i] loop of STREAM, missing if it was filtered out
+ *
+ * Primitives are measured with every MemoryStores mode, e.g. memory/copy/non_temporal/<size>
+ */
+void measure_bandwidth(Benchmark& benchmark,
+                       const std::string& name,
+                       u64 size,
+                       u64 bytes,
+                       std::function<void()> timed) {
+    std::string stream_name = "memory/stream_copy/" + std::to_string(size);
+
+    for (u32 threads : benchmark.config.threads) {
+        const BenchmarkResult& result = benchmark.measure(name, threads, size, []() {}, timed);
+        double gb_per_s = bytes / result.median();
+        benchmark.set_metric("gb_per_s", gb_per_s);
+
+        try {
+            const BenchmarkResult& stream = benchmark.find(stream_name, threads);
+            benchmark.set_metric("stream_copy_percent", 100 * gb_per_s / (2 * size * sizeof(u32) / stream.median()));
+        } catch (std::invalid_argument&) {}
+    }
+}
+
+/* Name of a primitive with a store mode, memory/fill/<size> -> memory/fill/regular/<size> */
+std::string with_stores(const std::string& name, u32 stores) {
+    std::string result = name;
+    result.insert(name.rfind('/'), std::string("/") + MEMORY_STORES_NAMES[stores]);
+    return result;
+}
+
+/* The copy kernel of STREAM, as the compiler vectorizes it, with regular stores */
+void stream_copy(const u32* a, u32* b, u64 size) {
+    #pragma omp parallel for schedule(static)
+    for (u64 i = 0; i < size; ++i) {
+        b[i] = a[i];
+    }
+    escape(b);
+}
+
+REGISTER_BENCHMARK("memory/stream_copy", SIZES(1 << 20, 1 << 26),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<u32> source(size);
+    ParallelArray<u32> destination(size);
+    parallel_iota(source.begin(), size, 0u);
+    parallel_zero(destination.begin(), size);
+
+    measure_bandwidth(benchmark, name, size, 2 * size * sizeof(u32), [&]() {
+        stream_copy(source.begin(), destination.begin(), size);
+    });
+});
+
+REGISTER_BENCHMARK("memory/fill", SIZES(1 << 20, 1 << 26),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<u32> arr(size);
+    parallel_zero(arr.begin(), size);
+
+    for (u32 stores = 0; stores < NUM_MEMORY_STORES; ++stores) {
+        measure_bandwidth(benchmark, with_stores(name, stores), size, size * sizeof(u32), [&]() {
+            parallel_fill(arr.begin(), size, 7u, omp_get_max_threads(), static_cast<MemoryStores>(stores));
+            escape(arr.begin());
+        });
+    }
+});
+
+REGISTER_BENCHMARK("memory/zero", SIZES(1 << 20, 1 << 26),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<u32> arr(size);
+    parallel_zero(arr.begin(), size);
+
+    for (u32 stores = 0; stores < NUM_MEMORY_STORES; ++stores) {
+        measure_bandwidth(benchmark, with_stores(name, stores), size, size * sizeof(u32), [&]() {
+            parallel_zero(arr.begin(), size, omp_get_max_threads(), static_cast<MemoryStores>(stores));
+            escape(arr.begin());
+        });
+    }
+});
+
+REGISTER_BENCHMARK("memory/iota", SIZES(1 << 20, 1 << 26),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<u32> arr(size);
+    parallel_zero(arr.begin(), size);
+
+    for (u32 stores = 0; stores < NUM_MEMORY_STORES; ++stores) {
+        measure_bandwidth(benchmark, with_stores(name, stores), size, size * sizeof(u32), [&]() {
+            parallel_iota(arr.begin(), size, 0u, omp_get_max_threads(), static_cast<MemoryStores>(stores));
+            escape(arr.begin());
+        });
+    }
+});
+
+REGISTER_BENCHMARK("memory/copy", SIZES(1 << 20, 1 << 26),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<u32> source(size);
+    ParallelArray<u32> destination(size);
+    parallel_iota(source.begin(), size, 0u);
+    parallel_zero(destination.begin(), size);
+
+    for (u32 stores = 0; stores < NUM_MEMORY_STORES; ++stores) {
+        measure_bandwidth(benchmark, with_stores(name, stores), size, 2 * size * sizeof(u32), [&]() {
+            parallel_copy(source.begin(), destination.begin(), size, omp_get_max_threads(),
+                          static_cast<MemoryStores>(stores));
+            escape(destination.begin());
+        });
+    }
+});
+
+BENCHMARK_MAIN()
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../benchmark.h"
+#include "../boruvka.h"
+#include "../compressed_graph.h"
+#include "../graph.h"
+#include "../sequential_mst.h"
+#include "../simd.h"
+
+const u32 AVERAGE_DEGREE = 10;
+
+/**
+ * Registered benchmarks of MST engines, see run_registered_benchmarks() for arguments
+ * size is the number of nodes, graphs have AVERAGE_DEGREE * size edges
+ */
+REGISTER_BENCHMARK("mst/boruvka", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+    BoruvkaMST boruvka;
+
+    benchmark.run(name, G.num_edges(), [&]() {
+        escape(&G);
+        auto mst = boruvka.calculate_mst_ids(G);
+        escape(&mst);
+    });
+});
+
+REGISTER_BENCHMARK("mst/boruvka_no_cutoff", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+    BoruvkaMST boruvka(0);
+
+    benchmark.run(name, G.num_edges(), [&]() {
+        escape(&G);
+        auto mst = boruvka.calculate_mst_ids(G);
+        escape(&mst);
+    });
+});
+
+REGISTER_BENCHMARK("mst/boruvka_compressed", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    CompressedGraph compressed(generate_graph(size, size * AVERAGE_DEGREE));
+    BoruvkaMST boruvka;
+
+    benchmark.run(name, compressed.num_edges(), [&]() {
+        escape(&compressed);
+        auto mst = boruvka.calculate_mst_ids(compressed);
+        escape(&mst);
+    });
+});
+
+/* Boruvka on weights of another type, u64 weights are ranked first, see BoruvkaMST */
+template<typename W>
+void run_boruvka_weights(Benchmark& benchmark, const std::string& name, u64 size) {
+    BasicGraph<W> G = generate_graph<W>(size, size * AVERAGE_DEGREE);
+    BoruvkaMST<W> boruvka;
+
+    benchmark.run(name, G.num_edges(), [&]() {
+        escape(&G);
+        auto mst = boruvka.calculate_mst_ids(G);
+        escape(&mst);
+    });
+}
+
+REGISTER_BENCHMARK("mst/boruvka_weights/u16", SIZES(100'000, 1'000'000), run_boruvka_weights<u16>);
+REGISTER_BENCHMARK("mst/boruvka_weights/u64", SIZES(100'000, 1'000'000), run_boruvka_weights<u64>);
+REGISTER_BENCHMARK("mst/boruvka_weights/float", SIZES(100'000, 1'000'000), run_boruvka_weights<float>);
+
+/* The same graphs with 64 bit edge ids, what graphs of more than 2^32 edges pay for them */
+void run_boruvka_wide_ids(Benchmark& benchmark, const std::string& name, u64 size) {
+    Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+    BoruvkaMST<u32, u32, u64> boruvka;
+
+    benchmark.run(name, G.num_edges(), [&]() {
+        escape(&G);
+        auto mst = boruvka.calculate_mst_ids(G);
+        escape(&mst);
+    });
+}
+
+REGISTER_BENCHMARK("mst/boruvka_wide_ids", SIZES(100'000, 1'000'000), run_boruvka_wide_ids);
+
+REGISTER_BENCHMARK("mst/kruskal", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+    KruskalMST kruskal;
+
+    benchmark.run_sequential(name, G.num_edges(), [&]() {
+        escape(&G);
+        auto mst = kruskal.calculate_mst_ids(G);
+        escape(&mst);
+    });
+});
+
+REGISTER_BENCHMARK("mst/sequential", SIZES(100'000, 1'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+    SequentialMST sequential_mst;
+
+    benchmark.run_sequential(name, G.num_edges(), [&]() {
+        escape(&G);
+        auto mst = sequential_mst.calculate_mst(G);
+        escape(&mst);
+    });
+});
+
+/**
+ * Boruvka without the sequential tail and with kernels of one instruction set,
+ * levels this CPU lacks are skipped
+ */
+template<SimdLevel LEVEL>
+void run_boruvka_level(Benchmark& benchmark, const std::string& name, u64 size) {
+    if (!simd_level_supported(LEVEL)) return;
+
+    Graph G = generate_graph(size, size * AVERAGE_DEGREE);
+    BoruvkaMST boruvka(0, LEVEL);
+
+    benchmark.run(name, G.num_edges(), [&]() {
+        escape(&G);
+        auto mst = boruvka.calculate_mst_ids(G);
+        escape(&mst);
+    });
+}
+
+/**
+ * Contracted edges as Boruvka sees them after a round: sorted by from,
+ * size / AVERAGE_DEGREE / 2 nodes, so a node has a run of 2 * AVERAGE_DEGREE edges
+ */
+ContractedEdgeArrays contracted_edges(u64 size) {
+    u32 num_nodes = std::max<u64>(1, size / AVERAGE_DEGREE / 2);
+    std::mt19937 gen(size);
+
+    std::vector<u32> from(size);
+    for (u32& u : from) u = gen() % num_nodes;
+    std::sort(from.begin(), from.end());
+
+    ContractedEdgeArrays edges(size);
+    for (u32 i = 0; i < size; ++i) {
+        edges.set(i, ContractedEdge(from[i], gen() % num_nodes, gen(), i));
+    }
+    return edges;
+}
+
+template<SimdLevel LEVEL>
+void run_min_edge_kernel(Benchmark& benchmark, const std::string& name, u64 size) {
+    if (!simd_level_supported(LEVEL)) return;
+
+    ContractedEdgeArrays edges = contracted_edges(size);
+    ParallelArray<atomic_u64> shortest_edges(size);
+    BoruvkaMST boruvka(BoruvkaMST<>::AUTO_CUTOFF, LEVEL);
+
+    benchmark.run(name, size, [&]() {
+        #pragma omp parallel for
+        for (u32 i = 0; i < size; ++i) shortest_edges[i] = boruvka.EMPTY_EDGE;
+    }, [&]() {
+        boruvka.find_shortest_edges(edges, shortest_edges, nullptr, omp_get_max_threads());
+        escape(&shortest_edges);
+    });
+}
+
+template<SimdLevel LEVEL>
+void run_relabel_kernel(Benchmark& benchmark, const std::string& name, u64 size) {
+    if (!simd_level_supported(LEVEL)) return;
+
+    ContractedEdgeArrays source = contracted_edges(size);
+    ContractedEdgeArrays edges(size);
+    ParallelArray<u32> component(size);
+    ParallelArray<u32> remains(size);
+    BoruvkaMST boruvka(BoruvkaMST<>::AUTO_CUTOFF, LEVEL);
+
+    for (u32 i = 0; i < size; ++i) component[i] = i / 4;
+
+    benchmark.run(name, size, [&]() {
+        #pragma omp parallel for
+        for (u32 i = 0; i < size; ++i) edges.set(i, source.get(i));
+    }, [&]() {
+        boruvka.relabel_edges(edges, component, remains, omp_get_max_threads());
+        escape(&remains);
+    });
+}
+
+REGISTER_BENCHMARK("mst/boruvka_no_cutoff/scalar", SIZES(1'000'000), run_boruvka_level<SCALAR_LEVEL>);
+REGISTER_BENCHMARK("mst/boruvka_no_cutoff/avx2", SIZES(1'000'000), run_boruvka_level<AVX2_LEVEL>);
+REGISTER_BENCHMARK("mst/boruvka_no_cutoff/avx512", SIZES(1'000'000), run_boruvka_level<AVX512_LEVEL>);
+
+REGISTER_BENCHMARK("mst/min_edge_kernel/scalar", SIZES(20'000'000), run_min_edge_kernel<SCALAR_LEVEL>);
+REGISTER_BENCHMARK("mst/min_edge_kernel/avx2", SIZES(20'000'000), run_min_edge_kernel<AVX2_LEVEL>);
+REGISTER_BENCHMARK("mst/min_edge_kernel/avx512", SIZES(20'000'000), run_min_edge_kernel<AVX512_LEVEL>);
+
+REGISTER_BENCHMARK("mst/relabel_kernel/scalar", SIZES(20'000'000), run_relabel_kernel<SCALAR_LEVEL>);
+REGISTER_BENCHMARK("mst/relabel_kernel/avx2", SIZES(20'000'000), run_relabel_kernel<AVX2_LEVEL>);
+REGISTER_BENCHMARK("mst/relabel_kernel/avx512", SIZES(20'000'000), run_relabel_kernel<AVX512_LEVEL>);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,40 @@
+#include "../benchmark.h"
+#include "../parallel_array.h"
+
+/**
+ * Registered benchmarks of ParallelArray, see run_registered_benchmarks() for arguments
+ */
+REGISTER_BENCHMARK("parallel_array/construction", SIZES(1'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    benchmark.run(name, size, [&]() {
+        ParallelArray<u32> arr(size);
+        escape(&arr);
+    });
+});
+
+REGISTER_BENCHMARK("parallel_array/copy", SIZES(1'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<u32> source(size);
+    for (u32 i = 0; i < size; ++i) source[i] = i;
+
+    benchmark.run(name, size, [&]() {
+        escape(&source);
+        ParallelArray<u32> copy(source);
+        escape(&copy);
+    });
+});
+
+REGISTER_BENCHMARK("parallel_array/assign", SIZES(1'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<u32> source(size);
+    ParallelArray<u32> target(1);
+    for (u32 i = 0; i < size; ++i) source[i] = i;
+
+    benchmark.run(name, size, [&]() {
+        escape(&source);
+        target = source;
+        escape(&target);
+    });
+});
+
+BENCHMARK_MAIN()
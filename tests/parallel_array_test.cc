@@ -0,0 +1,102 @@
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../defs.h"
+#include "../graph.h"
+#include "../parallel_array.h"
+
+/**
+ * Checks copy, move and swap semantics of ParallelArray and that views don't copy anything
+ */
+const u32 SIZE = 100'000;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "Failed: " << what << "\n";
+        exit(-1);
+    }
+}
+
+ParallelArray<u32> iota_array(u32 size, u32 first) {
+    ParallelArray<u32> arr(size);
+    for (u32 i = 0; i < size; ++i) arr[i] = first + i;
+    return arr;
+}
+
+bool is_iota(const ParallelArray<u32>& arr, u32 size, u32 first) {
+    if (arr.size() != size) return false;
+    for (u32 i = 0; i < size; ++i) {
+        if (arr[i] != first + i) return false;
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "Checking copies:\n";
+    {
+        const ParallelArray<u32> source = iota_array(SIZE, 0);
+        ParallelArray<u32> copy(source);
+        check(copy.begin() != source.begin() && is_iota(copy, SIZE, 0), "copy constructor from a const array");
+
+        copy[0] = 1;
+        check(source[0] == 0, "copy is deep");
+
+        ParallelArray<u32> assigned(1);
+        assigned = source;
+        check(assigned.begin() != source.begin() && is_iota(assigned, SIZE, 0), "copy assignment");
+
+        ParallelArray<u32>& self = assigned;
+        assigned = self;
+        check(is_iota(assigned, SIZE, 0), "self assignment");
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking moves and swaps:\n";
+    {
+        ParallelArray<u32> source = iota_array(SIZE, 0);
+        const u32* data = source.begin();
+
+        ParallelArray<u32> moved(std::move(source));
+        check(moved.begin() == data && source.size() == 0, "move constructor takes the buffer");
+
+        ParallelArray<u32> assigned(1);
+        assigned = std::move(moved);
+        check(assigned.begin() == data && is_iota(assigned, SIZE, 0), "move assignment takes the buffer");
+
+        ParallelArray<u32> other = iota_array(SIZE / 2, 7);
+        const u32* other_data = other.begin();
+        assigned.swap(other);
+        check(assigned.begin() == other_data && is_iota(assigned, SIZE / 2, 7), "swap gets the other buffer");
+        check(other.begin() == data && is_iota(other, SIZE, 0), "swap gives away its buffer");
+
+        std::vector<ParallelArray<u32>> arrays;
+        arrays.push_back(std::move(other));
+        check(arrays[0].begin() == data, "arrays are moved into containers");
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking views:\n";
+    {
+        Graph G = generate_graph(1'000, 5'000);
+        GraphView view = G;
+        check(view.nodes.begin() == G.nodes.begin() && view.edges.begin() == G.edges.begin(), "graph view shares arrays");
+        check(view.num_nodes() == G.num_nodes() && view.num_edges() == G.num_edges(), "graph view sizes");
+        check(is_connected(G), "is_connected() on a view");
+
+        std::vector<u32> values = { 3, 1, 4 };
+        ArrayView<u32> array_view(values.data(), values.size());
+        check(array_view.size() == 3 && array_view[2] == 4, "view of a vector");
+
+        try {
+            array_view[3];
+            check(false, "std::out_of_range from a view");
+        } catch (std::out_of_range& e) {
+            std::cout << "std::out_of_range\n" << e.what() << "\n";
+        }
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
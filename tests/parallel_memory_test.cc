@@ -0,0 +1,111 @@
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../defs.h"
+#include "../parallel_memory.h"
+
+/**
+ * Checks every primitive of parallel_memory.h with every MemoryStores mode against sequential loops
+ * Ranges start at odd offsets and have odd sizes, so unaligned heads and tails are covered,
+ * guard elements around them should stay untouched
+ */
+std::mt19937 gen(std::random_device{}());
+
+u32 randint(u32 l, u32 r) {
+    return std::uniform_int_distribution<u32>(l, r)(gen);
+}
+
+const u32 MAX_THREADS = 4;
+const u32 NUM_STEPS = 20;
+const u32 MAX_SIZE = 100'000;
+const u32 MAX_OFFSET = 5;
+const u8 GUARD = 0xAB;
+
+struct Triple {
+    u8 a, b, c;
+};
+
+void fail(const std::string& what, u32 size, u32 offset, u32 threads, u32 stores) {
+    std::cerr << what << " mismatch on size " << size << ", offset " << offset << " with " << threads
+              << " threads and " << MEMORY_STORES_NAMES[stores] << " stores\n";
+    exit(-1);
+}
+
+/* Runs primitive on a range of size elements of T in a buffer filled with GUARD and compares the buffer to expected */
+template<typename T, typename Primitive, typename Expected>
+void check(const std::string& what, u32 size, Primitive primitive, Expected expected) {
+    for (u32 offset = 0; offset < MAX_OFFSET; ++offset) {
+        for (u32 threads = 1; threads <= MAX_THREADS; ++threads) {
+            for (u32 stores = 0; stores < NUM_MEMORY_STORES; ++stores) {
+                std::vector<u8> buffer((size + 2 * MAX_OFFSET) * sizeof(T), GUARD);
+                std::vector<u8> expected_buffer = buffer;
+
+                T* data = reinterpret_cast<T*>(buffer.data() + offset * sizeof(T));
+                T* expected_data = reinterpret_cast<T*>(expected_buffer.data() + offset * sizeof(T));
+                primitive(data, size, threads, static_cast<MemoryStores>(stores));
+                for (u32 i = 0; i < size; ++i) expected_data[i] = expected(i);
+
+                if (buffer != expected_buffer) fail(what, size, offset, threads, stores);
+            }
+        }
+    }
+}
+
+template<typename T>
+void check_type(const std::string& type, u32 size) {
+    T value = static_cast<T>(0x5A5A5A5A5A5A5A5AULL);
+    check<T>("parallel_fill<" + type + ">", size, [&](T* data, u32 n, u32 threads, MemoryStores stores) {
+        parallel_fill(data, n, value, threads, stores);
+    }, [&](u32) {
+        return value;
+    });
+
+    check<T>("parallel_zero<" + type + ">", size, [](T* data, u32 n, u32 threads, MemoryStores stores) {
+        parallel_zero(data, n, threads, stores);
+    }, [](u32) {
+        return T(0);
+    });
+
+    T first = static_cast<T>(randint(0, 1'000'000));
+    check<T>("parallel_iota<" + type + ">", size, [&](T* data, u32 n, u32 threads, MemoryStores stores) {
+        parallel_iota(data, n, first, threads, stores);
+    }, [&](u32 i) {
+        return static_cast<T>(first + i);
+    });
+
+    std::vector<T> source(size + 1);
+    for (u32 i = 0; i <= size; ++i) source[i] = static_cast<T>(gen());
+    check<T>("parallel_copy<" + type + ">", size, [&](T* data, u32 n, u32 threads, MemoryStores stores) {
+        parallel_copy(source.data() + 1, data, n, threads, stores);
+    }, [&](u32 i) {
+        return source[i + 1];
+    });
+}
+
+int main() {
+    std::cout << "Checking primitives:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 size = step <= 5 ? step - 1 : randint(0, MAX_SIZE);
+        check_type<u8>("u8", size);
+        check_type<u32>("u32", size);
+        check_type<u64>("u64", size);
+        check_type<float>("float", size);
+    }
+    std::cout << "OK\n";
+
+    std::cout << "Checking types streaming stores can't write:\n";
+    for (u32 size : { 0u, 1u, 1'000u, 100'000u }) {
+        Triple value = { 1, 2, 3 };
+        std::vector<Triple> arr(size);
+        parallel_fill(arr.data(), size, value, MAX_THREADS, NON_TEMPORAL_STORES);
+        for (const Triple& x : arr) {
+            if (std::memcmp(&x, &value, sizeof(Triple)) != 0) fail("parallel_fill<Triple>", size, 0, MAX_THREADS, 0);
+        }
+    }
+    std::cout << "OK\n";
+
+    return 0;
+}
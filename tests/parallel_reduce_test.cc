@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "../defs.h"
+#include "../parallel_array.h"
+#include "../parallel_reduce.h"
+
+/**
+ * Checks parallel_reduce.h against sequential loops on every thread count up to MAX_THREADS
+ * Integer results should match exactly, floating point sums should stay within the error bound of their mode
+ * and deterministic ones shouldn't change a bit
+ */
+std::mt19937 gen(std::random_device{}());
+
+u32 randint(u32 l, u32 r) {
+    return std::uniform_int_distribution<u32>(l, r)(gen);
+}
+
+const u32 MAX_THREADS = 4;
+const u32 NUM_STEPS = 100;
+const u32 MAX_SIZE = 200'000;
+
+/* Every term after the first is below half an ulp of 1, added to 1 one by one they are all lost */
+const u32 HARD_SIZE = 1'000'000;
+const double HARD_TERM = 1e-16;
+
+void fail(const std::string& what, u32 size, u32 threads) {
+    std::cerr << what << " mismatch on size " << size << " with " << threads << " threads\n";
+    exit(-1);
+}
+
+void check_integers() {
+    std::cout << "Checking integer reductions:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 size = randint(0, MAX_SIZE);
+        ParallelArray<u64> arr(size);
+        u64 sum = 0, maximum = 0, even = 0;
+        for (u32 i = 0; i < size; ++i) {
+            arr[i] = randint(0, 1'000'000);
+            sum += arr[i];
+            maximum = std::max(maximum, arr[i]);
+            even += arr[i] % 2 == 0;
+        }
+
+        for (u32 threads = 1; threads <= MAX_THREADS; ++threads) {
+            for (u32 mode = 0; mode < NUM_SUM_MODES; ++mode) {
+                if (parallel_sum(arr, static_cast<SumMode>(mode), threads) != sum) fail("parallel_sum", size, threads);
+            }
+
+            u64 parallel_maximum = parallel_reduce(arr, u64(0), [](u64 a, u64 b) {
+                return std::max(a, b);
+            }, threads);
+            if (parallel_maximum != maximum) fail("parallel_reduce", size, threads);
+
+            u64 parallel_even = parallel_transform_reduce(arr, u64(0), [](u64 x) {
+                return u64(x % 2 == 0);
+            }, std::plus<u64>(), threads);
+            if (parallel_even != even) fail("parallel_transform_reduce", size, threads);
+
+            u64 squares = parallel_transform_reduce(0, size, u64(0), [](u64 i) {
+                return i * i;
+            }, std::plus<u64>(), threads);
+            if (size > 0 && squares != u64(size) * (size - 1) * (2 * u64(size) - 1) / 6) {
+                fail("Sum of squares", size, threads);
+            }
+        }
+    }
+    std::cout << "OK\n";
+}
+
+/* Every mode should be within n * eps * sum |x| of the long double sum, compensated ones much closer */
+void check_floating_point() {
+    std::cout << "Checking floating point sums:\n";
+    const double EPS = std::numeric_limits<double>::epsilon();
+
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 size = randint(1, MAX_SIZE);
+        ParallelArray<double> arr(size);
+        long double sum = 0, abs_sum = 0;
+        std::uniform_real_distribution<double> value(-1, 1);
+        for (u32 i = 0; i < size; ++i) {
+            arr[i] = value(gen);
+            sum += arr[i];
+            abs_sum += std::fabs(arr[i]);
+        }
+
+        for (u32 threads = 1; threads <= MAX_THREADS; ++threads) {
+            for (u32 mode = 0; mode < NUM_SUM_MODES; ++mode) {
+                double terms = mode == PLAIN_SUM ? size : 4 + std::log2(size);
+                if (mode == DETERMINISTIC_SUM) terms += DETERMINISTIC_BLOCK / REDUCE_UNROLL;
+                double bound = terms * EPS * abs_sum;
+                double error = std::fabs(parallel_sum(arr, static_cast<SumMode>(mode), threads) - sum);
+                if (error > bound) {
+                    std::cerr << SUM_MODE_NAMES[mode] << " error " << error << " is above " << bound << "\n";
+                    fail("parallel_sum", size, threads);
+                }
+            }
+        }
+    }
+
+    ParallelArray<double> hard(HARD_SIZE);
+    std::fill(hard.begin(), hard.end(), HARD_TERM);
+    hard[0] = 1;
+    long double expected = 1 + static_cast<long double>(HARD_TERM) * (HARD_SIZE - 1);
+    for (u32 threads = 1; threads <= MAX_THREADS; ++threads) {
+        double error = std::fabs(parallel_sum(hard, KAHAN_SUM, threads) - expected);
+        if (error > 2 * EPS) {
+            std::cerr << "Kahan sum error " << error << " on tiny terms\n";
+            fail("parallel_sum", HARD_SIZE, threads);
+        }
+    }
+    std::cout << "OK\n";
+}
+
+/* DETERMINISTIC_SUM should give the same bits on every thread count, both over arrays and ranges */
+void check_deterministic() {
+    std::cout << "Checking deterministic sums:\n";
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 size = randint(1, MAX_SIZE);
+        ParallelArray<float> arr(size);
+        std::uniform_real_distribution<float> value(-1, 1);
+        for (u32 i = 0; i < size; ++i) {
+            arr[i] = value(gen);
+        }
+        u64 begin = randint(0, MAX_SIZE);
+
+        float expected = parallel_sum(arr, DETERMINISTIC_SUM, 1);
+        double expected_range = parallel_transform_sum(begin, begin + size, [](u64 i) {
+            return 1.0 / (i + 1);
+        }, DETERMINISTIC_SUM, 1);
+
+        for (u32 threads = 2; threads <= MAX_THREADS; ++threads) {
+            float result = parallel_sum(arr, DETERMINISTIC_SUM, threads);
+            double result_range = parallel_transform_sum(begin, begin + size, [](u64 i) {
+                return 1.0 / (i + 1);
+            }, DETERMINISTIC_SUM, threads);
+
+            if (std::memcmp(&result, &expected, sizeof(float)) != 0 ||
+                std::memcmp(&result_range, &expected_range, sizeof(double)) != 0) {
+                std::cerr << std::hexfloat << "Expected " << expected << " and " << expected_range
+                          << " got " << result << " and " << result_range << "\n";
+                fail("Deterministic sum", size, threads);
+            }
+        }
+    }
+    std::cout << "OK\n";
+}
+
+int main() {
+    check_integers();
+    check_floating_point();
+    check_deterministic();
+    return 0;
+}
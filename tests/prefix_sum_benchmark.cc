@@ -0,0 +1,44 @@
+#include <random>
+
+#include "../benchmark.h"
+#include "../parallel_array.h"
+#include "../prefix_sum.h"
+
+/**
+ * Registered benchmarks of PrefixSum, see run_registered_benchmarks() for arguments
+ */
+ParallelArray<u32> random_array(u64 size) {
+    std::mt19937 gen(size);
+    ParallelArray<u32> arr(size);
+    for (u32 i = 0; i < size; ++i) arr[i] = gen() % 16;
+    return arr;
+}
+
+REGISTER_BENCHMARK("prefix_sum/sequential", SIZES(100'000, 10'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<u32> arr = random_array(size);
+    ParallelArray<u32> result(size);
+
+    benchmark.run_sequential(name, size, [&]() {
+        escape(&arr);
+        u32 sum = 0;
+        for (u32 i = 0; i < size; ++i) {
+            sum += arr[i];
+            result[i] = sum;
+        }
+        escape(&result);
+    });
+});
+
+REGISTER_BENCHMARK("prefix_sum/parallel", SIZES(100'000, 10'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<u32> arr = random_array(size);
+
+    benchmark.run(name, size, [&]() {
+        escape(&arr);
+        PrefixSum prefix_sum(size, arr);
+        escape(&prefix_sum);
+    });
+});
+
+BENCHMARK_MAIN()
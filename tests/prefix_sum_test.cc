@@ -1,20 +1,24 @@
 #include <iostream>
 #include <omp.h>
 #include <random>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "../benchmark.h"
 #include "../defs.h"
 #include "../parallel_array.h"
 #include "../prefix_sum.h"
+#include "../simd.h"
 #include "../timer.h"
 
+template<typename T>
 struct SequentialPrefixSum {
     u32 size;
-    u32* prefix_sum;
+    T* prefix_sum;
 
-    template<typename U>
-    SequentialPrefixSum(u32 size, ParallelArray<U> arr) : size(size) {
-        prefix_sum = static_cast<u32*>(operator new[] (size * sizeof(u32)));
+    SequentialPrefixSum(u32 size, ParallelArray<T>& arr) : size(size) {
+        prefix_sum = static_cast<T*>(operator new[] (size * sizeof(T)));
         prefix_sum[0] = arr[0];
 
         for (u32 i = 1; i < size; ++i) {
@@ -26,148 +30,189 @@ struct SequentialPrefixSum {
         delete[] prefix_sum;
     }
 
-    u32 operator[](u32 id) {
+    T operator[](u32 id) {
         return prefix_sum[id];
     }
 };
 
+/**
+ * PrefixSum as it was before the scan kernels: it copies arr, makes a scalar scan
+ * of every block and a second pass adding block offsets, kept as the baseline for benchmarks
+ */
+struct ScanThenAddPrefixSum {
+    u32 arr_size;
+    u32* prefix_sum;
+
+    ScanThenAddPrefixSum(u32 arr_size, ParallelArray<u32> arr) : arr_size(arr_size) {
+        prefix_sum = static_cast<u32*>(operator new[] (arr_size * sizeof(u32)));
+        u32 NUM_THREADS = PrefixSum<u32>::threads_for(arr_size, omp_get_max_threads());
+        std::vector<u32> thread_sum(NUM_THREADS);
+
+        #pragma omp parallel num_threads(NUM_THREADS) if(NUM_THREADS > 1)
+        {
+            u32 thread_num = omp_get_thread_num();
+            u32 current_sum = 0;
+
+            #pragma omp for schedule(static) nowait
+            for (u32 i = 0; i < arr_size; ++i) {
+                current_sum += arr[i];
+                prefix_sum[i] = current_sum;
+            }
+            thread_sum[thread_num] = current_sum;
+            #pragma omp barrier
+
+            u32 offset = 0;
+            for (u32 i = 0; i < thread_num; ++i) {
+                offset += thread_sum[i];
+            }
+
+            #pragma omp for simd schedule(static)
+            for (u32 i = 0; i < arr_size; ++i) {
+                prefix_sum[i] += offset;
+            }
+        }
+    }
+
+    ~ScanThenAddPrefixSum() {
+        delete[] prefix_sum;
+    }
+};
+
 std::mt19937 gen(std::random_device{}());
 
 u32 randint(u32 l, u32 r) {
     return std::uniform_int_distribution<u32>(l, r)(gen);
 }
 
-const u32 SMALL_NUM_STEPS = 10'000;
+const u32 SMALL_NUM_STEPS = 1'000;
 const u32 SMALL_SIZE = 100;
 
-const u32 NUM_STEPS = 1'000;
+const u32 NUM_STEPS = 200;
 const u32 MAX_SIZE = 100'000;
 
 const u32 PERF_NUM_STEPS = 500;
 const u32 PERF_SIZE = 10'000'000;
 
-void check_correctness() {
-    std::cout << std::fixed << "Checking correctness:\n";
-    std::cout << "Checking small sizes:\n";
-    for (u32 size = 1; size <= SMALL_SIZE; ++size) {
-        std::cout << "Size " << size << "\n";
-        for (u32 step = 1; step <= SMALL_NUM_STEPS; ++step) {
-            ParallelArray<u32> arr(size);
-            for (u32 i = 0; i < size; ++i) {
-                arr[i] = randint(1, 10);
-            }
+/**
+ * Values are small integers, so float sums below 2^24 are exact
+ * and every type can be compared exactly
+ */
+template<typename T>
+bool check_array(u32 size, SimdLevel level) {
+    ParallelArray<T> arr(size);
+    for (u32 i = 0; i < size; ++i) {
+        arr[i] = randint(1, 10);
+    }
 
-            SequentialPrefixSum correct(size, arr);
-            PrefixSum to_check(size, arr);
+    SequentialPrefixSum<T> correct(size, arr);
+    PrefixSum<T> to_check(size, arr, omp_get_max_threads(), level);
 
+    for (u32 i = 0; i < size; ++i) {
+        if (correct[i] != to_check[i]) {
+            std::cerr << "Prefix sum mismatch at position " << i << ":\n";
+            std::cerr << "Expected " << correct[i] << " got " << to_check[i] << "\n";
+            std::cerr << "Array:\n";
             for (u32 i = 0; i < size; ++i) {
-                if (correct[i] != to_check[i]) {
-                    std::cerr << "Prefix sum mismatch at position " << i << ":\n";
-                    std::cerr << "Expected " << correct[i] << " got " << to_check[i] << "\n";
-                    std::cerr << "Array:\n";
-                    for (u32 i = 0; i < size; ++i) {
-                        std::cerr << arr[i] << " ";
-                    }
-                    std::cerr << "\nCorrect:\n";
-                    for (u32 i = 0; i < size; ++i) {
-                        std::cerr << correct[i] << " ";
-                    }
-                    std::cerr << "\nIncorrect:\n";
-                    for (u32 i = 0; i < size; ++i) {
-                        std::cerr << to_check[i] << " ";
-                    }
-                    std::cerr << "\n";
-                    exit(-1);
-                }
+                std::cerr << arr[i] << " ";
             }
+            std::cerr << "\nCorrect:\n";
+            for (u32 i = 0; i < size; ++i) {
+                std::cerr << correct[i] << " ";
+            }
+            std::cerr << "\nIncorrect:\n";
+            for (u32 i = 0; i < size; ++i) {
+                std::cerr << to_check[i] << " ";
+            }
+            std::cerr << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+void check_correctness(const std::string& type, SimdLevel level) {
+    std::cout << std::fixed << "Checking correctness of " << type << " with " << SIMD_LEVEL_NAMES[level] << ":\n";
+    std::cout << "Checking small sizes:\n";
+    for (u32 size = 1; size <= SMALL_SIZE; ++size) {
+        for (u32 step = 1; step <= SMALL_NUM_STEPS; ++step) {
+            if (!check_array<T>(size, level)) exit(-1);
         }
     }
     std::cout << "OK\n";
 
     std::cout << "Checking on random sizes:\n";
     for (u32 step = 1; step <= NUM_STEPS; ++step) {
-        if (step % (NUM_STEPS / 10) == 1) {
-            std::cout << "Step " << step / (NUM_STEPS / 10) + 1 << " of 10\n";
-        }
-
-        u32 size = randint(1, MAX_SIZE);
-        ParallelArray<u32> arr(size);
-        for (u32 i = 0; i < size; ++i) {
-            arr[i] = randint(1, 10);
-        }
-
-        SequentialPrefixSum correct(size, arr);
-        PrefixSum to_check(size, arr);
-
-        for (u32 i = 0; i < size; ++i) {
-            if (correct[i] != to_check[i]) {
-                std::cerr << "Prefix sum mismatch at position " << i << ":\n";
-                std::cerr << "Expected " << correct[i] << " got " << to_check[i] << "\n";
-                std::cerr << "Array:\n";
-                for (u32 i = 0; i < size; ++i) {
-                    std::cerr << arr[i] << " ";
-                }
-                std::cerr << "\nCorrect:\n";
-                for (u32 i = 0; i < size; ++i) {
-                    std::cerr << correct[i] << " ";
-                }
-                std::cerr << "\nIncorrect:\n";
-                for (u32 i = 0; i < size; ++i) {
-                    std::cerr << to_check[i] << " ";
-                }
-                std::cerr << "\n";
-                exit(-1);
-            }
-        }
+        if (!check_array<T>(randint(1, MAX_SIZE), level)) exit(-1);
     }
     std::cout << "OK\n";
 }
 
-void check_performance() {
-    u64 sequential_time = 0;
-    u64 parallel_time = 0;
-
-    for (u32 step = 1; step <= PERF_NUM_STEPS; ++step) {
-        if (step % (PERF_NUM_STEPS / 10) == 1) {
-            std::cout << "Step " << step / (PERF_NUM_STEPS / 10) + 1 << " of 10\n";
-        }
+template<typename T>
+void run_kernels(Benchmark& benchmark, const std::string& type) {
+    ParallelArray<T> arr(PERF_SIZE);
+    for (u32 i = 0; i < PERF_SIZE; ++i) {
+        arr[i] = gen() % 16;
+    }
 
-        ParallelArray<u32> arr(PERF_SIZE);
-        for (u32 i = 0; i < PERF_SIZE; ++i) {
-            arr[i] = gen();
-        }
+    for (u32 level = 0; level < NUM_SIMD_LEVELS; ++level) {
+        if (!simd_level_supported(static_cast<SimdLevel>(level))) continue;
 
-        {
-            escape(&arr);
-            u64 start = currentSeconds();
-            SequentialPrefixSum sequental(PERF_SIZE, arr);
-            u64 finish = currentSeconds();
-            escape(&sequental);
-            sequential_time += finish - start;
-        }
-        
-        {
+        benchmark.run("prefix_sum/" + type + "/" + SIMD_LEVEL_NAMES[level], PERF_SIZE, [&]() {
             escape(&arr);
-            u64 start = currentSeconds();
-            PrefixSum parallel(PERF_SIZE, arr);
-            u64 finish = currentSeconds();
+            PrefixSum<T> parallel(PERF_SIZE, arr, omp_get_max_threads(), static_cast<SimdLevel>(level));
             escape(&parallel);
-            parallel_time += finish - start;
-        }
+        });
+    }
+}
+
+void check_performance(BenchmarkConfig config) {
+    Benchmark benchmark(config);
+
+    ParallelArray<u32> arr(PERF_SIZE);
+    for (u32 i = 0; i < PERF_SIZE; ++i) {
+        arr[i] = gen();
     }
 
-    std::cout << std::fixed;
-    std::cout << "Sequential average time: "
-              << static_cast<double>(sequential_time) / PERF_NUM_STEPS
-              << "\nPer element: "
-              << static_cast<double>(sequential_time) / PERF_NUM_STEPS / PERF_SIZE << "\n";
-    std::cout << "Parallel average time: "
-              << static_cast<double>(parallel_time) / PERF_NUM_STEPS
-              << "\nPer element: "
-              << static_cast<double>(parallel_time) / PERF_NUM_STEPS / PERF_SIZE << "\n";
+    benchmark.run_sequential("prefix_sum/sequential", PERF_SIZE, [&]() {
+        escape(&arr);
+        SequentialPrefixSum<u32> sequential(PERF_SIZE, arr);
+        escape(&sequential);
+    });
+
+    benchmark.run("prefix_sum/scan_then_add", PERF_SIZE, [&]() {
+        escape(&arr);
+        ScanThenAddPrefixSum parallel(PERF_SIZE, arr);
+        escape(&parallel);
+    });
+
+    run_kernels<u32>(benchmark, "u32");
+    run_kernels<u64>(benchmark, "u64");
+    run_kernels<float>(benchmark, "float");
+
+    benchmark.report();
 }
 
-int main() {
-    check_correctness();
-    check_performance();
-}
\ No newline at end of file
+/**
+ * Add no_correctness or no_performance to skip these checks,
+ * performance is measured with the settings from parse_benchmark_args()
+ */
+int main(int argc, char* argv[]) {
+    std::set<std::string> arguments(argv, argv + argc);
+
+    if (!arguments.count("no_correctness")) {
+        for (u32 level = 0; level < NUM_SIMD_LEVELS; ++level) {
+            if (!simd_level_supported(static_cast<SimdLevel>(level))) continue;
+
+            check_correctness<u32>("u32", static_cast<SimdLevel>(level));
+            check_correctness<u64>("u64", static_cast<SimdLevel>(level));
+            check_correctness<float>("float", static_cast<SimdLevel>(level));
+        }
+    }
+
+    if (!arguments.count("no_performance")) {
+        BenchmarkConfig defaults;
+        defaults.repetitions = PERF_NUM_STEPS;
+        check_performance(parse_benchmark_args(argc, argv, defaults));
+    }
+}
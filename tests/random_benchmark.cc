@@ -0,0 +1,15 @@
+#include "../benchmark.h"
+#include "../parallel_random.h"
+
+/**
+ * Registered benchmarks of RandomSequence, see run_registered_benchmarks() for arguments
+ */
+REGISTER_BENCHMARK("random/random_sequence", SIZES(1'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    benchmark.run(name, size, [&]() {
+        RandomSequence sequence(size);
+        escape(&sequence);
+    });
+});
+
+BENCHMARK_MAIN()
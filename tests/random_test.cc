@@ -1,6 +1,6 @@
 #include <iostream>
 
-#include "../generate_graph.h"
+#include "../parallel_random.h"
 
 const u32 SEQ_SIZE = 30;
 
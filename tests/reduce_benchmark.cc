@@ -0,0 +1,70 @@
+#include <random>
+#include <string>
+
+#include "../benchmark.h"
+#include "../parallel_array.h"
+#include "../parallel_reduce.h"
+
+/**
+ * Registered benchmarks of parallel_reduce.h, see run_registered_benchmarks() for arguments
+ *
+ * reduce/sum/<mode> sums doubles in every SumMode, so the cost of compensated
+ * and deterministic sums is measured against the plain one on the same data
+ */
+ParallelArray<double> random_array(u64 size) {
+    std::mt19937 gen(size);
+    std::uniform_real_distribution<double> value(-1, 1);
+    ParallelArray<double> arr(size);
+    for (u32 i = 0; i < size; ++i) arr[i] = value(gen);
+    return arr;
+}
+
+REGISTER_BENCHMARK("reduce/sequential", SIZES(1'000'000, 100'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<double> arr = random_array(size);
+
+    benchmark.run_sequential(name, size, [&]() {
+        escape(&arr);
+        double sum = 0;
+        for (u32 i = 0; i < size; ++i) {
+            sum += arr[i];
+        }
+        escape(&sum);
+    });
+});
+
+/* A function and not a lambda in REGISTER_BENCHMARK, pragmas can't be used inside macro arguments */
+void run_omp_reduction(Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<double> arr = random_array(size);
+    const double* data = arr.begin();
+
+    benchmark.run(name, size, [&]() {
+        escape(&arr);
+        double sum = 0;
+        #pragma omp parallel for reduction(+:sum)
+        for (u32 i = 0; i < size; ++i) {
+            sum += data[i];
+        }
+        escape(&sum);
+    });
+}
+
+REGISTER_BENCHMARK("reduce/omp_reduction", SIZES(1'000'000, 100'000'000), run_omp_reduction);
+
+template<SumMode MODE>
+void run_sum(Benchmark& benchmark, const std::string& name, u64 size) {
+    ParallelArray<double> arr = random_array(size);
+
+    benchmark.run(name, size, [&]() {
+        escape(&arr);
+        double sum = parallel_sum(arr, MODE);
+        escape(&sum);
+    });
+}
+
+REGISTER_BENCHMARK("reduce/sum/plain", SIZES(1'000'000, 100'000'000), run_sum<PLAIN_SUM>);
+REGISTER_BENCHMARK("reduce/sum/kahan", SIZES(1'000'000, 100'000'000), run_sum<KAHAN_SUM>);
+REGISTER_BENCHMARK("reduce/sum/pairwise", SIZES(1'000'000, 100'000'000), run_sum<PAIRWISE_SUM>);
+REGISTER_BENCHMARK("reduce/sum/deterministic", SIZES(1'000'000, 100'000'000), run_sum<DETERMINISTIC_SUM>);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../benchmark.h"
+#include "../boruvka.h"
+#include "../graph.h"
+#include "../graph_reordering.h"
+
+/**
+ * Registered benchmarks of node reordering, see run_registered_benchmarks() for arguments
+ * size is the number of nodes
+ *
+ * Graphs are grids with random weights and shuffled node ids: a road network-like graph
+ * that has locality, but not in the ids it came with, which is what a reordering should recover
+ *
+ * reordering/<order> time the order and the relabeling,
+ * reordering/mst/<order> run BoruvkaMST end to end with the order, relabeling included,
+ * reordering/mst_rounds/<order> run it on a graph relabeled beforehand, the rounds alone,
+ * llc_misses of the mst benchmarks show what the order changes
+ */
+Graph shuffled_grid(u64 size) {
+    u32 side = std::max<u64>(2, std::sqrt(static_cast<double>(size)));
+    u32 num_nodes = side * side;
+    std::mt19937 gen(size);
+
+    std::vector<u32> label(num_nodes);
+    std::iota(label.begin(), label.end(), 0);
+    std::shuffle(label.begin(), label.end(), gen);
+
+    Graph G(num_nodes, 4ULL * side * (side - 1));
+    parallel_iota(G.nodes.begin(), num_nodes, 0u);
+
+    u64 count = 0;
+    auto add_edge = [&](u32 u, u32 v) {
+        u32 weight = gen();
+        G.edges[count++] = Edge(label[u], label[v], weight);
+        G.edges[count++] = Edge(label[v], label[u], weight);
+    };
+    for (u32 row = 0; row < side; ++row) {
+        for (u32 column = 0; column < side; ++column) {
+            u32 u = row * side + column;
+            if (column + 1 < side) add_edge(u, u + 1);
+            if (row + 1 < side) add_edge(u, u + side);
+        }
+    }
+
+    G.sort_edges();
+    return G;
+}
+
+template<NodeOrder ORDER>
+void run_reordering(Benchmark& benchmark, const std::string& name, u64 size) {
+    Graph G = shuffled_grid(size);
+
+    benchmark.run(name, G.num_nodes(), [&]() {
+        ReorderedGraph reordered(G, ORDER);
+        escape(&reordered);
+    });
+}
+
+template<NodeOrder ORDER>
+void run_mst(Benchmark& benchmark, const std::string& name, u64 size) {
+    Graph G = shuffled_grid(size);
+    BoruvkaMST boruvka(BoruvkaMST<>::AUTO_CUTOFF, detect_simd_level(), ORDER);
+
+    benchmark.run(name, G.num_edges(), [&]() {
+        escape(&G);
+        auto mst = boruvka.calculate_mst_ids(G);
+        escape(&mst);
+    });
+}
+
+template<NodeOrder ORDER>
+void run_mst_rounds(Benchmark& benchmark, const std::string& name, u64 size) {
+    ReorderedGraph reordered(shuffled_grid(size), ORDER);
+    BoruvkaMST boruvka;
+
+    benchmark.run(name, reordered.graph.num_edges(), [&]() {
+        escape(&reordered);
+        auto mst = boruvka.calculate_mst_ids(reordered.graph);
+        escape(&mst);
+    });
+}
+
+REGISTER_BENCHMARK("reordering/degree", SIZES(1'000'000, 10'000'000), run_reordering<DEGREE_ORDER>);
+REGISTER_BENCHMARK("reordering/bfs", SIZES(1'000'000, 10'000'000), run_reordering<BFS_ORDER>);
+
+REGISTER_BENCHMARK("reordering/mst/original", SIZES(1'000'000, 10'000'000), run_mst<ORIGINAL_ORDER>);
+REGISTER_BENCHMARK("reordering/mst/degree", SIZES(1'000'000, 10'000'000), run_mst<DEGREE_ORDER>);
+REGISTER_BENCHMARK("reordering/mst/bfs", SIZES(1'000'000, 10'000'000), run_mst<BFS_ORDER>);
+
+REGISTER_BENCHMARK("reordering/mst_rounds/degree", SIZES(1'000'000, 10'000'000), run_mst_rounds<DEGREE_ORDER>);
+REGISTER_BENCHMARK("reordering/mst_rounds/bfs", SIZES(1'000'000, 10'000'000), run_mst_rounds<BFS_ORDER>);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <random>
+
+#include "../benchmark.h"
+#include "../graph.h"
+#include "../parallel_algorithms.h"
+#include "../parallel_array.h"
+
+/**
+ * Registered benchmarks of parallel_sort, see run_registered_benchmarks() for arguments
+ * The input is copied back before each repetition, the copy isn't measured
+ */
+REGISTER_BENCHMARK("sort/std_sort/u32", SIZES(1'000'000, 10'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    std::mt19937 gen(size);
+    ParallelArray<u32> source(size);
+    ParallelArray<u32> arr(size);
+    for (u32 i = 0; i < size; ++i) source[i] = gen();
+
+    benchmark.run_sequential(name, size, [&]() {
+        arr = source;
+    }, [&]() {
+        std::sort(arr.begin(), arr.end());
+        escape(&arr);
+    });
+});
+
+REGISTER_BENCHMARK("sort/parallel_sort/u32", SIZES(1'000'000, 10'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    std::mt19937 gen(size);
+    ParallelArray<u32> source(size);
+    ParallelArray<u32> arr(size);
+    for (u32 i = 0; i < size; ++i) source[i] = gen();
+
+    benchmark.run(name, size, [&]() {
+        arr = source;
+    }, [&]() {
+        parallel_sort(arr.begin(), arr.end());
+        escape(&arr);
+    });
+});
+
+REGISTER_BENCHMARK("sort/parallel_sort/edges", SIZES(1'000'000, 10'000'000),
+                   [](Benchmark& benchmark, const std::string& name, u64 size) {
+    std::mt19937 gen(size);
+    std::uniform_int_distribution<u32> node(0, size / 10);
+    ParallelArray<Edge> source(size);
+    ParallelArray<Edge> arr(size);
+    for (u32 i = 0; i < size; ++i) source[i] = Edge(node(gen), node(gen), gen());
+
+    benchmark.run(name, size, [&]() {
+        arr = source;
+    }, [&]() {
+        parallel_sort(arr.begin(), arr.end());
+        escape(&arr);
+    });
+});
+
+BENCHMARK_MAIN()
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "../boruvka.h"
+#include "../defs.h"
+#include "../graph.h"
+#include "../sequential_mst.h"
+#include "../weight_traits.h"
+
+/**
+ * Runs every MST engine on random graphs with each weight and node id type,
+ * sorted weights of their forests should be equal, MSTs may differ only between equal weights
+ * u16 weights repeat a lot on these sizes, so ties are checked too
+ */
+const u32 NUM_STEPS = 30;
+const u32 MAX_NODES = 3'000;
+
+template<typename Edges>
+auto sorted_weights(const Edges& mst) {
+    std::vector<decltype(mst[0].weight)> weights;
+    for (u32 i = 0; i < mst.size(); ++i) weights.push_back(mst[i].weight);
+    std::sort(weights.begin(), weights.end());
+    return weights;
+}
+
+template<typename W, typename I>
+void check_types(const std::string& name) {
+    std::cout << "Checking " << name << ":\n";
+
+    BoruvkaMST<W, I> boruvka;
+    BoruvkaMST<W, I> boruvka_no_cutoff(0);
+    SequentialMST<W, I> sequential_mst;
+    KruskalMST<W, I> kruskal;
+
+    for (u32 step = 1; step <= NUM_STEPS; ++step) {
+        u32 num_nodes = randint(2, MAX_NODES);
+        BasicGraph<W, I> G = generate_graph<W, I>(num_nodes, randint(num_nodes - 1, 5 * num_nodes));
+
+        auto expected = sorted_weights(kruskal.calculate_mst(G));
+        if (expected.size() != num_nodes - 1 ||
+            sorted_weights(boruvka.calculate_mst(G)) != expected ||
+            sorted_weights(boruvka_no_cutoff.calculate_mst(G, 2)) != expected ||
+            sorted_weights(sequential_mst.calculate_mst(G)) != expected) {
+            std::cerr << name << ": MST weights mismatch on step " << step << "\n";
+            exit(-1);
+        }
+    }
+    std::cout << "OK\n";
+}
+
+int main() {
+    std::cout << "Checking float keys:\n";
+    std::vector<float> values = { -std::numeric_limits<float>::infinity(), -1e30f, -1.5f, -1e-30f, -0.0f,
+                                  0.0f, 1e-30f, 1.5f, 1e30f, std::numeric_limits<float>::infinity() };
+    for (u32 i = 0; i + 1 < values.size(); ++i) {
+        if (WeightTraits<float>::key(values[i]) >= WeightTraits<float>::key(values[i + 1])) {
+            std::cerr << "Key of " << values[i] << " isn't below the key of " << values[i + 1] << "\n";
+            exit(-1);
+        }
+    }
+    std::cout << "OK\n";
+
+    check_types<u16, u32>("u16 weights");
+    check_types<u32, u32>("u32 weights");
+    check_types<u64, u32>("u64 weights");
+    check_types<float, u32>("float weights");
+    check_types<u16, u16>("u16 weights and u16 ids");
+    check_types<float, u16>("float weights and u16 ids");
+
+    return 0;
+}
@@ -6,13 +6,41 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include "defs.h"
 
-u64 currentSeconds() {
+/**
+ * All timers return nanoseconds
+ *
+ * wall_time_ns() - monotonic wall clock, this is what parallel code should be measured with
+ * thread_cpu_time_ns() - CPU time of the calling thread only
+ * process_cpu_time_ns() - CPU time of all threads of the process
+ */
+u64 read_clock(clockid_t clock) {
     timespec spec;
-    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &spec);
-    return spec.tv_sec * 1e9 + spec.tv_nsec;
+    clock_gettime(clock, &spec);
+    return static_cast<u64>(spec.tv_sec) * 1'000'000'000ULL + spec.tv_nsec;
+}
+
+u64 wall_time_ns() {
+    return read_clock(CLOCK_MONOTONIC);
+}
+
+u64 thread_cpu_time_ns() {
+    return read_clock(CLOCK_THREAD_CPUTIME_ID);
+}
+
+u64 process_cpu_time_ns() {
+    return read_clock(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+/**
+ * Used to be the CPU time of the calling thread, which hides the work of every
+ * other OpenMP thread, now it is the wall clock
+ */
+u64 currentSeconds() {
+    return wall_time_ns();
 }
 
 #endif
@@ -0,0 +1,94 @@
+#ifndef __WEIGHT_TRAITS_H
+#define __WEIGHT_TRAITS_H
+
+#include <cstring>
+#include <random>
+#include <type_traits>
+
+#include "defs.h"
+
+/**
+ * INTERFACE:
+ *
+ * WeightTraits<W>::Key - unsigned integer type as wide as W
+ * Key WeightTraits<W>::key(W weight) - maps weights to keys preserving their order
+ * W WeightTraits<W>::random(std::mt19937& gen) - random weight spread over the whole range of W
+ *
+ * IndexTraits<I>::supported - whether I can be a node or edge id type of a graph
+ *
+ * DETAILS:
+ *
+ * MST engines only compare weights, keys let them compare every weight type as unsigned integers,
+ * so packed (key, index) encodings and the vectorized kernels work on them unchanged
+ *
+ * Weight types are u16, u32, u64 and float, each has its own specialization,
+ * so the choice is made at compile time and the loops over keys don't branch on the type
+ * The key of a float flips all bits of negative values and the sign bit of the rest,
+ * -0.0 goes right before +0.0 and NaNs aren't supported
+ */
+template<typename W>
+struct WeightTraits {
+    static_assert(!std::is_same_v<W, W>, "Weights should be u16, u32, u64 or float");
+};
+
+template<>
+struct WeightTraits<u16> {
+    using Key = u16;
+
+    static Key key(u16 weight) {
+        return weight;
+    }
+
+    static u16 random(std::mt19937& gen) {
+        return static_cast<u16>(gen());
+    }
+};
+
+template<>
+struct WeightTraits<u32> {
+    using Key = u32;
+
+    static Key key(u32 weight) {
+        return weight;
+    }
+
+    static u32 random(std::mt19937& gen) {
+        return gen();
+    }
+};
+
+template<>
+struct WeightTraits<u64> {
+    using Key = u64;
+
+    static Key key(u64 weight) {
+        return weight;
+    }
+
+    static u64 random(std::mt19937& gen) {
+        return (static_cast<u64>(gen()) << 32) | gen();
+    }
+};
+
+template<>
+struct WeightTraits<float> {
+    using Key = u32;
+
+    static Key key(float weight) {
+        u32 bits;
+        std::memcpy(&bits, &weight, sizeof(bits));
+        return bits ^ ((bits >> 31) ? 0xFFFFFFFFu : 0x80000000u);
+    }
+
+    static float random(std::mt19937& gen) {
+        return std::uniform_real_distribution<float>(0, 1)(gen);
+    }
+};
+
+/* Ids are at most 32 bit, arrays are indexed with u32 */
+template<typename I>
+struct IndexTraits {
+    static constexpr bool supported = std::is_same_v<I, u16> || std::is_same_v<I, u32>;
+};
+
+#endif